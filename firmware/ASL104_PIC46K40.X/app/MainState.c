@@ -47,9 +47,11 @@
 
 //#include "beeper_bsp.h"
 #include "bluetooth_simple_if_bsp.h"
+#include "bt_status.h"
 #include "inc/eFix_Communication.h"
 #include "inc/rtos_task_priorities.h"
 #include "Delay_Pot.h"
+#include "event_log.h"
 
 //------------------------------------------------------------------------------
 // Defines and Macros 
@@ -57,12 +59,24 @@
 
 #define SEQUENCE_TIME 0
 #define SEQUENCE_STATE 1
+
+// If the Bluetooth module hasn't reported pairing or connected this long
+// after the enable sequence, send the enable sequence again.
+#define BT_ENABLE_RESPONSE_TIMEOUT_ms (5000)
+#define BT_ENABLE_MAX_RETRIES 2
+
+// Groups of outputs that are always written together.
+#define PAD_LED_OUTPUTS     (GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_FORWARD_PAD_LED) | GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_REVERSE_PAD_LED) \
+                            | GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_LEFT_PAD_LED) | GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_RIGHT_PAD_LED))
+#define DEMAND_OUTPUTS      (GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_FORWARD_DEMAND) | GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_REVERSE_DEMAND) \
+                            | GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_LEFT_DEMAND) | GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_RIGHT_DEMAND))
 //------------------------------------------------------------------------------
 // Local Variables
 //------------------------------------------------------------------------------
 
 static void (*MainState)(void);
 static int g_StartupDelayCounter;
+static bool g_OutOfNeutralLogged;
 static uint16_t g_SwitchDelay;
 static uint8_t g_ExternalSwitchStatus;
 static int g_PulseDelay;
@@ -72,6 +86,8 @@ static int g_SequenceCounter;
 static uint8_t g_MainTaskID = 0;
 static uint8_t g_BluetoothSetupStep = 0;
 static uint8_t g_BluetoothSequenceTimer = 0;
+static uint16_t g_BluetoothResponseTimer = 0;
+static uint8_t g_BluetoothEnableRetries = 0;
 
 // To enable the Bluetooth module, all three pads go:
 // NOTE TO SELF: The signal gets inverted in the bluetooth_simple_if_bsp function call
@@ -241,6 +257,7 @@ static void MainTask (void)
         
         // Get the User and Mode port switch status all of the time.
         g_ExternalSwitchStatus = GetSwitchStatus();
+        btStatusUpdate();
         
         MainState();
 
@@ -278,10 +295,7 @@ static void AnnunciateVersionState (void)
         if (g_PulseDelay == 0)
         {
             // turn off all LED's
-            GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_FORWARD_PAD_LED);
-            GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_REVERSE_PAD_LED);
-            GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_RIGHT_PAD_LED);
-            GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_LEFT_PAD_LED);
+            GenOutCtrlBsp_SetMany (PAD_LED_OUTPUTS, 0);
             ++g_SequenceCounter;
             g_PulseDelay = g_VersionTable[g_SequenceCounter][1] / MAIN_TASK_DELAY;
             if (g_PulseDelay == 0) // All done
@@ -329,6 +343,7 @@ static void Startup_State (void)
 static void OONAPU_Setup_State (void)
 {
     g_StartupDelayCounter = (500 / MAIN_TASK_DELAY);
+    g_OutOfNeutralLogged = false;
     
     MainState = OONAPU_State;
     
@@ -358,6 +373,13 @@ static void OONAPU_State (void)
     else
     {
         g_StartupDelayCounter = (500 / MAIN_TASK_DELAY);  // reset the counter.
+
+        // Once per power up is enough to know it happened.
+        if (!g_OutOfNeutralLogged)
+        {
+            eventLogAdd (EVENT_LOG_OUT_OF_NEUTRAL_AT_POWER_UP, 0);
+            g_OutOfNeutralLogged = true;
+        }
     }
 }
 
@@ -427,6 +449,13 @@ static void Driving_State (void)
                 speedPercentage = -100;
         }
     }
+
+    // Never drive on program memory that hasn't been checked, or failed its check.
+    if (!AppCommonFlashCheckPassed())
+    {
+        speedPercentage = 0;
+        directionPercentage = 0;
+    }
     
     // Check the user port for active... If so, change to Bluetooth state.
     if (g_ExternalSwitchStatus & USER_SWITCH)
@@ -463,37 +492,20 @@ static void Driving_State (void)
 #ifdef EFIX
     SetSpeedAndDirection (speedPercentage, directionPercentage);
 #else
+    GenOutCtrlBspIdMask_t demands = 0;
+
     if (speedPercentage > 0)    // Forward?
-    {
-        GenOutCtrlBsp_SetActive (GEN_OUT_CTRL_ID_FORWARD_DEMAND);     // Forward Digital Output to W/C
-        GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_REVERSE_DEMAND);     // Reverse Digital Output to W/C
-    }
+        demands |= GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_FORWARD_DEMAND);
     else if (speedPercentage < 0)   // Reverse
-    {
-        GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_FORWARD_DEMAND);     // Forward Digital Output to W/C
-        GenOutCtrlBsp_SetActive (GEN_OUT_CTRL_ID_REVERSE_DEMAND);     // Reverse Digital Output to W/C
-    }
-    else    // Must be no speed demand
-    {
-        GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_FORWARD_DEMAND);     // Forward Digital Output to W/C
-        GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_REVERSE_DEMAND);     // Reverse Digital Output to W/C
-    }
-    
+        demands |= GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_REVERSE_DEMAND);
+
     if (directionPercentage > 0)    // Right demand?
-    {
-        GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_LEFT_DEMAND);        // Left Digital Output to W/C
-        GenOutCtrlBsp_SetActive (GEN_OUT_CTRL_ID_RIGHT_DEMAND);       // Right Digital Output to W/C
-    }
+        demands |= GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_RIGHT_DEMAND);
     else if (directionPercentage < 0)    // Left demand?
-    {
-        GenOutCtrlBsp_SetActive (GEN_OUT_CTRL_ID_LEFT_DEMAND);        // Left Digital Output to W/C
-        GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_RIGHT_DEMAND);       // Right Digital Output to W/C
-    }
-    else // Must be no directional demand
-    {
-        GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_LEFT_DEMAND);        // Left Digital Output to W/C
-        GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_RIGHT_DEMAND);       // Right Digital Output to W/C
-    }
+        demands |= GEN_OUT_CTRL_BSP_ID_BIT(GEN_OUT_CTRL_ID_LEFT_DEMAND);
+
+    // Digital outputs to W/C. Outputs that share a port change on the same write.
+    GenOutCtrlBsp_SetMany (DEMAND_OUTPUTS, demands);
 #endif
 }
 
@@ -629,6 +641,7 @@ static void BluetoothSetup_State (void)
         GenOutCtrlBsp_SetActive (GEN_OUT_CTRL_ID_POWER_LED);
         // Allow the Power LED to follow the Bluetooth LED On/Off pattern.
         //GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_BT_LED);
+        g_BluetoothResponseTimer = BT_ENABLE_RESPONSE_TIMEOUT_ms / MAIN_TASK_DELAY;
         MainState = DoBluetooth_State;        // Set to Blue tooth state
     }
 }
@@ -652,6 +665,7 @@ static void DoBluetooth_State (void)
         // Setup delay time.
         g_SwitchDelay = GetDelayTime() / MAIN_TASK_DELAY;
         SetupBluetoothStopSequence();
+        g_BluetoothEnableRetries = 0;
         MainState = BluetoothDisable_State;
         GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_POWER_LED);
     }
@@ -661,6 +675,30 @@ static void DoBluetooth_State (void)
             GenOutCtrlBsp_SetInactive (GEN_OUT_CTRL_ID_POWER_LED);
         else
             GenOutCtrlBsp_SetActive (GEN_OUT_CTRL_ID_POWER_LED);
+
+        switch (btStatusLinkStateGet())
+        {
+            case BT_LINK_PAIRING:
+            case BT_LINK_CONNECTED:
+                // The module took the enable sequence.
+                g_BluetoothEnableRetries = 0;
+                g_BluetoothResponseTimer = BT_ENABLE_RESPONSE_TIMEOUT_ms / MAIN_TASK_DELAY;
+                break;
+            default:
+                if (g_BluetoothResponseTimer > 0)
+                {
+                    --g_BluetoothResponseTimer;
+                }
+                else if (g_BluetoothEnableRetries < BT_ENABLE_MAX_RETRIES)
+                {
+                    // Module never reported pairing. Try the enable sequence again.
+                    ++g_BluetoothEnableRetries;
+                    SetupBluetoothStartSequence();
+                    MainState = BluetoothEnable_State;
+                    return;
+                }
+                break;
+        }
         MirrorDigitalInputOnBluetoothOutput();
     }
 }
@@ -27,8 +27,11 @@
 // from system
 
 // from project
+#include "config.h"
 #include "rtos_task_priorities.h"
 #include "eeprom_app.h"
+#include "event_log.h"
+#include "crc_bsp.h"
 
 // from local
 #include "app_common.h"
@@ -46,12 +49,18 @@
 /* ***********************   File Scope Variables   *********************** */
 
 static volatile bool device_is_active;
+
+// Program memory has been checked at least once, and every check matched.
+static bool flash_check_passed;
+static bool flash_fault;
 //static volatile bool device_in_calibration;
 
 /* ***********************   Function Prototypes   ************************ */
 
 static void SystemSupervisorTask(void);
 inline static void ManageEepromDataFlush(void);
+inline static void ManageEventLogFlush(void);
+inline static void ManageFlashCheck(void);
 
 /* *******************   Public Function Definitions   ******************** */
 
@@ -67,6 +76,12 @@ void AppCommonInit(void)
     
     //device_in_calibration = false;
 
+    // A part without the scanner has no way to check itself. It can't be left unable to
+    // drive for that, so it counts as checked.
+    flash_check_passed = !crcBspFlashScanAvailable();
+    flash_fault = false;
+    crcBspFlashScanStart(false);
+
     (void)task_create(SystemSupervisorTask , NULL, SYSTEM_SUPERVISOR_TASK_PRIO, NULL, 0, 0);
 }
 
@@ -262,6 +277,18 @@ bool AppCommonDeviceActiveGet(void)
 //	//return device_in_calibration;
 //}
 
+//-------------------------------
+// Function: AppCommonFlashCheckPassed
+//
+// Description: Lets the caller know whether program memory is known to be intact. Nothing
+//		should drive until it is.
+//
+//-------------------------------
+bool AppCommonFlashCheckPassed(void)
+{
+	return flash_check_passed && !flash_fault;
+}
+
 /* ********************   Private Function Definitions   ****************** */
 
 //-------------------------------
@@ -277,7 +304,16 @@ static void SystemSupervisorTask(void)
 	{
 		task_wait(MILLISECONDS_TO_TICKS(SYS_SUPERVISOR_TASK_EXECUTION_RATE_ms));
 		
-		//ManageEepromDataFlush();
+		// Settings are only kept in EEPROM by the ASL110, see eeprom_app.c. The ASL104 build
+		// has nothing to flush.
+#ifdef ASL110
+		ManageEepromDataFlush();
+#endif
+		ManageEventLogFlush();
+		if (crcBspFlashScanAvailable())
+		{
+			ManageFlashCheck();
+		}
 	}
 	task_close();
 }
@@ -288,6 +324,9 @@ static void SystemSupervisorTask(void)
 // Description: Monitor EEPROM and flush changes, stored in RAM, to EEPROM after waiting for a user(s) to
 // 		finish updating all values of interest to them to help manage wear on the EEPROM.
 //
+// 		Only changed items are written. A flush that couldn't all be queued is tried again
+// 		once the EEPROM has finished with what it has.
+//
 //-------------------------------
 #ifdef ASL110
 
@@ -295,7 +334,7 @@ inline static void ManageEepromDataFlush(void)
 {
 // This is the time to wait for new updates to persistent data (stored in RAM) before flushing to the EEPROM.
 // This is to reduce wear on EEPROM.
-#define TIME_TO_WAIT_BEFORE_EEPROM_FLUSH_ms ((uint32_t)10 * (uint32_t)1000)
+#define TIME_TO_WAIT_BEFORE_EEPROM_FLUSH_ms EEPROM_FLUSH_QUIET_PERIOD_ms
 #define TIME_TO_WAIT_BEFORE_EEPROM_FLUSH_PERIODS (uint16_t)(TIME_TO_WAIT_BEFORE_EEPROM_FLUSH_ms / (uint32_t)SYS_SUPERVISOR_TASK_EXECUTION_RATE_ms)
 
 	static uint16_t num_periods_before_eeprom_flush = 0;
@@ -309,14 +348,110 @@ inline static void ManageEepromDataFlush(void)
 	else if (num_periods_before_eeprom_flush > 0)
 	{
 		num_periods_before_eeprom_flush--;
-
-		if (num_periods_before_eeprom_flush == 0)
-		{
-			eepromFlush(false);
-		}
+	}
+	else if (eepromFlushNeeded() && !eepromFlushBusy())
+	{
+		eepromFlush(false);
 	}
 }
 #endif // #ifdef ASL110
 
+//-------------------------------
+// Function: ManageEventLogFlush
+//
+// Description: Writes logged events to EEPROM every so often.
+//
+//-------------------------------
+inline static void ManageEventLogFlush(void)
+{
+#define EVENT_LOG_FLUSH_PERIODS (uint8_t)(EVENT_LOG_FLUSH_PERIOD_ms / SYS_SUPERVISOR_TASK_EXECUTION_RATE_ms)
+
+	static uint8_t num_periods_before_event_log_flush = EVENT_LOG_FLUSH_PERIODS;
+
+	if (num_periods_before_event_log_flush > 0)
+	{
+		num_periods_before_event_log_flush--;
+	}
+	else
+	{
+		eventLogFlush();
+		num_periods_before_event_log_flush = EVENT_LOG_FLUSH_PERIODS;
+	}
+}
+
+//-------------------------------
+// Function: ManageFlashCheck
+//
+// Description: Checks program memory against the CRC the build stored with it, at power up and
+// 		every FLASH_CHECK_PERIOD_ms after. The scan runs in the background, this only starts it
+// 		and looks at the result. A mismatch is latched until the next power up.
+//
+// 		Nothing drives until the first check is done, so that one is timed from power up and the
+// 		time logged. If it isn't done by FLASH_FIRST_CHECK_TIMEOUT_ms, e.g. the background scan
+// 		is slow or keeps being cut short, it's run in Burst mode. That holds everything up for
+// 		one scan, but the check can't take any longer than that.
+//
+//-------------------------------
+inline static void ManageFlashCheck(void)
+{
+#define FLASH_CHECK_PERIODS (uint16_t)(FLASH_CHECK_PERIOD_ms / (uint32_t)SYS_SUPERVISOR_TASK_EXECUTION_RATE_ms)
+#define FLASH_FIRST_CHECK_TIMEOUT_PERIODS (uint16_t)(FLASH_FIRST_CHECK_TIMEOUT_ms / SYS_SUPERVISOR_TASK_EXECUTION_RATE_ms)
+
+	static uint16_t num_periods_before_flash_check = 0;
+	static uint16_t num_periods_to_first_check = 0;
+	bool first_check_overdue;
+	uint16_t crc;
+
+	if (!flash_check_passed)
+	{
+		num_periods_to_first_check++;
+	}
+	first_check_overdue = !flash_check_passed && (num_periods_to_first_check >= FLASH_FIRST_CHECK_TIMEOUT_PERIODS);
+
+	switch (crcBspFlashScanStatus(&crc))
+	{
+		case CRC_BSP_SCAN_DONE:
+			if (crc != crcBspFlashCrcExpected())
+			{
+				if (!flash_fault)
+				{
+					eventLogAdd(EVENT_LOG_FLASH_CRC_MISMATCH, crc);
+				}
+				flash_fault = true;
+			}
+			if (!flash_check_passed)
+			{
+				eventLogAdd(EVENT_LOG_FLASH_SCAN_TIME, num_periods_to_first_check * SYS_SUPERVISOR_TASK_EXECUTION_RATE_ms);
+			}
+			flash_check_passed = true;
+			num_periods_before_flash_check = FLASH_CHECK_PERIODS;
+			break;
+
+		case CRC_BSP_SCAN_IDLE:
+			// Waiting for the next check, or the scan was cut short and has to start over.
+			if (num_periods_before_flash_check > 0)
+			{
+				num_periods_before_flash_check--;
+			}
+			else
+			{
+				crcBspFlashScanStart(first_check_overdue);
+			}
+			break;
+
+		case CRC_BSP_SCAN_BUSY:
+		default:
+			if (first_check_overdue)
+			{
+				if (num_periods_to_first_check == FLASH_FIRST_CHECK_TIMEOUT_PERIODS)
+				{
+					eventLogAdd(EVENT_LOG_FLASH_SCAN_TIMEOUT, num_periods_to_first_check * SYS_SUPERVISOR_TASK_EXECUTION_RATE_ms);
+				}
+				crcBspFlashScanStart(true);
+			}
+			break;
+	}
+}
+
 // end of file.
 //-------------------------------------------------------------------------
@@ -0,0 +1,242 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: bt_status.c
+//
+// Description: Decodes the Bluetooth module's status LED (BT_LED input, RC5) into a link state.
+//
+//	Every edge on the LED input is time stamped in the IOC interrupt. The task level classifier
+//	then looks at the last measured blink period (LED-on edge to LED-on edge) and how long the
+//	LED has been quiet:
+//
+//		Quiet, LED off			-> BT_LINK_OFF
+//		Quiet, LED on			-> BT_LINK_CONNECTED
+//		Period <= PAIRING max	-> BT_LINK_PAIRING
+//		Period <= BLINK max		-> BT_LINK_CONNECTED
+//
+//	The time base is only 16 bits, so the quiet time wraps about every 65 s. Once the LED has been
+//	quiet long enough it's latched as steady until the next edge, rather than worked out again.
+//
+// Author(s): G. Chopcinski (Kg Solutions, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+/* **************************   Header Files   *************************** */
+
+// NOTE: This must ALWAYS be the first include in a file.
+#include "device.h"
+
+// from stdlib
+#include <stdint.h>
+#include <stdbool.h>
+
+// from project
+#include "stopwatch.h"
+#include "user_button_bsp.h"
+
+// from local
+#include "bt_status.h"
+
+/* ******************************   Macros   ****************************** */
+
+// Blink timing of the module's status LED. Tune these to the module being fitted.
+// Longest LED period that is still considered the fast "pairing" blink.
+#define BT_STATUS_PAIRING_MAX_PERIOD_ms		(700)
+// Longest LED period that is still considered a blink at all (slow "connected" heartbeat).
+#define BT_STATUS_BLINK_MAX_PERIOD_ms		(4000)
+// No edges for this long means the LED is steady and its level tells the state.
+#define BT_STATUS_STEADY_TIME_ms			(4500)
+
+// Number of LED-on edges needed before the period is trusted.
+#define BT_STATUS_MIN_ON_EDGES				(2)
+
+/* ***********************   File Scope Variables   *********************** */
+
+// Written by the IOC ISR, read by btStatusUpdate(). The ISR bumps num_edges after each edge it
+// takes, so a read that starts and ends on the same count is coherent.
+static volatile TimerTick_t last_edge_ms;
+static volatile TimerTick_t last_on_edge_ms;
+static volatile TimerTick_t blink_period_ms;
+static volatile uint8_t num_on_edges;
+static volatile bool led_is_on;
+static volatile uint8_t num_edges;
+
+// Set by btStatusUpdate() once the LED has been quiet for BT_STATUS_STEADY_TIME_ms, so the ISR
+// starts measuring the period afresh on the next edge.
+static volatile bool period_is_stale;
+
+// The LED has been steady since edge number steady_at_edge.
+static bool led_is_steady;
+static uint8_t steady_at_edge;
+
+static BtLinkState_t link_state = BT_LINK_UNKNOWN;
+static uint16_t reported_period_ms = 0;
+
+/* *******************   Public Function Definitions   ******************** */
+
+//-------------------------------
+// Function: btStatusInit
+//
+// Description: Initializes this module. Must be called after the BT LED input has been set up (ButtonBspInit).
+//
+//-------------------------------
+void btStatusInit(void)
+{
+	last_edge_ms = stopwatchCurrentTime();
+	last_on_edge_ms = last_edge_ms;
+	blink_period_ms = 0;
+	num_on_edges = 0;
+	led_is_on = BT_LED_IsActive();
+	num_edges = 0;
+	period_is_stale = false;
+	led_is_steady = false;
+	steady_at_edge = 0;
+	link_state = BT_LINK_UNKNOWN;
+	reported_period_ms = 0;
+
+	BT_LED_EdgeInterruptEnable(true);
+}
+
+//-------------------------------
+// Function: btStatusEdgeIsr
+//
+// Description: Time stamps an edge on the BT LED input. Called from the low priority ISR only.
+//
+//-------------------------------
+void btStatusEdgeIsr(void)
+{
+	TimerTick_t now = stopwatchCurrentTime();
+	bool on = BT_LED_IsActive();
+
+	// Ignore glitches that don't change the level we last saw.
+	if (on == led_is_on)
+	{
+		return;
+	}
+
+	// A long quiet spell means the old period no longer describes what the LED is doing.
+	if (period_is_stale)
+	{
+		num_on_edges = 0;
+		period_is_stale = false;
+	}
+
+	if (on)
+	{
+		if (num_on_edges > 0)
+		{
+			blink_period_ms = now - last_on_edge_ms;
+		}
+		if (num_on_edges < BT_STATUS_MIN_ON_EDGES)
+		{
+			num_on_edges++;
+		}
+		last_on_edge_ms = now;
+	}
+
+	last_edge_ms = now;
+	led_is_on = on;
+	num_edges++;
+}
+
+//-------------------------------
+// Function: btStatusUpdate
+//
+// Description: Classifies the latest edge data into a link state. Call periodically from task level.
+//
+//-------------------------------
+void btStatusUpdate(void)
+{
+	TimerTick_t now;
+	TimerTick_t quiet_ms;
+	TimerTick_t period_ms;
+	uint8_t on_edges;
+	uint8_t edge;
+	bool on;
+
+	// Take a coherent snapshot of the edge data. The IOC interrupt is shared with the HHP link,
+	// so it isn't masked for this. Read until no edge came in part way through instead.
+	do
+	{
+		edge = num_edges;
+
+		// The time base is 16 bits and ticks from the ISR, so read it until two reads agree.
+		do
+		{
+			now = stopwatchCurrentTime();
+		} while (now != stopwatchCurrentTime());
+
+		quiet_ms = now - last_edge_ms;
+		period_ms = blink_period_ms;
+		on_edges = num_on_edges;
+		on = led_is_on;
+	} while (edge != num_edges);
+
+	// An edge is waiting for the ISR. Classify on the next pass.
+	if (on != BT_LED_IsActive())
+	{
+		return;
+	}
+
+	if (led_is_steady && (edge != steady_at_edge))
+	{
+		led_is_steady = false;
+	}
+	else if (!led_is_steady && (quiet_ms >= BT_STATUS_STEADY_TIME_ms))
+	{
+		// From here on quiet_ms can wrap, so it isn't looked at again until there's an edge.
+		led_is_steady = true;
+		steady_at_edge = edge;
+		period_is_stale = true;
+	}
+
+	if (led_is_steady)
+	{
+		link_state = on ? BT_LINK_CONNECTED : BT_LINK_OFF;
+		reported_period_ms = 0;
+	}
+	else if (on_edges >= BT_STATUS_MIN_ON_EDGES)
+	{
+		if (period_ms <= BT_STATUS_PAIRING_MAX_PERIOD_ms)
+		{
+			link_state = BT_LINK_PAIRING;
+		}
+		else if (period_ms <= BT_STATUS_BLINK_MAX_PERIOD_ms)
+		{
+			link_state = BT_LINK_CONNECTED;
+		}
+		else
+		{
+			link_state = BT_LINK_UNKNOWN;
+		}
+		reported_period_ms = period_ms;
+	}
+	// else: Still collecting edges, keep the last decision.
+}
+
+//-------------------------------
+// Function: btStatusLinkStateGet
+//
+// Description: Returns the last classified link state.
+//
+//-------------------------------
+BtLinkState_t btStatusLinkStateGet(void)
+{
+	return link_state;
+}
+
+//-------------------------------
+// Function: btStatusBlinkPeriodGet
+//
+// Description: Returns the last measured blink period in milliseconds, or 0 if the LED is steady.
+//
+//-------------------------------
+uint16_t btStatusBlinkPeriodGet(void)
+{
+	return reported_period_ms;
+}
+
+// end of file.
+//-------------------------------------------------------------------------
@@ -35,8 +35,11 @@
 #include "head_array_bsp.h" // TODO: Expose MIN/MAX values in head_array driver module
 #include "head_array.h"
 #include "app_common.h"
+#include "stopwatch.h"
+#include "event_log.h"
 
 #include "inc/eFix_Communication.h"
+#include "eFix_Ramp.h"
 #include "RS232.h"
 
 /* **************************   Local Macro Declarations   *************************** */
@@ -47,8 +50,29 @@
 //#define EFIX_COMM_TASK_DELAY (15)
 #define EFIX_COMM_TASK_DELAY (53)
 
+// The task may be held off by EEPROM writes or HHP sessions. If nothing has gone
+// out for this long the timer interrupt sends a No Command message itself. A frame
+// takes about half a millisecond at 115.2K so this leaves plenty of room.
+#define EFIX_WATCHDOG_ms (100)
+#define EFIX_KEEP_ALIVE_FALLBACK_ms (80)
+// A gap between frames this long is counted as a near miss.
+#define EFIX_NEAR_MISS_ms (70)
+
 #define TO_EFIX_SOT (0xeb)       // Start Of Transmission Character when sending to eFix
 #define FROM_EFIX_SOT (0xbe)     // This is the start character when receiving a message
+#define EFIX_MSG_LEN (6)         // SOT, Message ID, 2 data bytes, 2 checksum bytes
+
+// Where the steering and speed frames sit in g_DriveFrames.
+#define EFIX_STEERING_FRAME (0)
+#define EFIX_SPEED_FRAME (EFIX_MSG_LEN)
+#define EFIX_NUM_DRIVE_FRAMES (2)
+
+// Replies are kept by Message ID. IDs past this are checked and counted but not kept.
+#define EFIX_RX_NUM_MSG_IDS (16)
+
+// Past this the age of the last reply is reported as EFIX_RX_AGE_UNKNOWN. Must be
+// well short of the 65535 ms wrap of the stopwatch time base.
+#define EFIX_RX_AGE_MAX_ms (60000)
 
 #define SPEED_NEUTRAL (0x0)     // No Speed command
 #define SPEED_REVERSE (-1000)
@@ -57,6 +81,16 @@
 #define DIRECTION_LEFT (-1000)
 #define DIRECTION_RIGHT (1000)
 
+// Demands come in as a percentage and go to the eFix as -1000 to +1000.
+#define EFIX_DEMAND_PER_PERCENT (10)
+
+// Ramp steps. The ramp runs once per speed and direction update, every
+// EFIX_COMM_TASK_DELAY. Limits are in eFix_Ramp.h.
+#define EFIX_TURN_STEP EFIX_RAMP_STEP(EFIX_TURN_RATE_PER_SEC, EFIX_COMM_TASK_DELAY)
+#define EFIX_TURN_RETURN_STEP EFIX_RAMP_STEP(EFIX_TURN_RETURN_PER_SEC, EFIX_COMM_TASK_DELAY)
+#define EFIX_SPEED_ACCEL_STEP EFIX_RAMP_STEP(EFIX_SPEED_ACCEL_PER_SEC, EFIX_COMM_TASK_DELAY)
+#define EFIX_SPEED_DECEL_STEP EFIX_RAMP_STEP(EFIX_SPEED_DECEL_PER_SEC, EFIX_COMM_TASK_DELAY)
+
 /* **************************   Forward Declarations   *************************** */
 
 static void eFix_Communication_Task (void);
@@ -66,7 +100,12 @@ static void Create_eFix_2nd_Setup_Msg(unsigned char *buffer);
 static void Create_eFix_MaxSpeed_Message(unsigned char *buffer);
 static void Create_eFix_Steering_Message (unsigned char *buffer, int direction);
 static void Create_eFix_Speed_Message(unsigned char *buffer, int speed);
+static void UpdateFramePayload (unsigned char *frame, int value);
 static void SendMessageToEFIX (unsigned char *buffer);
+static void SendFramesToEFIX (const unsigned char *frames, uint8_t numFrames);
+static void ProcessReceivedChars (void);
+static void ParseReceivedChar (unsigned char item);
+static void FrameSentCallback (void);
 
 // State Engine
 static void SendMaxSpeedMessage_State (void);
@@ -81,16 +120,53 @@ static void Idle_State (void);
 /* **************************    Local Variables   *************************** */
 
 unsigned char g_XmtBuffer[8];
+// The steering frame followed by the speed frame, kept ready to send. Only the
+// payload and checksum change, and only when the value does.
+static unsigned char g_DriveFrames[EFIX_NUM_DRIVE_FRAMES * EFIX_MSG_LEN];
 void (*gpState)(void);
-int g_Direction;
+int g_Direction;                    // Shaped values sent to the eFix.
 int g_Speed;
+int g_DirectionDemand;              // Latest demand from SetSpeedAndDirection().
+int g_SpeedDemand;
 
 int g_ReadyCounter = 0;
 int g_NotReadyCounter = 0;
-int g_ReceivedCounter = 0;
-int g_Received55Counter = 0;
-int g_ReceiveTimeout = 0;
 int g_SendCounter = 0;
+int g_XmtDroppedCounter = 0;
+
+// Keep-alive. The gap is counted up by the 1 ms tick and cleared when the
+// transmit interrupt hands off the last character of a frame.
+static unsigned char g_KeepAliveFrame[EFIX_MSG_LEN];
+static volatile bool g_KeepAliveEnabled = false;
+static volatile bool g_TaskSending = false;     // Task is queueing, ISR must keep out of the ring.
+static volatile uint8_t g_FrameGap_ms = 0;
+static volatile eFixKeepAliveStats_t g_KeepAliveStats;
+
+// Receive parser. Frames from the eFix are: SOT (0xbe), Message ID, 2 data bytes, 2 checksum bytes.
+typedef enum
+{
+    RX_WAIT_FOR_SOT,
+    RX_MSG_ID,
+    RX_DATA_HIGH,
+    RX_DATA_LOW,
+    RX_CHECKSUM_HIGH,
+    RX_CHECKSUM_LOW
+} eFixRxState_t;
+
+typedef struct
+{
+    bool m_Received;                // true once a good frame with this ID has arrived.
+    uint16_t m_Payload;             // The 2 data bytes, high byte first.
+    TimerTick_t m_Time;             // When it arrived.
+} eFixRxMsg_t;
+
+static eFixRxState_t g_RxState = RX_WAIT_FOR_SOT;
+static unsigned char g_RxFrame[EFIX_MSG_LEN];
+static uint16_t g_RxSum;            // Running sum of the frame's first 4 bytes.
+static eFixRxMsg_t g_RxMsgs[EFIX_RX_NUM_MSG_IDS];
+static eFixLinkStats_t g_LinkStats;
+static TimerTick_t g_LastRxTime;
+static bool g_LastRxAgeValid = false;
 char myChar = 0xff;
 char myBadChar = 0x41;
 unsigned char g_XmtChar = 0;
@@ -99,28 +175,27 @@ unsigned char g_XmtChar = 0;
 // Function: SetSpeedAndDirection
 //
 // Description: This accepts speed and direction from...
-//      Speed is -100 (left), to 0 (neutral) to 100 (right)
-//      Direction is -100 (reverse), to 0 (neutral) to 100 (forward)
+//      Speed is -100 (reverse), to 0 (neutral) to 100 (forward)
+//      Direction is -100 (left), to 0 (neutral) to 100 (right)
+//      These are the demands. The values sent to the eFix ramp toward them
+//      at the limits in eFix_Ramp.h, see SendSpeedAndDirection_State().
 //
 //------------------------------------------------------------------------------
 
 void SetSpeedAndDirection (int speedPercentage, int directionPercentage)
 {
-//    g_Speed = speedPercentage * 9;            // Convert to -1000 to +1000
-//    g_Direction = directionPercentage * 9;    // Convert to -1000 to +1000
-    if (speedPercentage > 0)
-        g_Speed = SPEED_FORWARD;
-    else if (speedPercentage < 0)
-        g_Speed = SPEED_REVERSE;
-    else
-        g_Speed = SPEED_NEUTRAL;
-    
-    if (directionPercentage > 0)
-        g_Direction = DIRECTION_RIGHT;
-    else if (directionPercentage < 0)
-        g_Direction = DIRECTION_LEFT;
-    else
-        g_Direction = DIRECTION_NEUTRAL;
+    if (speedPercentage > 100)
+        speedPercentage = 100;
+    else if (speedPercentage < -100)
+        speedPercentage = -100;
+
+    if (directionPercentage > 100)
+        directionPercentage = 100;
+    else if (directionPercentage < -100)
+        directionPercentage = -100;
+
+    g_SpeedDemand = speedPercentage * EFIX_DEMAND_PER_PERCENT;            // Convert to -1000 to +1000
+    g_DirectionDemand = directionPercentage * EFIX_DEMAND_PER_PERCENT;    // Convert to -1000 to +1000
 }
 
 //------------------------------------------------------------------------------
@@ -132,12 +207,27 @@ void SetSpeedAndDirection (int speedPercentage, int directionPercentage)
 
 void eFix_Communincation_Initialize(void)
 {
+    g_KeepAliveEnabled = false;
+
     RS232_Initialize();             // Initialize the RS-232 PORT on the CPU.
     
     g_Direction = DIRECTION_NEUTRAL; // Preset to No Command
     g_Speed = SPEED_NEUTRAL;        // Preset to No Speed
+    g_DirectionDemand = DIRECTION_NEUTRAL;
+    g_SpeedDemand = SPEED_NEUTRAL;
+
+    Create_eFix_Steering_Message (&g_DriveFrames[EFIX_STEERING_FRAME], g_Direction);
+    Create_eFix_Speed_Message (&g_DriveFrames[EFIX_SPEED_FRAME], g_Speed);
+
+    g_RxState = RX_WAIT_FOR_SOT;    // Start looking for a reply from the eFix.
     
     gpState = SendMaxSpeedMessage_State;
+
+    // The timer interrupt covers for the task from here on.
+    Create_NoCommand_Msg (g_KeepAliveFrame);
+    g_FrameGap_ms = 0;
+    RS232_TxCompleteCallbackSet (FrameSentCallback);
+    g_KeepAliveEnabled = true;
     
     // Create the state update and control task
     // TODO: Make this DIP Switch dependent
@@ -161,6 +251,7 @@ static void eFix_Communication_Task (void)
 	{
         task_wait(MILLISECONDS_TO_TICKS(EFIX_COMM_TASK_DELAY));
         
+        ProcessReceivedChars();
         gpState();
         
     }
@@ -252,21 +343,22 @@ static void Send3rd_NoCommandMessage_State (void)
     gpState = SendSpeedAndDirection_State;
 }
 
+//------------------------------------------------------------------------------
+// Function: SendSpeedAndDirection_State
+// Description: Ramps speed and direction one step toward the demands and sends
+//      them to the eFix system. The steering message goes first with the speed
+//      message right behind it, both queued in one go.
 //------------------------------------------------------------------------------
 
 static void SendSpeedAndDirection_State (void)
 {
-    int i;
+    g_Direction = eFix_RampToward (g_Direction, g_DirectionDemand, EFIX_TURN_STEP, EFIX_TURN_RETURN_STEP);
+    g_Speed = eFix_RampToward (g_Speed, g_SpeedDemand, EFIX_SPEED_ACCEL_STEP, EFIX_SPEED_DECEL_STEP);
 
-    // Create the Direction Message, eFix refers to this as "Steering".
-    Create_eFix_Steering_Message (g_XmtBuffer, g_Direction);
-    SendMessageToEFIX (g_XmtBuffer);
-    // Create and send the speed message.
-    for (i=0; i<20; ++i)    // A little pause between each character
-        NOP();
-        
-    Create_eFix_Speed_Message (g_XmtBuffer, g_Speed);
-    SendMessageToEFIX (g_XmtBuffer);
+    // Direction, eFix refers to this as "Steering".
+    UpdateFramePayload (&g_DriveFrames[EFIX_STEERING_FRAME], g_Direction);
+    UpdateFramePayload (&g_DriveFrames[EFIX_SPEED_FRAME], g_Speed);
+    SendFramesToEFIX (g_DriveFrames, EFIX_NUM_DRIVE_FRAMES);
     
     // TODO: Remove the following and allow the data to just repeatedly send
     // the speed and direction commands.
@@ -275,26 +367,238 @@ static void SendSpeedAndDirection_State (void)
 
 //------------------------------------------------------------------------------
 // Function: SendMessageToEFIX
-// Description: Send message this item in the buffer to the eFix controller via
-// RS-232.  Assumption is that the message is 6 character in length.
+// Description: Queue the message in the buffer to be sent to the eFix controller
+// via RS-232 and return at once. The transmit interrupt sends it out. The buffer
+// may be reused as soon as this returns. Assumption is that the message is
+// 6 character in length.
 //------------------------------------------------------------------------------
 static void SendMessageToEFIX (unsigned char *buffer)
 {
-    for (int counter = 0; counter < 6; ++counter)
+    SendFramesToEFIX (buffer, 1);
+}
+
+//------------------------------------------------------------------------------
+// Function: SendFramesToEFIX
+// Description: Queue back to back messages to be sent to the eFix controller.
+// Either all of them are queued or none are.
+//------------------------------------------------------------------------------
+static void SendFramesToEFIX (const unsigned char *frames, uint8_t numFrames)
+{
+    g_TaskSending = true;
+    if (RS232_TransmitBuffer (frames, numFrames * EFIX_MSG_LEN) == false)
+    {
+        // The previous messages haven't gone out yet. This should never happen
+        // at the task rate, so count it for debugging.
+        ++g_XmtDroppedCounter;
+    }
+    g_TaskSending = false;
+}
+
+//------------------------------------------------------------------------------
+// Function: FrameSentCallback
+// Description: Called by the transmit interrupt when the last queued character
+//      has been handed to the UART. Records how long the gap since the last
+//      frame was and starts timing the next one.
+//------------------------------------------------------------------------------
+static void FrameSentCallback (void)
+{
+    uint8_t gap = g_FrameGap_ms;
+
+    if (gap > g_KeepAliveStats.m_WorstGap_ms)
+        g_KeepAliveStats.m_WorstGap_ms = gap;
+    if (gap >= EFIX_WATCHDOG_ms)
+    {
+        ++g_KeepAliveStats.m_Misses;
+        eventLogAdd (EVENT_LOG_EFIX_LINK_MISS, gap);
+    }
+    else if (gap >= EFIX_NEAR_MISS_ms)
+        ++g_KeepAliveStats.m_NearMisses;
+
+    g_FrameGap_ms = 0;
+}
+
+//------------------------------------------------------------------------------
+// Function: eFix_KeepAliveTickIsr
+// Description: Call every millisecond from the timer interrupt. If the task
+//      has fallen behind, queue a No Command message so the eFix watchdog
+//      doesn't trip. Skipped while the task is queueing, it's sending anyway.
+//------------------------------------------------------------------------------
+void eFix_KeepAliveTickIsr (void)
+{
+    if (g_KeepAliveEnabled == false)
+        return;
+
+    if (g_FrameGap_ms < 0xff)
+        ++g_FrameGap_ms;
+
+    // Only when the line is quiet. Anything still going out will clear the gap
+    // and this keeps more than one keep-alive from being queued.
+    if ((g_FrameGap_ms >= EFIX_KEEP_ALIVE_FALLBACK_ms) && (g_TaskSending == false) && RS232_TransmitIdle())
+    {
+        if (RS232_TransmitBuffer (g_KeepAliveFrame, EFIX_MSG_LEN))
+            ++g_KeepAliveStats.m_KeepAlivesSent;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Function: eFix_KeepAliveStatsGet
+// Description: Copies the keep-alive statistics.
+//------------------------------------------------------------------------------
+void eFix_KeepAliveStatsGet (eFixKeepAliveStats_t *stats)
+{
+    // The ISRs update these, so read until two reads agree.
+    do
     {
-        while (RS232_TransmitReady() == false)       // Wait for transmit buffer to be ready to accept new character
-        {
-            ;
-        }
-        RS232_TransmitChar(buffer[counter]);
+        stats->m_KeepAlivesSent = g_KeepAliveStats.m_KeepAlivesSent;
+        stats->m_NearMisses = g_KeepAliveStats.m_NearMisses;
+        stats->m_Misses = g_KeepAliveStats.m_Misses;
+        stats->m_WorstGap_ms = g_KeepAliveStats.m_WorstGap_ms;
+    } while ((stats->m_KeepAlivesSent != g_KeepAliveStats.m_KeepAlivesSent)
+          || (stats->m_NearMisses != g_KeepAliveStats.m_NearMisses)
+          || (stats->m_Misses != g_KeepAliveStats.m_Misses)
+          || (stats->m_WorstGap_ms != g_KeepAliveStats.m_WorstGap_ms));
+
+    if (stats->m_WorstGap_ms < EFIX_WATCHDOG_ms)
+        stats->m_MinMargin_ms = EFIX_WATCHDOG_ms - stats->m_WorstGap_ms;
+    else
+        stats->m_MinMargin_ms = 0;
+}
+//------------------------------------------------------------------------------
+// Function: eFix_LinkStatsGet
+// Description: Copies the receive link statistics. Age of the last good frame,
+//      in milliseconds, is in m_LastRxAge_ms, EFIX_RX_AGE_UNKNOWN if none has been
+//      received lately.
+//------------------------------------------------------------------------------
+void eFix_LinkStatsGet (eFixLinkStats_t *stats)
+{
+    RS232_RxErrorCounts_t uart_errors;
+
+    *stats = g_LinkStats;
+
+    RS232_RxErrorCountsGet (&uart_errors);
+    stats->m_FramingErrors = uart_errors.m_FramingErrors;
+    stats->m_OverrunErrors = uart_errors.m_OverrunErrors;
+    stats->m_BufferOverflows = uart_errors.m_BufferOverflows;
+
+    if (g_LastRxAgeValid)
+        stats->m_LastRxAge_ms = stopwatchCurrentTime() - g_LastRxTime;
+    else
+        stats->m_LastRxAge_ms = EFIX_RX_AGE_UNKNOWN;
+}
+
+//------------------------------------------------------------------------------
+// Function: eFix_ReceivedMessageGet
+// Description: Gets the payload of the last good frame received with a Message ID.
+// Returns: true if a frame with that ID has been received in the last
+//          EFIX_RX_AGE_MAX_ms, payload and age_ms are filled in. false if not,
+//          nothing is filled in.
+//------------------------------------------------------------------------------
+bool eFix_ReceivedMessageGet (uint8_t msgID, uint16_t *payload, uint16_t *age_ms)
+{
+    if ((msgID >= EFIX_RX_NUM_MSG_IDS) || (g_RxMsgs[msgID].m_Received == false))
+        return false;
+
+    *payload = g_RxMsgs[msgID].m_Payload;
+    *age_ms = stopwatchCurrentTime() - g_RxMsgs[msgID].m_Time;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Function: ProcessReceivedChars
+// Description: Runs everything received since the last time through the parser
+//      and ages the link.
+//------------------------------------------------------------------------------
+static void ProcessReceivedChars (void)
+{
+    unsigned char item;
+    uint8_t msgID;
+
+    while (RS232_GetReceivedChar (&item))
+    {
+        ParseReceivedChar (item);
     }
-    // Wait until character is transmitted. Without this, the process is interrupted and
-    // the final character is not sent out.
-    while (RS232_TransmitReady() == false)       // Wait for transmit buffer to be ready to accept new character
+
+    // Stop reporting an age before the 16 bit time base wraps and makes it look recent.
+    if (g_LastRxAgeValid && ((TimerTick_t)(stopwatchCurrentTime() - g_LastRxTime) >= EFIX_RX_AGE_MAX_ms))
+        g_LastRxAgeValid = false;
+
+    // Same for the replies kept by Message ID, or an old one would pass for a new one.
+    for (msgID = 0; msgID < EFIX_RX_NUM_MSG_IDS; ++msgID)
+    {
+        if (g_RxMsgs[msgID].m_Received && ((TimerTick_t)(stopwatchCurrentTime() - g_RxMsgs[msgID].m_Time) >= EFIX_RX_AGE_MAX_ms))
+            g_RxMsgs[msgID].m_Received = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Function: ParseReceivedChar
+// Description: Moves the receive parser along by one character. The checksum is
+//      accumulated as the characters arrive so a frame is checked as soon as
+//      its last character is in.
+//------------------------------------------------------------------------------
+static void ParseReceivedChar (unsigned char item)
+{
+    uint16_t checksum;
+
+    switch (g_RxState)
     {
-        ;
+        case RX_WAIT_FOR_SOT:
+            if (item == FROM_EFIX_SOT)
+            {
+                g_RxFrame[0] = item;
+                g_RxSum = item;
+                g_RxState = RX_MSG_ID;
+            }
+            else
+            {
+                ++g_LinkStats.m_DiscardedChars;
+            }
+            break;
+
+        case RX_MSG_ID:
+        case RX_DATA_HIGH:
+        case RX_DATA_LOW:
+            g_RxFrame[g_RxState] = item;
+            g_RxSum += item;
+            ++g_RxState;
+            break;
+
+        case RX_CHECKSUM_HIGH:
+            g_RxFrame[RX_CHECKSUM_HIGH] = item;
+            g_RxState = RX_CHECKSUM_LOW;
+            break;
+
+        case RX_CHECKSUM_LOW:
+        default:
+            g_RxFrame[RX_CHECKSUM_LOW] = item;
+            g_RxState = RX_WAIT_FOR_SOT;
+
+            // Same checksum as we send: 2's complement of the sum of the first 4 bytes.
+            checksum = ((uint16_t)g_RxFrame[RX_CHECKSUM_HIGH] << 8) | g_RxFrame[RX_CHECKSUM_LOW];
+            if ((uint16_t)(g_RxSum + checksum) != 0)
+            {
+                ++g_LinkStats.m_ChecksumErrors;
+                break;
+            }
+
+            ++g_LinkStats.m_GoodFrames;
+            g_LastRxTime = stopwatchCurrentTime();
+            g_LastRxAgeValid = true;
+
+            if (g_RxFrame[RX_MSG_ID] < EFIX_RX_NUM_MSG_IDS)
+            {
+                g_RxMsgs[g_RxFrame[RX_MSG_ID]].m_Payload = ((uint16_t)g_RxFrame[RX_DATA_HIGH] << 8) | g_RxFrame[RX_DATA_LOW];
+                g_RxMsgs[g_RxFrame[RX_MSG_ID]].m_Time = g_LastRxTime;
+                g_RxMsgs[g_RxFrame[RX_MSG_ID]].m_Received = true;
+            }
+            else
+            {
+                ++g_LinkStats.m_UnknownFrames;
+            }
+            break;
     }
 }
+
 //------------------------------------------------------------------------------
 // Function: CalcChecksum()
 // Description: This function calculates the checksum and puts in the 
@@ -312,6 +616,31 @@ void CalcChecksum(unsigned char *buffer)
     buffer[5] = (unsigned char)(checksum & 0xff);
 }
 
+//------------------------------------------------------------------------------
+// Function: UpdateFramePayload
+// Description: Puts a new value in a frame that already has a good checksum.
+//      The checksum is the 2's complement of the sum of the first 4 bytes, so
+//      it only needs to move by however much the 2 data bytes moved.
+//------------------------------------------------------------------------------
+static void UpdateFramePayload (unsigned char *frame, int value)
+{
+    unsigned char high = (unsigned char)(value >> 8);
+    unsigned char low = (unsigned char)(value & 0xff);
+    uint16_t checksum;
+
+    if ((frame[2] == high) && (frame[3] == low))
+        return;
+
+    checksum = ((uint16_t)frame[4] << 8) | frame[5];
+    checksum += (uint16_t)frame[2] + frame[3];
+    checksum -= (uint16_t)high + low;
+
+    frame[2] = high;
+    frame[3] = low;
+    frame[4] = (unsigned char)(checksum >> 8);
+    frame[5] = (unsigned char)(checksum & 0xff);
+}
+
 //------------------------------------------------------------------------------
 // This creates the blank, do nothing message.
 //------------------------------------------------------------------------------
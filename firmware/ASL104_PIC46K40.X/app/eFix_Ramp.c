@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: eFix_Ramp.c
+//
+// Description: Ramps the speed and steering sent to the eFix toward the demands.
+//
+//  Nothing here touches the hardware, so it builds on the host as well. See
+//  tools/efix_ramp_test for the test of the ramp profiles.
+//
+// Author(s): G. Chopcinski (Kg Solutions, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+/* **************************   Header Files   *************************** */
+
+#include "eFix_Ramp.h"
+
+/* *******************   Public Function Definitions   ******************** */
+
+//------------------------------------------------------------------------------
+// Function: eFix_RampToward
+//
+// Description: Moves output one update closer to target. Moving away from
+//      neutral is limited to accelStep, moving toward neutral to decelStep.
+//      When the target is on the other side of neutral the output first comes
+//      back to neutral at the decel rate, then heads out at the accel rate.
+//      Integer only, no multiply or divide.
+//
+//------------------------------------------------------------------------------
+
+int eFix_RampToward (int output, int target, int accelStep, int decelStep)
+{
+    int limit;
+
+    if ((output > 0) && (target < output))
+    {
+        // Slowing down. Don't go past neutral this update.
+        limit = (target > 0) ? target : 0;
+        output -= decelStep;
+        if (output < limit)
+            output = limit;
+    }
+    else if ((output < 0) && (target > output))
+    {
+        limit = (target < 0) ? target : 0;
+        output += decelStep;
+        if (output > limit)
+            output = limit;
+    }
+    else if (target > output)
+    {
+        // Speeding up, at or heading away from neutral.
+        output += accelStep;
+        if (output > target)
+            output = target;
+    }
+    else if (target < output)
+    {
+        output -= accelStep;
+        if (output < target)
+            output = target;
+    }
+
+    return output;
+}
+
+// end of file.
+//-------------------------------------------------------------------------
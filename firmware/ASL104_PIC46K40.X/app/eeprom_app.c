@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "user_assert.h"
 
 // from RTOS
@@ -37,7 +38,9 @@
 
 // from local
 #include "eeprom_bsp.h"
+#include "crc_bsp.h"
 #include "eeprom_app.h"
+#include "event_log.h"
 
 /* ******************************   Macros   ****************************** */
 
@@ -57,57 +60,112 @@
 
 #ifdef ASL110
 
-#define MM_EEPROM_INITIALIZED 						((uint8_t)0x00)
+// Older firmware kept the items here, laid out the same as EepromDataItems_t.
+#define EEPROM_FIXED_MAP_ADDR						((uint16_t)0x000)
 
-#define MM_LEFT_PAD_INPUT_TYPE 						((uint8_t)MM_EEPROM_INITIALIZED + ITEM_TYPE_UINT8_SIZE_BYTES)
-#define MM_RIGHT_PAD_INPUT_TYPE 					((uint8_t)MM_LEFT_PAD_INPUT_TYPE + ITEM_TYPE_ENUM_SIZE_BYTES)
-#define MM_CENTER_PAD_INPUT_TYPE 					((uint8_t)MM_RIGHT_PAD_INPUT_TYPE + ITEM_TYPE_ENUM_SIZE_BYTES)
+// The C type each item type is kept as.
+#define ITEM_C_TYPE_BOOL							uint8_t
+#define ITEM_C_TYPE_ENUM							EepromStoredEnumType_t
+#define ITEM_C_TYPE_UINT8							uint8_t
+#define ITEM_C_TYPE_UINT16							uint16_t
 
-#define MM_LEFT_PAD_OUTPUT_MAP 						((uint8_t)MM_CENTER_PAD_INPUT_TYPE + ITEM_TYPE_ENUM_SIZE_BYTES)
-#define MM_RIGHT_PAD_OUTPUT_MAP 					((uint8_t)MM_LEFT_PAD_OUTPUT_MAP + ITEM_TYPE_ENUM_SIZE_BYTES)
-#define MM_CENTER_PAD_OUTPUT_MAP 					((uint8_t)MM_RIGHT_PAD_OUTPUT_MAP + ITEM_TYPE_ENUM_SIZE_BYTES)
+// Defaults in EEPROM_ITEM_LIST that depend on the build.
+#ifdef USE_12VOLT_REGULATOR
+#define EEPROM_NEUTRAL_DAC_COUNTS_DEFAULT			(2048 + 212)	// Mid-point of 12-bit DAC
+#define EEPROM_NEUTRAL_DAC_SETTING_DEFAULT			(2040 + 212)	// Mid-point of 12-bit DAC
+#else
+#define EEPROM_NEUTRAL_DAC_COUNTS_DEFAULT			2048			// Mid-point of 12-bit DAC
+#define EEPROM_NEUTRAL_DAC_SETTING_DEFAULT			2032			// Mid-point of 12-bit DAC
+#endif
+
+// Room left for items added later, so the profiles that follow don't move.
+#define EEPROM_DATA_RESERVED_BYTES					((uint8_t)64)
+#define EEPROM_PROFILE_RESERVED_BYTES				((uint8_t)24)
+
+// First version with profiles. Before it the PROFILE items only had the one value.
+#define EEPROM_VERSION_PROFILES						((uint8_t)7)
+
+// Pick the generated code for an item by its scope in EEPROM_ITEM_LIST.
+#define PROFILE_ITEM_ENUM_GLOBAL(id)
+#define PROFILE_ITEM_ENUM_PROFILE(id)						PROFILE_ITEM_##id,
+#define PROFILE_ITEM_ID_GLOBAL(id)
+#define PROFILE_ITEM_ID_PROFILE(id)							EEPROM_STORED_ITEM_##id,
+#define PROFILE_ITEM_FIELD_GLOBAL(type, field)
+#define PROFILE_ITEM_FIELD_PROFILE(type, field)				ITEM_C_TYPE_##type field;
+#define PROFILE_ITEM_INFO_GLOBAL(id, field)					NOT_A_PROFILE_ITEM, 0
+#define PROFILE_ITEM_INFO_PROFILE(id, field)				PROFILE_ITEM_##id, offsetof(EepromProfileItems_t, field)
+#define DEFAULT_SET_GLOBAL(type, field, default_val)		settings.data.items.field = (ITEM_C_TYPE_##type)(default_val);
+#define DEFAULT_SET_PROFILE(type, field, default_val)		settings.data.items.field = settings.profiles[0].items.field = (ITEM_C_TYPE_##type)(default_val);
+
+#define NOT_A_PROFILE_ITEM							((uint8_t)0xFF)
+
+#endif // #ifdef ASL110
 
-#define MM_USER_BTN_LONG_PRESS_ACT_TIME 			((uint8_t)MM_CENTER_PAD_OUTPUT_MAP + ITEM_TYPE_ENUM_SIZE_BYTES)
+/* ***************************    Settings Log     ************************* */
 
-#define MM_ENABLED_FEATURES							((uint8_t)MM_USER_BTN_LONG_PRESS_ACT_TIME + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_CURRENT_ACTIVE_FEATURE					((uint8_t)MM_ENABLED_FEATURES + ITEM_TYPE_UINT8_SIZE_BYTES)
+// Firmware up to EEPROM version 6 kept every item at a fixed address, from address 0.
+// Frequently changed items wore the same cells out every time. Settings now live in a log
+// instead:
+//
+// 	Two pages take turns. A page is a header, a snapshot of settings, then a run of records.
+// 	Changing an item appends a record {slot, value, sequence} after the last one. When the
+// 	page fills, the whole RAM copy is written as the snapshot of the other page, which then
+// 	takes over. Boot loads the newest valid page's snapshot and replays its records.
+//
+// 	The header carries a CRC of the snapshot. A page whose snapshot doesn't match it is
+// 	skipped in favour of the other page, and failing that the defaults are used.
+//
+// 	The records from one flush go in as a group, the last one flagged as the commit. Boot only
+// 	replays up to the last commit, so a flush cut short by a power loss is dropped as a whole
+// 	rather than leaving some items new and some old.
+//
+// 	A record's slot says which item it holds. GLOBAL items use their item id. Each profile's
+// 	PROFILE items have slots of their own from EEPROM_LOG_PROFILE_SLOTS_BASE up, so a change
+// 	to one profile is saved to it whichever profile is active by then.
+//
+// 	Records start straight after the snapshot, which is as long as the firmware that wrote
+// 	the page made it.
+//
+// The fixed map at address 0 is only read, to bring settings over from older firmware.
 
-#define MM_LEFT_PAD_MIN_ADC_VAL						((uint8_t)MM_CURRENT_ACTIVE_FEATURE + ITEM_TYPE_ENUM_SIZE_BYTES)
-#define MM_LEFT_PAD_MAX_ADC_VAL						((uint8_t)MM_LEFT_PAD_MIN_ADC_VAL + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_LEFT_PAD_MIN_THRESH_PERC                 ((uint8_t)MM_LEFT_PAD_MAX_ADC_VAL + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_LEFT_PAD_MAX_THRESH_PERC             	((uint8_t)MM_LEFT_PAD_MIN_THRESH_PERC + ITEM_TYPE_UINT16_SIZE_BYTES)
+#ifdef ASL110
 
-#define MM_RIGHT_PAD_MIN_ADC_VAL					((uint8_t)MM_LEFT_PAD_MAX_THRESH_PERC + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_RIGHT_PAD_MAX_ADC_VAL					((uint8_t)MM_RIGHT_PAD_MIN_ADC_VAL + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_RIGHT_PAD_MIN_THRESH_PERC                ((uint8_t)MM_RIGHT_PAD_MAX_ADC_VAL + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_RIGHT_PAD_MAX_THRESH_PERC            	((uint8_t)MM_RIGHT_PAD_MIN_THRESH_PERC + ITEM_TYPE_UINT16_SIZE_BYTES)
+#define EEPROM_LOG_PAGE_SIZE						((uint16_t)320)
+#define EEPROM_LOG_PAGE_A_ADDR						((uint16_t)0x040)
+#define EEPROM_LOG_PAGE_B_ADDR						(EEPROM_LOG_PAGE_A_ADDR + EEPROM_LOG_PAGE_SIZE)
 
-#define MM_CTR_PAD_MIN_ADC_VAL						((uint8_t)MM_RIGHT_PAD_MAX_THRESH_PERC + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_CTR_PAD_MAX_ADC_VAL						((uint8_t)MM_CTR_PAD_MIN_ADC_VAL + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_CTR_PAD_MIN_THRESH_PERC          		((uint8_t)MM_CTR_PAD_MAX_ADC_VAL + ITEM_TYPE_UINT16_SIZE_BYTES)
-#define MM_CTR_PAD_MAX_THRESH_PERC      			((uint8_t)MM_CTR_PAD_MIN_THRESH_PERC + ITEM_TYPE_UINT16_SIZE_BYTES)
+// Written to the header last, once the rest of the page is in.
+#define EEPROM_LOG_PAGE_VALID						((uint8_t)0x5A)
+#define EEPROM_LOG_PAGE_INVALID						((uint8_t)0x00)
 
-// Added in Version 2 of EEPROM
-#define MM_NEUTRAL_DAC_COUNTS       				((uint8_t)MM_CTR_PAD_MAX_THRESH_PERC + ITEM_TYPE_UINT16_SIZE_BYTES) // 16bits
-#define MM_NEUTRAL_DAC_SETTING      				((uint8_t)MM_NEUTRAL_DAC_COUNTS + ITEM_TYPE_UINT16_SIZE_BYTES)      // 16bits
-#define MM_NEUTRAL_DAC_RANGE          				((uint8_t)MM_NEUTRAL_DAC_SETTING + ITEM_TYPE_UINT16_SIZE_BYTES)     // 16bits
+// Where the records start, and how many fit, in a page this firmware wrote.
+#define EEPROM_LOG_SNAPSHOT_OFFSET					((uint16_t)sizeof(EepromLogHeader_t))
+#define EEPROM_LOG_RECORDS_OFFSET					(EEPROM_LOG_SNAPSHOT_OFFSET + (uint16_t)sizeof(EepromSettings_t))
+#define EEPROM_LOG_NUM_RECORDS(records_offset)		((uint8_t)((EEPROM_LOG_PAGE_SIZE - (records_offset)) / sizeof(EepromLogRecord_t)))
 
-// Added in Version 3 of EEPROM
-#define MM_EEPROM_VERSION                   		((uint8_t)MM_NEUTRAL_DAC_RANGE + ITEM_TYPE_UINT16_SIZE_BYTES)     // 16bits
+// A flush with more changes than this writes a new page instead.
+#define EEPROM_LOG_MAX_APPEND						((uint8_t)16)
 
-// Added in Version 4 of EEPROM and changed the name in Version 5
-//#define MM_DRIVE_OFFSET                             ((uint8_t)MM_EEPROM_VERSION + ITEM_TYPE_UINT8_SIZE_BYTES)
-#define MM_CENTER_PAD_MIN_DRIVE_SPEED               ((uint8_t)MM_EEPROM_VERSION + ITEM_TYPE_UINT8_SIZE_BYTES)
+#define EEPROM_LOG_PROFILE_SLOTS_BASE				((uint8_t)64)
+#define EEPROM_LOG_PROFILE_SLOTS_PER_PROFILE		((uint8_t)16)
+#define EEPROM_LOG_PROFILE_SLOT(profile, profile_item)	((uint8_t)(EEPROM_LOG_PROFILE_SLOTS_BASE + (profile) * EEPROM_LOG_PROFILE_SLOTS_PER_PROFILE + (profile_item)))
+#define EEPROM_LOG_NUM_SLOTS						((uint8_t)(EEPROM_LOG_PROFILE_SLOTS_BASE + EEPROM_NUM_PROFILES * EEPROM_LOG_PROFILE_SLOTS_PER_PROFILE))
 
-// Added in Version 5. Added minimum Drive Speed for all 3 speed but reusng the minimum drive speed for the Center Pad Minimum Drive Speed.
-#define MM_LEFT_PAD_MIN_DRIVE_SPEED                 ((uint8_t)MM_CENTER_PAD_MIN_DRIVE_SPEED + ITEM_TYPE_UINT8_SIZE_BYTES)
-#define MM_RIGHT_PAD_MIN_DRIVE_SPEED                ((uint8_t)MM_LEFT_PAD_MIN_DRIVE_SPEED + ITEM_TYPE_UINT8_SIZE_BYTES)
+// One bit per slot, set when it has been updated in RAM but not in EEPROM.
+#define SLOTS_DIRTY_NUM_BYTES						(EEPROM_LOG_NUM_SLOTS / 8)
 
-// Version 6. Added Feature Byte 2 to accomodate RNet Sleep and Mode Switch schema
-#define MM_ENABLED_FEATURES_2						((uint8_t)MM_RIGHT_PAD_MIN_DRIVE_SPEED + ITEM_TYPE_UINT8_SIZE_BYTES)
+// A record is only good if its sequence is the next one expected for the page. Stale records
+// left over from an earlier use of the page carry a different generation so they don't match.
+#define EEPROM_LOG_RECORD_SEQ(generation, index)	((uint8_t)((generation) + (index)))
 
-// Must be last item in this list. Denotes the total amount of real estate taken up in EEPROM.
-#define MM_NUM_BYTES								((uint8_t)MM_RIGHT_PAD_MIN_DRIVE_SPEED + ITEM_TYPE_UINT8_SIZE_BYTES)
+// Reserved area after the log pages. Counts how many times each page has been written, which is
+// how many times each of its cells has been. The header's valid byte goes in twice each time.
+#define EEPROM_WEAR_ADDR							(EEPROM_LOG_PAGE_B_ADDR + EEPROM_LOG_PAGE_SIZE)
+#define EEPROM_WEAR_NUM_BYTES						((uint16_t)sizeof(log_page_writes))
+
+// Set in the slot of the last record of a flush.
+#define EEPROM_LOG_RECORD_COMMIT					((uint8_t)0x80)
+#define EEPROM_LOG_RECORD_SLOT(record)				((uint8_t)((record).slot & ~EEPROM_LOG_RECORD_COMMIT))
 
 #endif // #ifdef ASL110
 
@@ -133,188 +191,184 @@ typedef struct
 {
 	ItemType_t type;
 
-	// Position in RAM and physical memory address in EEPROM that the item lives.
+	// Position in settings.data, and in the fixed map.
 	uint8_t start_addr;
 
-	// True when an item has been updated in RAM but not in EEPROM.
-	bool need_to_save;
+	// PROFILE items only, which one it is and its position in each profile. The item's
+	// start_addr is then only used by migrations from before there were profiles.
+	uint8_t profile_item;
+	uint8_t profile_addr;
 } ItemInfo_t;
 
+// The PROFILE items, in the order they're in EEPROM_ITEM_LIST.
+typedef enum
+{
+#define EEPROM_PROFILE_ITEM_ENUM(id, type, field, default_val, scope)	PROFILE_ITEM_ENUM_##scope(id)
+	EEPROM_ITEM_LIST(EEPROM_PROFILE_ITEM_ENUM)
+#undef EEPROM_PROFILE_ITEM_ENUM
+
+	// Nothing else may be defined past this point!
+	PROFILE_ITEM_EOL
+} ProfileItemId_t;
+
 #endif // #ifdef ASL110
 
 #ifdef ASL110
 
 // No reason to pack the structure, the MCU is 8-bit.
-// This structure can only be ADDED TO or APPENDED. It must never be changed.
-// This is important to allow future proving of firmware updating and preserving
-// existing settings.
+// Generated from EEPROM_ITEM_LIST, which can only be appended to. This is important to allow
+// future proving of firmware updating and preserving existing settings.
 typedef struct
 {
-	uint8_t eeprom_intiailized;
-	
-	EepromStoredEnumType_t left_pad_input_type;
-	EepromStoredEnumType_t right_pad_input_type;
-	EepromStoredEnumType_t center_pad_input_type;
-
-	EepromStoredEnumType_t left_pad_output_map;
-	EepromStoredEnumType_t right_pad_output_map;
-	EepromStoredEnumType_t center_pad_output_map;
-
-	uint16_t user_btn_long_press_act_time;
-
-	uint8_t enabled_features;
-	EepromStoredEnumType_t current_active_feature;
-
-	uint16_t left_pad_min_adc_val;
-	uint16_t left_pad_max_adc_val;
-	uint16_t left_pad_min_thresh_perc;
-	uint16_t left_pad_max_thresh_perc;
-
-	uint16_t right_pad_min_adc_val;
-	uint16_t right_pad_max_adc_val;
-	uint16_t right_pad_min_thresh_perc;
-	uint16_t right_pad_max_thresh_perc;
-
-	uint16_t ctr_pad_min_adc_val;
-	uint16_t ctr_pad_max_adc_val;
-	uint16_t ctr_pad_min_thresh_perc;
-	uint16_t ctr_pad_max_thresh_perc;
-    
-    // Added in eeprom version 2
-    uint16_t neutral_DAC_counts; // TODO: What is the purpose of this variable?  It is not used.
-    uint16_t neutral_DAC_setting;
-    uint16_t neutral_DAC_range;
-    
-    // Added in EEPROM version 3
-    uint8_t EEPROM_Version;     // Identifies the version/makeup of the stored data.
-    
-    // Added in EEPROM version 4
-    // Changed to "Center" in EERPOM version 5
-    uint8_t CenterPad_MinimumDriveSpeed;       // this is the drive percentage when in proportional
-                                // .. and the digital sensor is active.
-    
-    // Added in EEPROM version 5
-    uint8_t LeftPad_MinimumDriveSpeed;
-    uint8_t RightPad_MinimumDriveSpeed;
-    
-    // Added in EEPROM Version 6
-    uint8_t enabled_features2;
-    
+#define EEPROM_ITEM_FIELD(id, type, field, default_val, scope)	ITEM_C_TYPE_##type field;
+	EEPROM_ITEM_LIST(EEPROM_ITEM_FIELD)
+#undef EEPROM_ITEM_FIELD
 } EepromDataItems_t;
 
 typedef union
 {
 	EepromDataItems_t items;
-	uint8_t bytes[MM_NUM_BYTES];
+	uint8_t bytes[EEPROM_DATA_RESERVED_BYTES];
 } EepromData_t;
-#endif // #ifdef ASL110
-
-/* ***********************   File Scope Variables   *********************** */
-
-#ifdef ASL110
 
-static volatile EepromData_t eeprom_data;
-static volatile uint8_t num_times_any_item_has_updated;
+// One profile's own copy of the PROFILE items.
+typedef struct
+{
+#define EEPROM_PROFILE_FIELD(id, type, field, default_val, scope)	PROFILE_ITEM_FIELD_##scope(type, field)
+	EEPROM_ITEM_LIST(EEPROM_PROFILE_FIELD)
+#undef EEPROM_PROFILE_FIELD
+} EepromProfileItems_t;
 
-// Must match EepromItemId_t exactly!
-static ItemInfo_t items_info[] =
+typedef union
 {
-	// EEPROM_STORED_ITEM_EEPROM_INITIALIZED
-	{ITEM_TYPE_UINT8,		MM_EEPROM_INITIALIZED,						false},
+	EepromProfileItems_t items;
+	uint8_t bytes[EEPROM_PROFILE_RESERVED_BYTES];
+} EepromProfile_t;
 
-	// EEPROM_STORED_ITEM_LEFT_PAD_INPUT_TYPE
-	{ITEM_TYPE_ENUM,		MM_LEFT_PAD_INPUT_TYPE,						false},
+// Everything stored, laid out as it is in a snapshot.
+typedef struct
+{
+	EepromData_t data;
+	EepromProfile_t profiles[EEPROM_NUM_PROFILES];
+} EepromSettings_t;
+#endif // #ifdef ASL110
 
-	// EEPROM_STORED_ITEM_RIGHT_PAD_INPUT_TYPE
-	{ITEM_TYPE_ENUM,		MM_RIGHT_PAD_INPUT_TYPE,					false},
+#ifdef ASL110
 
-	// EEPROM_STORED_ITEM_CTR_PAD_INPUT_TYPE
-	{ITEM_TYPE_ENUM,		MM_CENTER_PAD_INPUT_TYPE,					false},
+// First thing in a settings log page.
+typedef struct
+{
+	uint8_t valid;				// EEPROM_LOG_PAGE_VALID once the page is complete.
+	uint8_t generation;			// Goes up by one every time the pages swap.
+	uint8_t snapshot_len;		// sizeof(EepromSettings_t) of the firmware that wrote it.
+	uint16_t snapshot_crc;		// crcBspCalc16() of the snapshot.
+} EepromLogHeader_t;
 
-	// EEPROM_STORED_ITEM_LEFT_PAD_OUTPUT_MAP
-	{ITEM_TYPE_ENUM,		MM_LEFT_PAD_OUTPUT_MAP,						false},
+// The start of a page, or the fixed map, as it comes off the EEPROM in one read.
+typedef struct
+{
+	EepromLogHeader_t header;
+	EepromSettings_t snapshot;
+} EepromLogPage_t;
 
-	// EEPROM_STORED_ITEM_RIGHT_PAD_OUTPUT_MAP
-	{ITEM_TYPE_ENUM,		MM_RIGHT_PAD_OUTPUT_MAP,					false},
+// One changed item. The sequence is written last, so a record cut short by a power loss
+// doesn't count. Slots have to stay below EEPROM_LOG_RECORD_COMMIT.
+typedef struct
+{
+	uint8_t slot;
+	uint8_t val_lo;
+	uint8_t val_hi;
+	uint8_t seq;
+} EepromLogRecord_t;
+
+STATIC_ASSERT((uint8_t)EEPROM_STORED_ITEM_EOL <= EEPROM_LOG_PROFILE_SLOTS_BASE, item_ids_below_profile_slots);
+STATIC_ASSERT((uint8_t)PROFILE_ITEM_EOL <= EEPROM_LOG_PROFILE_SLOTS_PER_PROFILE, profile_items_fit_in_slots);
+STATIC_ASSERT(EEPROM_LOG_NUM_SLOTS <= EEPROM_LOG_RECORD_COMMIT, slots_fit_in_log_records);
+STATIC_ASSERT(sizeof(EepromDataItems_t) <= EEPROM_DATA_RESERVED_BYTES, items_fit_in_reserved_room);
+STATIC_ASSERT(sizeof(EepromProfileItems_t) <= EEPROM_PROFILE_RESERVED_BYTES, profile_items_fit_in_reserved_room);
+STATIC_ASSERT(sizeof(EepromSettings_t) <= UINT8_MAX, snapshot_len_fits_in_header);
+STATIC_ASSERT(EEPROM_LOG_RECORDS_OFFSET + EEPROM_LOG_MAX_APPEND * sizeof(EepromLogRecord_t) <= EEPROM_LOG_PAGE_SIZE, log_page_fits_a_full_append);
+STATIC_ASSERT(EEPROM_LOG_PAGE_A_ADDR >= EEPROM_FIXED_MAP_ADDR + sizeof(EepromData_t), log_clear_of_fixed_map);
+STATIC_ASSERT(EEPROM_WEAR_ADDR + EEPROM_NUM_LOG_PAGES * sizeof(uint32_t) <= EVENT_LOG_EEPROM_ADDR, wear_counts_clear_of_event_log);
+STATIC_ASSERT(EEPROM_DATA_STRUCTURE_VERSION >= EEPROM_VERSION_PROFILES, version_has_profiles);
 
-	// EEPROM_STORED_ITEM_CTR_PAD_OUTPUT_MAP
-	{ITEM_TYPE_ENUM,		MM_CENTER_PAD_OUTPUT_MAP,					false},
-	
-	// EEPROM_STORED_ITEM_USER_BTN_LONG_PRESS_ACT_TIME
-	{ITEM_TYPE_UINT16,		MM_USER_BTN_LONG_PRESS_ACT_TIME,			false},
+#endif // #ifdef ASL110
 
-	// EEPROM_STORED_ITEM_ENABLED_FEATURES
-	{ITEM_TYPE_UINT8,		MM_ENABLED_FEATURES,						false},
-	
-	// EEPROM_STORED_ITEM_CURRENT_ACTIVE_FEATURE
-	{ITEM_TYPE_ENUM,		MM_CURRENT_ACTIVE_FEATURE,					false},
+#ifdef ASL110
 
-	// EEPROM_STORED_ITEM_LEFT_PAD_MIN_ADC_VAL
-	{ITEM_TYPE_UINT16,		MM_LEFT_PAD_MIN_ADC_VAL,					false},
+typedef enum
+{
+	MIGRATE_ADD,			// Item is new, give it its default value.
+	MIGRATE_COPY,			// Item takes the value of another item.
+	MIGRATE_TRANSFORM,		// Item is worked out from its old value.
+	MIGRATE_SPLIT_PROFILES,	// Every profile takes the one value the PROFILE items had.
 
-	// EEPROM_STORED_ITEM_LEFT_PAD_MAX_ADC_VAL
-	{ITEM_TYPE_UINT16,		MM_LEFT_PAD_MAX_ADC_VAL,					false},
+	// Nothing else may be defined past this point!
+	MIGRATE_EOL
+} MigrateOp_t;
 
-	// EEPROM_STORED_ITEM_LEFT_PAD_MIN_THRESH_PERC
-	{ITEM_TYPE_UINT16,		MM_LEFT_PAD_MIN_THRESH_PERC,        		false},
+// One step in bringing the items stored by an older EEPROM version up to date.
+typedef struct
+{
+	uint8_t from_version;			// Applies when upgrading from this version or older.
+	MigrateOp_t op;
+	EepromItemId_t item_id;
+	EepromItemId_t src_item_id;		// MIGRATE_COPY only.
+	uint16_t (*transform)(uint16_t val);	// MIGRATE_TRANSFORM only.
+} MigrateStep_t;
 
-	// EEPROM_STORED_ITEM_LEFT_PAD_MAX_THRESH_PERC
-	{ITEM_TYPE_UINT16,		MM_LEFT_PAD_MAX_THRESH_PERC,        		false},
+#endif // #ifdef ASL110
 
-	// EEPROM_STORED_ITEM_RIGHT_PAD_MIN_ADC_VAL
-	{ITEM_TYPE_UINT16,		MM_RIGHT_PAD_MIN_ADC_VAL,					false},
+/* ***********************   File Scope Variables   *********************** */
 
-	// EEPROM_STORED_ITEM_RIGHT_PAD_MAX_ADC_VAL
-	{ITEM_TYPE_UINT16,		MM_RIGHT_PAD_MAX_ADC_VAL,					false},
+#ifdef ASL110
 
-	// EEPROM_STORED_ITEM_RIGHT_PAD_MIN_THRESH_PERC
-	{ITEM_TYPE_UINT16,		MM_RIGHT_PAD_MIN_THRESH_PERC,       		false},
+static volatile EepromSettings_t settings;
+static volatile uint8_t num_times_any_item_has_updated;
 
-	// EEPROM_STORED_ITEM_RIGHT_PAD_MAX_THRESH_PERC
-	{ITEM_TYPE_UINT16,		MM_RIGHT_PAD_MAX_THRESH_PERC,       		false},
+// The profile PROFILE items are got from and set in.
+static volatile EepromProfile_t *active_profile;
 
-	// EEPROM_STORED_ITEM_CTR_PAD_MIN_ADC_VAL
-	{ITEM_TYPE_UINT16,		MM_CTR_PAD_MIN_ADC_VAL,						false},
+// True while migrating from before there were profiles. PROFILE items are then still their
+// one value in settings.data.
+static bool items_flat;
 
-	// EEPROM_STORED_ITEM_CTR_PAD_MAX_ADC_VAL
-	{ITEM_TYPE_UINT16,		MM_CTR_PAD_MAX_ADC_VAL,						false},
+// Generated in the same order as EepromItemId_t, so indexed by it.
+static const ItemInfo_t items_info[] =
+{
+#define EEPROM_ITEM_INFO(id, type, field, default_val, scope)	{ITEM_TYPE_##type, offsetof(EepromDataItems_t, field), PROFILE_ITEM_INFO_##scope(id, field)},
+	EEPROM_ITEM_LIST(EEPROM_ITEM_INFO)
+#undef EEPROM_ITEM_INFO
+};
 
-	// EEPROM_STORED_ITEM_CTR_PAD_MIN_THRESH_PERC
-	{ITEM_TYPE_UINT16,		MM_CTR_PAD_MIN_THRESH_PERC,         		false},
+// Indexed by ProfileItemId_t.
+static const EepromItemId_t profile_item_ids[] =
+{
+#define EEPROM_PROFILE_ITEM_ID(id, type, field, default_val, scope)	PROFILE_ITEM_ID_##scope(id)
+	EEPROM_ITEM_LIST(EEPROM_PROFILE_ITEM_ID)
+#undef EEPROM_PROFILE_ITEM_ID
+};
 
-	// EEPROM_STORED_ITEM_CTR_PAD_MAX_THRESH_PERC
-	{ITEM_TYPE_UINT16,		MM_CTR_PAD_MAX_THRESH_PERC,         		false},
+static uint8_t slots_dirty[SLOTS_DIRTY_NUM_BYTES];
 
-    // Added in eeprom version 2
+// Applied in order, oldest version first. When EEPROM_DATA_STRUCTURE_VERSION is bumped, add the
+// steps that take the previous version's items to the new one here.
+static const MigrateStep_t migrate_steps[] =
+{
+	// Version 4 added a minimum drive offset.
+	{3,		MIGRATE_ADD,	EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET,	EEPROM_STORED_ITEM_EOL,		NULL},
 
-	// EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_COUNTS
-	{ITEM_TYPE_UINT16,		MM_NEUTRAL_DAC_COUNTS,                      false},
+	// Version 5 made that the center pad's minimum drive speed, and gave the other two pads
+	// one each. They start off the same as the center pad.
+	{4,		MIGRATE_COPY,	EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET,	EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET,	NULL},
+	{4,		MIGRATE_COPY,	EEPROM_STORED_ITEM_MM_RIGHT_PAD_MINIMUM_DRIVE_OFFSET,	EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET,	NULL},
 
-	// EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_SETTING
-	{ITEM_TYPE_UINT16,		MM_NEUTRAL_DAC_SETTING,                 	false},
+	// Version 6 added Feature Byte 2, for RNet Sleep and Mode Switch Schema.
+	{5,		MIGRATE_ADD,	EEPROM_STORED_ITEM_ENABLED_FEATURES_2,					EEPROM_STORED_ITEM_EOL,		NULL},
 
-	// EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_RANGE
-	{ITEM_TYPE_UINT16,		MM_NEUTRAL_DAC_RANGE,               		false},
-    
-    // Added in EEPROM Version 3
-    // EEPROM_STORED_ITEM_MM_EEPROM_VERSION
-    {ITEM_TYPE_UINT8, MM_EEPROM_VERSION,                                false},
-
-    // Added in EEPROM Version 4
-    // EEPROM_STORED_ITEM_MM_MINIMUM_DRIVE_OFFSET
-    //{ITEM_TYPE_UINT8, MM_DRIVE_OFFSET,                                false},
-
-    // Changes to EEPROM Version 5
-    // EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET
-    {ITEM_TYPE_UINT8, MM_CENTER_PAD_MIN_DRIVE_SPEED,                    false},
-    // EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET
-    {ITEM_TYPE_UINT8, MM_LEFT_PAD_MIN_DRIVE_SPEED,                      false},
-    // EEPROM_STORED_ITEM_MM_RIGHT_PAD_MINIMUM_DRIVE_OFFSET
-    {ITEM_TYPE_UINT8, MM_RIGHT_PAD_MIN_DRIVE_SPEED,                     false},
-
-    // Added in Version 6
-    // EEPROM_STORED_ITEM_ENABLED_FEATURES_2
-	{ITEM_TYPE_UINT8,		MM_ENABLED_FEATURES_2,						false}
+	// Version 7 gave each profile its own pad settings, all starting off as they were.
+	{6,		MIGRATE_ADD,	EEPROM_STORED_ITEM_ACTIVE_PROFILE,						EEPROM_STORED_ITEM_EOL,		NULL},
+	{6,		MIGRATE_SPLIT_PROFILES,	EEPROM_STORED_ITEM_EOL,							EEPROM_STORED_ITEM_EOL,		NULL}
 };
 #endif // #ifdef ASL110
 
@@ -322,22 +376,52 @@ static ItemInfo_t items_info[] =
 
 static volatile bool at_least_one_item_requires_saving;
 
+// Signaled once everything eepromFlush() queued has been written.
+static Evt_t flush_done_event;
+
+// Where the next record goes.
+static uint16_t log_page_addr;
+static uint8_t log_generation;
+static uint8_t log_num_records;
+
+// Where the current page's records start and how many it has room for.
+static uint16_t log_records_offset;
+static uint8_t log_max_records;
+
+static const uint8_t log_page_invalid = EEPROM_LOG_PAGE_INVALID;
+
+// A forced save couldn't be queued, so the next flush has to write a whole page.
+static bool compact_pending;
+
+static EepromLogPage_t log_page_buff;
+
+// Indexed by page, A then B.
+static uint32_t log_page_writes[EEPROM_NUM_LOG_PAGES];
+
 #endif // #ifdef ASL110
 
 /* ***********************   Function Prototypes   ************************ */
 
 #ifdef ASL110
 static bool SyncWithEeprom(void);
-static void EepromIsProgrammedValWrite(void);
-
-inline static void Write8bitVal(uint8_t address, uint8_t new_val);
-inline static uint8_t Read8bitVal(uint8_t address);
-
-inline static void Write16bitVal(uint8_t address, uint16_t new_val);
-inline static uint16_t Read16bitVal(uint8_t address);
-
-inline static void Write32bitVal(uint8_t address, uint32_t new_val);
-inline static uint32_t Read32bitVal(uint8_t address);
+static bool LogLoad(bool *log_found);
+static bool LogReadHeader(uint16_t page_addr, EepromLogHeader_t *header);
+static bool LogLoadPage(uint16_t page_addr);
+static void LogReadRecord(uint8_t index, EepromLogRecord_t *record);
+static bool LogAppend(void);
+static bool LogCompact(void);
+static volatile uint8_t *ItemAddr(EepromItemId_t item_id);
+static volatile uint8_t *SlotAddr(uint8_t slot, ItemType_t *type);
+static uint16_t ValueLoad(volatile uint8_t *addr, ItemType_t type);
+static void ValueStore(volatile uint8_t *addr, ItemType_t type, uint16_t val);
+static void ProfileActivate(void);
+static uint16_t ItemDefaultGet(EepromItemId_t item_id);
+static void MigrateFrom(uint8_t version);
+static void MigrateSplitProfiles(void);
+static void ItemDirtySet(EepromItemId_t item_id);
+static void SlotDirtySet(uint8_t slot);
+static void ItemsDirtyClear(void);
+static void FlushDoneIsr(void);
 #endif // #ifdef ASL110
 
 /* *******************   Public Function Definitions   ******************** */
@@ -355,21 +439,47 @@ inline static uint32_t Read32bitVal(uint8_t address);
 
 bool eepromAppInit(void)
 {
-    volatile int8_t EEPROM_Version;
-    int8_t MinimumDriveSpeed;
+    uint8_t EEPROM_Version;
+    bool from_fixed_map = false;
     
 	at_least_one_item_requires_saving = false;
 	num_times_any_item_has_updated = 0;
+	compact_pending = false;
+	items_flat = false;
 
 	eepromBspInit();
 
+	// Erased EEPROM reads back all 1s.
+	(void)eepromBspReadSection(EEPROM_WEAR_ADDR, EEPROM_WEAR_NUM_BYTES, (uint8_t *)log_page_writes, 0);
+	for (uint8_t i = 0; i < EEPROM_NUM_LOG_PAGES; i++)
+	{
+		if (log_page_writes[i] == UINT32_MAX)
+		{
+			log_page_writes[i] = 0;
+		}
+	}
+
+	flush_done_event = event_create();
+	eepromBspWriteDoneCallbackSet(FlushDoneIsr);
+
     SetDefaultValues(); // Load all eeprom items with default values.
 
 #if !defined(SPECIAL_EEPROM_TO_DEFAULT_VALUES)
-	bool eeprom_has_been_initialized = SyncWithEeprom();
+	bool log_found;
+	bool eeprom_has_been_initialized = LogLoad(&log_found);
+
+	// A log that failed its CRC means the settings are corrupt. Don't go back to what older
+	// firmware left behind, that's even further out of date. Start over from the defaults.
+	if (!eeprom_has_been_initialized && !log_found)
+	{
+		// Nothing in the log yet. Older firmware may have left settings in the fixed map.
+		eeprom_has_been_initialized = SyncWithEeprom();
+		from_fixed_map = eeprom_has_been_initialized;
+	}
 #else
 	bool eeprom_has_been_initialized = false;
 #endif
+	ProfileActivate();
 
 	if (!eeprom_has_been_initialized)
 	{
@@ -379,42 +489,24 @@ bool eepromAppInit(void)
     else
     {
         // Check to see if the read/retrieved EEPROM data is different than
-        // the data that this firmware version understands. If so, we need to
-        // process any changes and then update the stored EEPROM version
-        // and then write the new stuff to the EEPROM.
+        // the data that this firmware version understands. If so, bring the
+        // items up to date in RAM and store the new version with them.
         EEPROM_Version = eeprom8bitGet (EEPROM_STORED_ITEM_MM_EEPROM_VERSION);
         if (EEPROM_Version != EEPROM_DATA_STRUCTURE_VERSION)
         {
-            if (EEPROM_Version == 3)
-            {
-                // Need to add items since Version 3.
-                //eeprom8bitSet (EEPROM_STORED_ITEM_MM_MINIMUM_DRIVE_OFFSET, 20); // Add minimum drive offset
-                // The above got replaced by the following 3 pad minimum speed schema
-                eeprom8bitSet (EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET, 20); // Add minimum drive offset
-                EEPROM_Version = 4; // This allows any further updating to occur
-            }
-            if (EEPROM_Version == 4)
-            {
-                // We changed the one Minimum Drive Speed to Center Pad Minimum Speed
-                // ... and we will leave it at the same value.
-                // In fact, we will use this value as the default value for the
-                // other 2 pads.
-                MinimumDriveSpeed = eeprom8bitGet (EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET);
-                eeprom8bitSet (EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET, MinimumDriveSpeed); // Add minimum drive offset
-                eeprom8bitSet (EEPROM_STORED_ITEM_MM_RIGHT_PAD_MINIMUM_DRIVE_OFFSET, MinimumDriveSpeed); // Add minimum drive offset
-                EEPROM_Version = 5;
-            }
-            if (EEPROM_Version == 5)
-            {
-                eeprom8bitSet (EEPROM_STORED_ITEM_ENABLED_FEATURES_2, 0); // create the space to hold the New Features, i.e. RNet Sleep and Mode Switch Schema
-                EEPROM_Version = 6; // This allows any further updating to occur
-            }
-            if (EEPROM_Version == 6)
-            {
-                ; // Nothing to do
-            }
+            MigrateFrom(EEPROM_Version);
             eeprom8bitSet (EEPROM_STORED_ITEM_MM_EEPROM_VERSION, EEPROM_DATA_STRUCTURE_VERSION);
-    		eepromFlush(true);
+        }
+
+        if (from_fixed_map)
+        {
+            // Start the log off with what was in the fixed map.
+            eepromFlush(true);
+        }
+        else
+        {
+            // Only what the migration changed.
+            eepromFlush(false);
         }
     }
     
@@ -446,43 +538,88 @@ uint8_t eepromAppNumTimesAnyDataHasBeenUpdated(void)
 // Description: Flushes values currently stored in RAM to flash. Only if required though.  No reason to needlessly
 // 	write to EEPROM and wear it out.
 //
+// 	Changed items are appended to the settings log. A forced save writes a whole new page, as
+// 	does running out of room in the current one.
+//
+// 	The writes are queued and this returns straight away. Wait on eepromFlushDoneEventGet() if it
+// 	matters when they are done. Anything that didn't fit in the queue stays marked as needing
+// 	to be saved and goes out on the next flush.
+//
 //-------------------------------
 #ifdef ASL110
 
 void eepromFlush(bool force_save_all)
 {
-	if (force_save_all || at_least_one_item_requires_saving)
+	if (force_save_all || compact_pending)
 	{
-		for (int item = (int)EEPROM_STORED_ITEM_EEPROM_INITIALIZED; item < (int)EEPROM_STORED_ITEM_EOL; item++)
-		{
-			ItemInfo_t *item_info = &items_info[item];
+		(void)LogCompact();
+	}
+	else if (at_least_one_item_requires_saving)
+	{
+		(void)LogAppend();
+	}
+}
+#endif // #ifdef ASL110
 
-			if (item_info->need_to_save || force_save_all)
-			{
- 				item_info->need_to_save = false;
-
-				switch (item_info->type)
-				{
-					case ITEM_TYPE_BOOL:
-					case ITEM_TYPE_ENUM:
-					case ITEM_TYPE_UINT8:
-						Write8bitVal(item_info->start_addr, eeprom_data.bytes[item_info->start_addr]);
-						break;
-					
-					case ITEM_TYPE_UINT16:
-						Write16bitVal(item_info->start_addr, *((uint16_t *)&eeprom_data.bytes[item_info->start_addr]));
-						break;
-					
-					case ITEM_TYPE_EOL:
-					default:
-						ASSERT(item_info->type == ITEM_TYPE_UINT16);
-						break;
-				}
-			}
-		}
+//-------------------------------
+// Function: eepromFlushBusy
+//
+// Description: Lets the caller know if a flush is still being written to EEPROM.
+//
+//-------------------------------
+#ifdef ASL110
 
-		at_least_one_item_requires_saving = false;
-	}
+bool eepromFlushBusy(void)
+{
+	return eepromBspWriteBusy();
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: eepromFlushDoneEventGet
+//
+// Description: Gets the event that is signaled when the EEPROM has finished writing everything
+//		that was flushed.
+//
+//-------------------------------
+#ifdef ASL110
+
+Evt_t eepromFlushDoneEventGet(void)
+{
+	return flush_done_event;
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: eepromFlushNeeded
+//
+// Description: Lets the caller know if anything is waiting to be flushed, including anything an
+//		earlier flush couldn't fit in the write queue.
+//
+//-------------------------------
+#ifdef ASL110
+
+bool eepromFlushNeeded(void)
+{
+	return at_least_one_item_requires_saving || compact_pending;
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: eepromLogPageWritesGet
+//
+// Description: Gets the number of times a settings log page has been written, over the life of
+//		the unit. Every cell in the page has been written that many times at most, which is
+//		what wears it out.
+//
+// page: 0 to EEPROM_NUM_LOG_PAGES - 1.
+//
+//-------------------------------
+#ifdef ASL110
+
+uint32_t eepromLogPageWritesGet(uint8_t page)
+{
+	return (page < EEPROM_NUM_LOG_PAGES) ? log_page_writes[page] : 0;
 }
 #endif // #ifdef ASL110
 
@@ -496,14 +633,13 @@ void eepromFlush(bool force_save_all)
 
 void eepromBoolSet(EepromItemId_t item_id, bool val)
 {
-	ItemInfo_t *item_info = &items_info[(int)item_id];
-	ASSERT(item_info->type == ITEM_TYPE_BOOL);
+	volatile uint8_t *addr = ItemAddr(item_id);
+	ASSERT(items_info[(int)item_id].type == ITEM_TYPE_BOOL);
 
-	if (eeprom_data.bytes[item_info->start_addr] != (uint8_t)val)
+	if (*addr != (uint8_t)val)
 	{
-		at_least_one_item_requires_saving = true;
-		item_info->need_to_save = true;
-		eeprom_data.bytes[item_info->start_addr] = (uint8_t)val;
+		ItemDirtySet(item_id);
+		*addr = (uint8_t)val;
 		num_times_any_item_has_updated++;
 	}
 }
@@ -520,7 +656,7 @@ void eepromBoolSet(EepromItemId_t item_id, bool val)
 bool eepromBoolGet(EepromItemId_t item_id)
 {
 	ASSERT(items_info[(int)item_id].type == ITEM_TYPE_BOOL);
-	return (bool)eeprom_data.bytes[items_info[(int)item_id].start_addr];
+	return (bool)*ItemAddr(item_id);
 }
 #endif // #ifdef ASL110
 
@@ -534,14 +670,13 @@ bool eepromBoolGet(EepromItemId_t item_id)
 
 void eepromEnumSet(EepromItemId_t item_id, EepromStoredEnumType_t val)
 {
-	ItemInfo_t *item_info = &items_info[(int)item_id];
-	ASSERT(item_info->type == ITEM_TYPE_ENUM);
+	volatile uint8_t *addr = ItemAddr(item_id);
+	ASSERT(items_info[(int)item_id].type == ITEM_TYPE_ENUM);
 
-	if (eeprom_data.bytes[item_info->start_addr] != (uint8_t)val)
+	if (*addr != (uint8_t)val)
 	{
-		at_least_one_item_requires_saving = true;
-		item_info->need_to_save = true;
-		eeprom_data.bytes[item_info->start_addr] = (uint8_t)val;
+		ItemDirtySet(item_id);
+		*addr = (uint8_t)val;
 		num_times_any_item_has_updated++;
 	}
 }
@@ -558,7 +693,7 @@ void eepromEnumSet(EepromItemId_t item_id, EepromStoredEnumType_t val)
 EepromStoredEnumType_t eepromEnumGet(EepromItemId_t item_id)
 {
 	ASSERT(items_info[(int)item_id].type == ITEM_TYPE_ENUM);
-	return (EepromStoredEnumType_t)eeprom_data.bytes[items_info[(int)item_id].start_addr];
+	return (EepromStoredEnumType_t)*ItemAddr(item_id);
 }
 #endif // #ifdef ASL110
 
@@ -572,14 +707,13 @@ EepromStoredEnumType_t eepromEnumGet(EepromItemId_t item_id)
 
 void eeprom8bitSet(EepromItemId_t item_id, uint8_t val)
 {
-	ItemInfo_t *item_info = &items_info[(int)item_id];
-	ASSERT(item_info->type == ITEM_TYPE_UINT8);
+	volatile uint8_t *addr = ItemAddr(item_id);
+	ASSERT(items_info[(int)item_id].type == ITEM_TYPE_UINT8);
 
-	if (eeprom_data.bytes[item_info->start_addr] != val)
+	if (*addr != val)
 	{
-		at_least_one_item_requires_saving = true;
-		item_info->need_to_save = true;
-		eeprom_data.bytes[item_info->start_addr] = val;
+		ItemDirtySet(item_id);
+		*addr = val;
 		num_times_any_item_has_updated++;
 	}
 }
@@ -596,7 +730,7 @@ void eeprom8bitSet(EepromItemId_t item_id, uint8_t val)
 uint8_t eeprom8bitGet(EepromItemId_t item_id)
 {
 	ASSERT(items_info[(int)item_id].type == ITEM_TYPE_UINT8);
-	return (EepromStoredEnumType_t)eeprom_data.bytes[items_info[(int)item_id].start_addr];
+	return *ItemAddr(item_id);
 }
 #endif // #ifdef ASL110
 
@@ -610,14 +744,13 @@ uint8_t eeprom8bitGet(EepromItemId_t item_id)
 
 void eeprom16bitSet(EepromItemId_t item_id, uint16_t val)
 {
-	ItemInfo_t *item_info = &items_info[(int)item_id];
-	ASSERT(item_info->type == ITEM_TYPE_UINT16);
+	volatile uint16_t *addr = (volatile uint16_t *)ItemAddr(item_id);
+	ASSERT(items_info[(int)item_id].type == ITEM_TYPE_UINT16);
 
-	if (*((uint16_t *)&eeprom_data.bytes[item_info->start_addr]) != val)
+	if (*addr != val)
 	{
-		at_least_one_item_requires_saving = true;
-		item_info->need_to_save = true;
-		*((uint16_t *)&eeprom_data.bytes[item_info->start_addr]) = val;
+		ItemDirtySet(item_id);
+		*addr = val;
 		num_times_any_item_has_updated++;
 	}
 }
@@ -634,7 +767,105 @@ void eeprom16bitSet(EepromItemId_t item_id, uint16_t val)
 uint16_t eeprom16bitGet(EepromItemId_t item_id)
 {
 	ASSERT(items_info[(int)item_id].type == ITEM_TYPE_UINT16);
-	return *((uint16_t *)&eeprom_data.bytes[items_info[(int)item_id].start_addr]);
+	return *((volatile uint16_t *)ItemAddr(item_id));
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: eepromItemSizeGet
+//
+// Description: Gets the number of bytes an item takes up, whatever its type.
+//
+// return: 1 or 2, or 0 if item_id is not a valid item.
+//
+//-------------------------------
+#ifdef ASL110
+
+uint8_t eepromItemSizeGet(EepromItemId_t item_id)
+{
+	if ((int)item_id >= (int)EEPROM_STORED_ITEM_EOL)
+	{
+		return 0;
+	}
+
+	return (items_info[(int)item_id].type == ITEM_TYPE_UINT16) ? ITEM_TYPE_UINT16_SIZE_BYTES : ITEM_TYPE_UINT8_SIZE_BYTES;
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: eepromItemSet
+//
+// Description: Sets any item's value without the caller needing to know its type. Used when
+//		items are addressed by id, e.g. from the HHP. 8-bit items only take the low byte of val.
+//
+//-------------------------------
+#ifdef ASL110
+
+void eepromItemSet(EepromItemId_t item_id, uint16_t val)
+{
+	ItemType_t type = items_info[(int)item_id].type;
+
+	if (eepromItemGet(item_id) != ((type == ITEM_TYPE_UINT16) ? val : (uint8_t)val))
+	{
+		ValueStore(ItemAddr(item_id), type, val);
+		ItemDirtySet(item_id);
+		num_times_any_item_has_updated++;
+	}
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: eepromItemGet
+//
+// Description: Gets any item's value without the caller needing to know its type.
+//
+//-------------------------------
+#ifdef ASL110
+
+uint16_t eepromItemGet(EepromItemId_t item_id)
+{
+	return ValueLoad(ItemAddr(item_id), items_info[(int)item_id].type);
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: eepromProfileActiveGet
+//
+// Description: Gets which profile's pad settings are in use.
+//
+//-------------------------------
+#ifdef ASL110
+
+uint8_t eepromProfileActiveGet(void)
+{
+	return settings.data.items.active_profile;
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: eepromProfileSelect
+//
+// Description: Switches to another profile's pad settings. They're all held in RAM, so this
+//		just points the PROFILE items at the other one. Saving the switch takes one record.
+//
+// return: False if there's no such profile.
+//
+//-------------------------------
+#ifdef ASL110
+
+bool eepromProfileSelect(uint8_t profile)
+{
+	if (profile >= EEPROM_NUM_PROFILES)
+	{
+		return false;
+	}
+
+	// Changes to PROFILE items already made are marked against the old profile, so they're
+	// still saved to it.
+	eeprom8bitSet(EEPROM_STORED_ITEM_ACTIVE_PROFILE, profile);
+	ProfileActivate();
+
+	return true;
 }
 #endif // #ifdef ASL110
 
@@ -643,7 +874,8 @@ uint16_t eeprom16bitGet(EepromItemId_t item_id)
 //-------------------------------
 // Function: SyncWithEeprom
 //
-// Description: Synchronizes data in RAM with data in EEPROM.
+// Description: Synchronizes data in RAM with the fixed memory map that firmware before the
+// 	settings log used.
 //
 // return: True if EEPROM has been written to before, false if it has not.  When true, all values in RAM
 // 	are synced with the corresponding item value in EEPROM.
@@ -654,244 +886,657 @@ uint16_t eeprom16bitGet(EepromItemId_t item_id)
 
 static bool SyncWithEeprom(void)
 {
-	uint8_t is_programmed_val = Read8bitVal(items_info[EEPROM_STORED_ITEM_EEPROM_INITIALIZED].start_addr);
+	// The fixed map is laid out the same as settings.data, so it comes in with one read.
+	(void)eepromBspReadSection(EEPROM_FIXED_MAP_ADDR, sizeof(EepromData_t), log_page_buff.snapshot.data.bytes, 0);
 	
-	if (is_programmed_val == EEPROM_INITIALIZED_VAL)
+	if (log_page_buff.snapshot.data.items.eeprom_intiailized == EEPROM_INITIALIZED_VAL)
 	{
-		eeprom_data.bytes[EEPROM_STORED_ITEM_EEPROM_INITIALIZED] = is_programmed_val;
-		
-		for (int item = (int)EEPROM_STORED_ITEM_EEPROM_INITIALIZED + 1; item < (int)EEPROM_STORED_ITEM_EOL; item++)
+		for (uint8_t i = 0; i < sizeof(EepromData_t); i++)
 		{
-			ItemInfo_t *item_info = &items_info[item];
-			item_info->need_to_save = false;
+			settings.data.bytes[i] = log_page_buff.snapshot.data.bytes[i];
+		}
+
+		ItemsDirtyClear();
 
-			switch (item_info->type)
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: LogLoad
+//
+// Description: Loads the RAM copy from the newest settings log page that passes its CRC.
+//
+// log_found: Set true if either page was marked valid, whether or not it passed.
+//
+// return: True if a page was loaded. Nothing in RAM is touched if not.
+//
+//-------------------------------
+#ifdef ASL110
+
+static bool LogLoad(bool *log_found)
+{
+	EepromLogHeader_t header_a;
+	EepromLogHeader_t header_b;
+	EepromLogRecord_t record;
+	bool a_valid = LogReadHeader(EEPROM_LOG_PAGE_A_ADDR, &header_a);
+	bool b_valid = LogReadHeader(EEPROM_LOG_PAGE_B_ADDR, &header_b);
+	volatile uint8_t *addr;
+	ItemType_t type;
+	uint8_t num_committed;
+	uint16_t newer_addr;
+	uint16_t older_addr;
+
+	// Start off on a full page B, so the first flush writes page A.
+	log_page_addr = EEPROM_LOG_PAGE_B_ADDR;
+	log_generation = 0;
+	log_num_records = 0;
+	log_records_offset = EEPROM_LOG_RECORDS_OFFSET;
+	log_max_records = 0;
+
+	*log_found = a_valid || b_valid;
+
+	// Generations wrap, so compare the difference.
+	if (a_valid && (!b_valid || ((int8_t)(header_a.generation - header_b.generation) > 0)))
+	{
+		newer_addr = EEPROM_LOG_PAGE_A_ADDR;
+		older_addr = b_valid ? EEPROM_LOG_PAGE_B_ADDR : 0;
+	}
+	else if (b_valid)
+	{
+		newer_addr = EEPROM_LOG_PAGE_B_ADDR;
+		older_addr = a_valid ? EEPROM_LOG_PAGE_A_ADDR : 0;
+	}
+	else
+	{
+		return false;
+	}
+
+	if (LogLoadPage(newer_addr))
+	{
+		log_page_addr = newer_addr;
+	}
+	else if ((older_addr != 0) && LogLoadPage(older_addr))
+	{
+		log_page_addr = older_addr;
+	}
+	else
+	{
+		return false;
+	}
+	log_generation = log_page_buff.header.generation;
+	log_records_offset = EEPROM_LOG_SNAPSHOT_OFFSET + log_page_buff.header.snapshot_len;
+	log_max_records = EEPROM_LOG_NUM_RECORDS(log_records_offset);
+
+	// The snapshot passed, so it's safe to take. Items a shorter snapshot doesn't have keep their
+	// default values.
+	for (uint8_t i = 0; i < log_page_buff.header.snapshot_len; i++)
+	{
+		((volatile uint8_t *)&settings)[i] = ((uint8_t *)&log_page_buff.snapshot)[i];
+	}
+
+	// Find the end of the log, and the last commit.
+	num_committed = 0;
+	for (log_num_records = 0; log_num_records < log_max_records; log_num_records++)
+	{
+		LogReadRecord(log_num_records, &record);
+
+		if ((record.seq != EEPROM_LOG_RECORD_SEQ(log_generation, log_num_records)) ||
+			(SlotAddr(EEPROM_LOG_RECORD_SLOT(record), &type) == NULL))
+		{
+			break;
+		}
+
+		if (record.slot & EEPROM_LOG_RECORD_COMMIT)
+		{
+			num_committed = log_num_records + 1;
+		}
+	}
+
+	for (uint8_t i = 0; i < num_committed; i++)
+	{
+		LogReadRecord(i, &record);
+		addr = SlotAddr(EEPROM_LOG_RECORD_SLOT(record), &type);
+		ValueStore(addr, type, ((uint16_t)record.val_hi << 8) | record.val_lo);
+	}
+
+	// Records past the last commit still look valid. New ones after them would be taken as part
+	// of the same group, so start a fresh page on the next flush instead.
+	if (num_committed != log_num_records)
+	{
+		compact_pending = true;
+	}
+
+	ItemsDirtyClear();
+
+	return true;
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: LogLoadPage
+//
+// Description: Reads a page's header and snapshot into log_page_buff in one pass and checks
+// 	the snapshot against its CRC.
+//
+// return: True if the snapshot is good.
+//
+//-------------------------------
+#ifdef ASL110
+
+static bool LogLoadPage(uint16_t page_addr)
+{
+	uint8_t len;
+
+	(void)eepromBspReadSection(page_addr, sizeof(EepromLogHeader_t), (uint8_t *)&log_page_buff.header, 0);
+
+	// A longer snapshot came from newer firmware. It can't be checked without all of it.
+	len = log_page_buff.header.snapshot_len;
+	if (len > sizeof(EepromSettings_t))
+	{
+		return false;
+	}
+
+	(void)eepromBspReadSection(page_addr, sizeof(EepromLogHeader_t) + len, (uint8_t *)&log_page_buff, 0);
+
+	return (crcBspCalc16((uint8_t *)&log_page_buff.snapshot, len) == log_page_buff.header.snapshot_crc);
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: LogReadHeader
+//
+// Description: Reads a settings log page header.
+//
+// return: True if the page is complete.
+//
+//-------------------------------
+#ifdef ASL110
+
+static bool LogReadHeader(uint16_t page_addr, EepromLogHeader_t *header)
+{
+	(void)eepromBspReadSection(page_addr, sizeof(EepromLogHeader_t), (uint8_t *)header, 0);
+
+	return (header->valid == EEPROM_LOG_PAGE_VALID);
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: LogReadRecord
+//
+// Description: Reads a record from the current settings log page.
+//
+//-------------------------------
+#ifdef ASL110
+
+static void LogReadRecord(uint8_t index, EepromLogRecord_t *record)
+{
+	(void)eepromBspReadSection(log_page_addr + log_records_offset + (uint16_t)index * sizeof(EepromLogRecord_t),
+		sizeof(EepromLogRecord_t), (uint8_t *)record, 0);
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: LogAppend
+//
+// Description: Appends a record to the settings log for every item that needs saving. The
+// 	records are contiguous, so they're queued as one write, and the last one is flagged as
+// 	the commit. Falls back to a compaction when the page doesn't have room for them.
+//
+// return: False if the write couldn't be queued. The items stay marked as needing saving.
+//
+//-------------------------------
+#ifdef ASL110
+
+static bool LogAppend(void)
+{
+	static EepromLogRecord_t records[EEPROM_LOG_MAX_APPEND];
+	uint8_t num_records = 0;
+	volatile uint8_t *addr;
+	uint8_t slot;
+	ItemType_t type;
+	uint16_t val;
+
+	for (uint8_t i = 0; i < SLOTS_DIRTY_NUM_BYTES; i++)
+	{
+		// Most items don't change, so skip 8 at a time.
+		if (slots_dirty[i] == 0)
+		{
+			continue;
+		}
+
+		for (uint8_t bit = 0; bit < 8; bit++)
+		{
+			if ((slots_dirty[i] & (uint8_t)(1 << bit)) == 0)
+			{
+				continue;
+			}
+
+			if ((num_records >= EEPROM_LOG_MAX_APPEND) || ((log_num_records + num_records) >= log_max_records))
 			{
-				case ITEM_TYPE_BOOL:
-				case ITEM_TYPE_ENUM:
-				case ITEM_TYPE_UINT8:
-					eeprom_data.bytes[item_info->start_addr] = Read8bitVal(item_info->start_addr);
-					break;
-				
-				case ITEM_TYPE_UINT16:
-					*((uint16_t *)&eeprom_data.bytes[item_info->start_addr]) = Read16bitVal(item_info->start_addr);
-					break;
-					
-				case ITEM_TYPE_EOL:
-				default:
-					ASSERT(item_info->type == ITEM_TYPE_UINT16);
-					break;
+				return LogCompact();
 			}
+
+			// SlotAddr() sets type, so it has to be called before type is passed.
+			slot = (uint8_t)(i * 8 + bit);
+			addr = SlotAddr(slot, &type);
+			val = ValueLoad(addr, type);
+			records[num_records].slot = slot;
+			records[num_records].val_lo = (uint8_t)val;
+			records[num_records].val_hi = (uint8_t)(val >> 8);
+			records[num_records].seq = EEPROM_LOG_RECORD_SEQ(log_generation, log_num_records + num_records);
+			num_records++;
 		}
+	}
 
+	if (num_records == 0)
+	{
+		ItemsDirtyClear();
 		return true;
 	}
-	else
+	records[num_records - 1].slot |= EEPROM_LOG_RECORD_COMMIT;
+
+	if (!eepromBspWriteBuffer(log_page_addr + log_records_offset + (uint16_t)log_num_records * sizeof(EepromLogRecord_t),
+			num_records * sizeof(EepromLogRecord_t), (uint8_t *)records, 0))
 	{
 		return false;
 	}
+
+	log_num_records += num_records;
+
+	ItemsDirtyClear();
+
+	return true;
 }
 #endif // #ifdef ASL110
 
 //-------------------------------
-// Function: SetDefaultValues
+// Function: LogCompact
 //
-// Description: Sets all data stored in RAM to default values.
+// Description: Writes the whole RAM copy to the other settings log page and switches to it.
 //
-// NOTE: When adding/removing an item, be sure to update this function as well!
+// 	The other page is marked invalid first and only marked valid again once its snapshot and
+// 	header are in, so a power loss part way through leaves the current page in charge.
+//
+// return: False if the writes couldn't be queued. The next flush tries again.
 //
 //-------------------------------
 #ifdef ASL110
 
-void SetDefaultValues(void)
+static bool LogCompact(void)
 {
-	eeprom_data.items.eeprom_intiailized = EEPROM_INITIALIZED_VAL;
-	
-	eeprom_data.items.left_pad_input_type = (EepromStoredEnumType_t)HEAD_ARR_INPUT_PROPORTIONAL;
-	eeprom_data.items.right_pad_input_type = (EepromStoredEnumType_t)HEAD_ARR_INPUT_PROPORTIONAL;
-	eeprom_data.items.center_pad_input_type = (EepromStoredEnumType_t)HEAD_ARR_INPUT_PROPORTIONAL;
+	EepromLogHeader_t header;
+	uint16_t new_page_addr = (log_page_addr == EEPROM_LOG_PAGE_A_ADDR) ? EEPROM_LOG_PAGE_B_ADDR : EEPROM_LOG_PAGE_A_ADDR;
+	uint8_t new_page = (new_page_addr == EEPROM_LOG_PAGE_A_ADDR) ? 0 : 1;
 
-	eeprom_data.items.left_pad_output_map = (EepromStoredEnumType_t)HEAD_ARRAY_OUT_FUNC_LEFT;
-	eeprom_data.items.right_pad_output_map = (EepromStoredEnumType_t)HEAD_ARRAY_OUT_FUNC_RIGHT;
-	eeprom_data.items.center_pad_output_map = (EepromStoredEnumType_t)HEAD_ARRAY_OUT_FUNC_FWD;
+	header.valid = EEPROM_LOG_PAGE_VALID;
+	header.generation = log_generation + 1;
+	header.snapshot_len = sizeof(EepromSettings_t);
+	header.snapshot_crc = crcBspCalc16((uint8_t *)&settings, sizeof(EepromSettings_t));
 
-	eeprom_data.items.user_btn_long_press_act_time = 1000;
-	
-	// Enable all features.
-	eeprom_data.items.enabled_features = //FUNC_FEATURE_POWER_ON_OFF_BIT_MASK; | 
-                                        //FUNC_FEATURE_OUT_CTRL_TO_BT_MODULE_BIT_MASK;
-                                        //FUNC_FEATURE_NEXT_FUNCTION_BIT_MASK | 
-                                        //FUNC_FEATURE_NEXT_PROFILE_BIT_MASK |
-                                        //FUNC_FEATURE_SOUND_ENABLED_BIT_MASK;
-            0;
-            
-	eeprom_data.items.current_active_feature = (EepromStoredEnumType_t)FUNC_FEATURE_POWER_ON_OFF;
-
-	eeprom_data.items.left_pad_min_adc_val = ADC_LEFT_PAD_MIN_VAL;
-	eeprom_data.items.left_pad_max_adc_val = ADC_LEFT_PAD_MAX_VAL;
-	eeprom_data.items.left_pad_min_thresh_perc = 2;
-	eeprom_data.items.left_pad_max_thresh_perc = 30;
-
-	eeprom_data.items.right_pad_min_adc_val = ADC_RIGHT_PAD_MIN_VAL;
-	eeprom_data.items.right_pad_max_adc_val = ADC_RIGHT_PAD_MAX_VAL;
-	eeprom_data.items.right_pad_min_thresh_perc = 2;
-	eeprom_data.items.right_pad_max_thresh_perc = 30;
-
-	eeprom_data.items.ctr_pad_min_adc_val = ADC_CTR_PAD_MIN_VAL;
-	eeprom_data.items.ctr_pad_max_adc_val = ADC_CTR_PAD_MAX_VAL;
-	eeprom_data.items.ctr_pad_min_thresh_perc = 2;
-	eeprom_data.items.ctr_pad_max_thresh_perc = 30;
+	// Once the invalid mark is queued the rest has to follow, so make sure it all fits first.
+	if (!eepromBspWriteRoom(5, 1 + sizeof(EepromSettings_t) + sizeof(EepromLogHeader_t) + sizeof(log_page_writes[0])))
+	{
+		compact_pending = true;
+		return false;
+	}
 
-#ifdef USE_12VOLT_REGULATOR
-    eeprom_data.items.neutral_DAC_counts = 2048+212;        // Mid-point of 12-bit DAC
-    eeprom_data.items.neutral_DAC_setting = 2040+212;       // Mid-point of 12-bit DAC
-#else
-    eeprom_data.items.neutral_DAC_counts = 2048;        // Mid-point of 12-bit DAC
-    eeprom_data.items.neutral_DAC_setting = 2032;       // Mid-point of 12-bit DAC
-#endif
-    eeprom_data.items.neutral_DAC_range = 410;          // Allowable range for 1.2 V swing.
-    
-    // Added in Version 3
-    eeprom_data.items.EEPROM_Version = EEPROM_DATA_STRUCTURE_VERSION;
-    
-    // Added in Version 4
-    // Obsoleted/replaced in Version 5
-    //eeprom_data.items.Drive_Offset = 20;                // Default drive offset is 20%
-
-    // Changed and/or added in Version 5
-    eeprom_data.items.CenterPad_MinimumDriveSpeed = 20;     // Center Pad minimum speed
-    eeprom_data.items.LeftPad_MinimumDriveSpeed = 20;       // Left Pad minimum speed
-    eeprom_data.items.RightPad_MinimumDriveSpeed = 20;      // Right Pad minimum speed
-    
-    // Added in Version 6
-    eeprom_data.items.enabled_features2 = 0;                // Feature set 2 is all disabled.
+	(void)eepromBspWriteBuffer(new_page_addr, 1, &log_page_invalid, 0);
+	(void)eepromBspWriteBuffer(new_page_addr + EEPROM_LOG_SNAPSHOT_OFFSET, sizeof(EepromSettings_t), (uint8_t *)&settings, 0);
+	(void)eepromBspWriteBuffer(new_page_addr + 1, sizeof(EepromLogHeader_t) - 1, &((uint8_t *)&header)[1], 0);
+	(void)eepromBspWriteBuffer(new_page_addr, 1, &header.valid, 0);
+
+	log_page_writes[new_page]++;
+	(void)eepromBspWriteBuffer(EEPROM_WEAR_ADDR + (uint16_t)new_page * sizeof(log_page_writes[0]), sizeof(log_page_writes[0]),
+		(uint8_t *)&log_page_writes[new_page], 0);
+
+	compact_pending = false;
+	log_page_addr = new_page_addr;
+	log_generation = header.generation;
+	log_num_records = 0;
+	log_records_offset = EEPROM_LOG_RECORDS_OFFSET;
+	log_max_records = EEPROM_LOG_NUM_RECORDS(EEPROM_LOG_RECORDS_OFFSET);
+
+	ItemsDirtyClear();
+
+	return true;
 }
 #endif // #ifdef ASL110
 
 //-------------------------------
-// Function: Write8bitVal
+// Function: ItemAddr
 //
-// Description: Writes a 8-bit value to EEPROM
-//
-// 		Function calls are computationally expensive, inlining this function in favor of increased speed.
+// Description: Gets where an item's value is kept in RAM. For a PROFILE item that's in the
+// 	active profile.
 //
 //-------------------------------
 #ifdef ASL110
 
-inline static void Write8bitVal(uint8_t address, uint8_t new_val)
+static volatile uint8_t *ItemAddr(EepromItemId_t item_id)
 {
-	bool op_success = eepromBspWriteByte(address, new_val, 0);
-	ASSERT(op_success);
+	const ItemInfo_t *item_info = &items_info[(int)item_id];
+
+	if (items_flat || (item_info->profile_item == NOT_A_PROFILE_ITEM))
+	{
+		return &settings.data.bytes[item_info->start_addr];
+	}
+
+	return &active_profile->bytes[item_info->profile_addr];
 }
 #endif // #ifdef ASL110
 
 //-------------------------------
-// Function: Read8bitVal
+// Function: SlotAddr
 //
-// Description: Reads a 8-bit value from EEPROM
+// Description: Gets where a settings log slot's value is kept in RAM, and its type.
 //
-// 		Function calls are computationally expensive, inlining this function in favor of increased speed.
+// return: NULL if there's no such slot.
 //
 //-------------------------------
 #ifdef ASL110
-inline static uint8_t Read8bitVal(uint8_t address)
+
+static volatile uint8_t *SlotAddr(uint8_t slot, ItemType_t *type)
 {
-	uint8_t read_val;
-	bool op_success = eepromBspReadSection(address, 1, &read_val, 0);
-	ASSERT(op_success);
+	const ItemInfo_t *item_info;
+	uint8_t profile;
+	uint8_t profile_item;
 
-	if (!op_success)
+	if (slot < (uint8_t)EEPROM_STORED_ITEM_EOL)
 	{
-		// Just set to a known value so there is little chance of total crash...though this case can currently not occur
-		read_val = 0;
+		*type = items_info[slot].type;
+		return &settings.data.bytes[items_info[slot].start_addr];
 	}
 
-	return read_val;
+	if ((slot < EEPROM_LOG_PROFILE_SLOTS_BASE) || (slot >= EEPROM_LOG_NUM_SLOTS))
+	{
+		return NULL;
+	}
+
+	profile = (slot - EEPROM_LOG_PROFILE_SLOTS_BASE) / EEPROM_LOG_PROFILE_SLOTS_PER_PROFILE;
+	profile_item = (slot - EEPROM_LOG_PROFILE_SLOTS_BASE) % EEPROM_LOG_PROFILE_SLOTS_PER_PROFILE;
+	if (profile_item >= (uint8_t)PROFILE_ITEM_EOL)
+	{
+		return NULL;
+	}
+
+	item_info = &items_info[(int)profile_item_ids[profile_item]];
+	*type = item_info->type;
+	return &settings.profiles[profile].bytes[item_info->profile_addr];
 }
 #endif // #ifdef ASL110
 
 //-------------------------------
-// Function: Write16bitVal
+// Function: ValueLoad
 //
-// Description: Writes a 16-bit value to EEPROM
+// Description: Gets a value from RAM, whatever its type.
 //
-// 		Function calls are computationally expensive, inlining this function in favor of increased speed.
+//-------------------------------
+#ifdef ASL110
+
+static uint16_t ValueLoad(volatile uint8_t *addr, ItemType_t type)
+{
+	if (type == ITEM_TYPE_UINT16)
+	{
+		return *((volatile uint16_t *)addr);
+	}
+
+	return (uint16_t)*addr;
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: ValueStore
+//
+// Description: Puts a value in RAM, whatever its type.
 //
 //-------------------------------
 #ifdef ASL110
-inline static void Write16bitVal(uint8_t address, uint16_t new_val)
+
+static void ValueStore(volatile uint8_t *addr, ItemType_t type, uint16_t val)
 {
-	TypeAccess16Bit_t write_val;
-	write_val.val = new_val;
-	bool op_success = eepromBspWriteBuffer(address, 2, write_val.bytes, 0);
-	ASSERT(op_success);
+	if (type == ITEM_TYPE_UINT16)
+	{
+		*((volatile uint16_t *)addr) = val;
+	}
+	else
+	{
+		*addr = (uint8_t)val;
+	}
 }
 #endif // #ifdef ASL110
 
 //-------------------------------
-// Function: Read16bitVal
+// Function: ProfileActivate
+//
+// Description: Points the PROFILE items at the profile ACTIVE_PROFILE says. One that's out of
+// 	range, e.g. from a bad record, falls back to the first.
 //
-// Description: Reads a 16-bit value from EEPROM
+//-------------------------------
+#ifdef ASL110
+
+static void ProfileActivate(void)
+{
+	if (settings.data.items.active_profile >= EEPROM_NUM_PROFILES)
+	{
+		settings.data.items.active_profile = 0;
+	}
+
+	active_profile = &settings.profiles[settings.data.items.active_profile];
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: ItemDefaultGet
+//
+// Description: Gets an item's default value, as given in EEPROM_ITEM_LIST.
+//
+//-------------------------------
+#ifdef ASL110
+
+static uint16_t ItemDefaultGet(EepromItemId_t item_id)
+{
+	switch (item_id)
+	{
+#define EEPROM_ITEM_DEFAULT_CASE(id, type, field, default_val, scope)	case EEPROM_STORED_ITEM_##id: return (uint16_t)(ITEM_C_TYPE_##type)(default_val);
+		EEPROM_ITEM_LIST(EEPROM_ITEM_DEFAULT_CASE)
+#undef EEPROM_ITEM_DEFAULT_CASE
+
+		default:
+			return 0;
+	}
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: MigrateFrom
+//
+// Description: Brings the items in RAM up to date from what an older EEPROM version stored, by
+// 	running every step in migrate_steps from that version on. Changed items are marked as
+// 	needing saving, so the next flush only writes those.
+//
+// 	A version newer than this firmware's, or one with no steps, leaves the items alone.
+//
+//-------------------------------
+#ifdef ASL110
+
+static void MigrateFrom(uint8_t version)
+{
+	const MigrateStep_t *step;
+	uint16_t val;
+
+	// Steps from before there were profiles work on the one value the PROFILE items had.
+	items_flat = (version < EEPROM_VERSION_PROFILES);
+
+	for (uint8_t i = 0; i < (sizeof(migrate_steps) / sizeof(migrate_steps[0])); i++)
+	{
+		step = &migrate_steps[i];
+
+		if ((step->from_version < version) || (step->from_version >= EEPROM_DATA_STRUCTURE_VERSION))
+		{
+			continue;
+		}
+
+		switch (step->op)
+		{
+			case MIGRATE_ADD:
+				val = ItemDefaultGet(step->item_id);
+				break;
+
+			case MIGRATE_COPY:
+				val = eepromItemGet(step->src_item_id);
+				break;
+
+			case MIGRATE_TRANSFORM:
+				val = step->transform(eepromItemGet(step->item_id));
+				break;
+
+			case MIGRATE_SPLIT_PROFILES:
+				MigrateSplitProfiles();
+				continue;
+
+			default:
+				ASSERT(false);
+				continue;
+		}
+
+		eepromItemSet(step->item_id, val);
+	}
+
+	items_flat = false;
+	ProfileActivate();
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: MigrateSplitProfiles
 //
-// 		Function calls are computationally expensive, inlining this function in favor of increased speed.
+// Description: Gives every profile the one value each PROFILE item had before there were
+// 	profiles.
 //
 //-------------------------------
 #ifdef ASL110
-inline static uint16_t Read16bitVal(uint8_t address)
+
+static void MigrateSplitProfiles(void)
 {
-	TypeAccess16Bit_t read_val;
-	bool op_success = eepromBspReadSection(address, 2, read_val.bytes, 0);
-	ASSERT(op_success);
+	const ItemInfo_t *item_info;
+	uint16_t val;
 
-	if (!op_success)
+	for (uint8_t i = 0; i < (uint8_t)PROFILE_ITEM_EOL; i++)
 	{
-		ASSERT(op_success);
-		read_val.val = 0; // Just set to a known value so there is little chance of total crash...
+		item_info = &items_info[(int)profile_item_ids[i]];
+		val = ValueLoad(&settings.data.bytes[item_info->start_addr], item_info->type);
+
+		for (uint8_t profile = 0; profile < EEPROM_NUM_PROFILES; profile++)
+		{
+			ValueStore(&settings.profiles[profile].bytes[item_info->profile_addr], item_info->type, val);
+			SlotDirtySet(EEPROM_LOG_PROFILE_SLOT(profile, i));
+		}
 	}
 
-	return read_val.val;
+	items_flat = false;
 }
 #endif // #ifdef ASL110
 
 //-------------------------------
-// Function: Write32bitVal
+// Function: ItemDirtySet
 //
-// Description: Writes a 32-bit value to EEPROM
+// Description: Marks an item as updated in RAM but not yet in EEPROM. For a PROFILE item it's
+// 	the active profile's.
 //
-// 		Function calls are computationally expensive, inlining this function in favor of increased speed.
+//-------------------------------
+#ifdef ASL110
+
+static void ItemDirtySet(EepromItemId_t item_id)
+{
+	const ItemInfo_t *item_info = &items_info[(int)item_id];
+
+	if (items_flat || (item_info->profile_item == NOT_A_PROFILE_ITEM))
+	{
+		SlotDirtySet((uint8_t)item_id);
+	}
+	else
+	{
+		SlotDirtySet(EEPROM_LOG_PROFILE_SLOT(settings.data.items.active_profile, item_info->profile_item));
+	}
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: SlotDirtySet
+//
+// Description: Marks a settings log slot as updated in RAM but not yet in EEPROM.
 //
 //-------------------------------
 #ifdef ASL110
-inline static void Write32bitVal(uint8_t address, uint32_t new_val)
+
+static void SlotDirtySet(uint8_t slot)
 {
-	TypeAccess32Bit_t write_val;
-	write_val.val = new_val;
-	bool op_success = eepromBspWriteBuffer(address, 4, write_val.bytes, 0);
-	ASSERT(op_success);
+	slots_dirty[slot / 8] |= (uint8_t)(1 << (slot % 8));
+	at_least_one_item_requires_saving = true;
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: ItemsDirtyClear
+//
+// Description: Marks every item as saved.
+//
+//-------------------------------
+#ifdef ASL110
+
+static void ItemsDirtyClear(void)
+{
+	for (uint8_t i = 0; i < SLOTS_DIRTY_NUM_BYTES; i++)
+	{
+		slots_dirty[i] = 0;
+	}
+	at_least_one_item_requires_saving = false;
 }
 #endif // #ifdef ASL110
 
 //-------------------------------
-// Function: Read32bitVal
+// Function: FlushDoneIsr
 //
-// Description: Reads a 32-bit value from EEPROM
+// Description: Called by the EEPROM BSP from interrupt context when the write queue empties.
 //
-// 		Function calls are computationally expensive, inlining this function in favor of increased speed.
+//-------------------------------
+#ifdef ASL110
+
+static void FlushDoneIsr(void)
+{
+	event_ISR_signal(flush_done_event);
+}
+#endif // #ifdef ASL110
+
+//-------------------------------
+// Function: SetDefaultValues
+//
+// Description: Sets all data stored in RAM to default values, as given in EEPROM_ITEM_LIST.
 //
 //-------------------------------
 #ifdef ASL110
-inline static uint32_t Read32bitVal(uint8_t address)
+
+void SetDefaultValues(void)
 {
-	TypeAccess32Bit_t read_val;
-	bool op_success = eepromBspReadSection(address, 4, read_val.bytes, 0);
-	ASSERT(op_success);
+#define EEPROM_ITEM_DEFAULT(id, type, field, default_val, scope)	DEFAULT_SET_##scope(type, field, default_val)
+	EEPROM_ITEM_LIST(EEPROM_ITEM_DEFAULT)
+#undef EEPROM_ITEM_DEFAULT
 
-	if (!op_success)
+	// Every profile starts off the same.
+	for (uint8_t profile = 1; profile < EEPROM_NUM_PROFILES; profile++)
 	{
-		read_val.val = 0; // Just set to a known value so there is little chance of total crash...
+		for (uint8_t i = 0; i < sizeof(EepromProfile_t); i++)
+		{
+			settings.profiles[profile].bytes[i] = settings.profiles[0].bytes[i];
+		}
 	}
 
-	return read_val.val;
+	ProfileActivate();
 }
 #endif // #ifdef ASL110
 
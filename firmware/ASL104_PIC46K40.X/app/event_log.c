@@ -0,0 +1,328 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: event_log.c
+//
+// Description: Keeps a record of faults and other notable events in EEPROM, so there's
+//		something to look at when a unit misbehaves in the field.
+//
+//	The log is a ring of fixed size entries {sequence, code, data, uptime, ~sequence}. The
+//	oldest entry is written over once it's full. Each entry's sequence is one on from the entry
+//	before it, so at power up the newest entry is the one the run of sequences stops after.
+//	An entry is only good if its two copies of the sequence agree. One cut short by a power
+//	loss doesn't, and the next entry goes in its place.
+//
+//	eventLogAdd() only puts the event in a RAM staging buffer. It never waits on the EEPROM, so
+//	it's fine to call from time critical code and from interrupts. eventLogFlush() writes
+//	everything staged at once.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+/* **************************   Header Files   *************************** */
+
+// NOTE: This must ALWAYS be the first include in a file.
+#include "device.h"
+
+// from stdlib
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_assert.h"
+
+// from project
+#include "eeprom_bsp.h"
+#include "stopwatch.h"
+
+// from local
+#include "event_log.h"
+
+/* ******************************   Macros   ****************************** */
+
+#define EVENT_LOG_NUM_ENTRIES		((uint8_t)((EVENT_LOG_EEPROM_END - EVENT_LOG_EEPROM_ADDR) / sizeof(EventLogStoredEntry_t)))
+#define EVENT_LOG_ENTRY_ADDR(slot)	(EVENT_LOG_EEPROM_ADDR + (uint16_t)(slot) * sizeof(EventLogStoredEntry_t))
+
+// Erased EEPROM reads back as 0xFF, so that sequence is never used.
+#define EVENT_LOG_SEQ_ERASED		((uint8_t)0xFF)
+#define EVENT_LOG_SEQ_NEXT(seq)		((uint8_t)(((seq) + 1 == EVENT_LOG_SEQ_ERASED) ? 0 : ((seq) + 1)))
+
+// Events that can be waiting for eventLogFlush(). More than this in between and the rest are
+// counted and logged as EVENT_LOG_DROPPED.
+#define EVENT_LOG_STAGE_LEN			((uint8_t)8)
+
+/* ******************************   Types   ******************************* */
+
+typedef struct
+{
+	uint8_t seq;
+	uint8_t code;
+	uint16_t data;
+	uint32_t uptime_ms;
+	uint8_t seq_check;			// ~seq. Written last.
+} EventLogStoredEntry_t;
+
+/* ***********************   File Scope Variables   *********************** */
+
+// Added to at the head, by any context. Taken from at the tail, by eventLogFlush() only.
+static EventLogEntry_t stage[EVENT_LOG_STAGE_LEN];
+static volatile uint8_t stage_head;
+static volatile uint8_t stage_tail;
+static volatile uint16_t num_dropped;
+
+// Where the next entry goes.
+static uint8_t next_slot;
+static uint8_t next_seq;
+static uint8_t num_entries;
+
+// Set while the log is being read back, so the entries don't move under the reader.
+static bool hold;
+
+/* ***********************   Function Prototypes   ************************ */
+
+static bool EntryRead(uint8_t slot, EventLogStoredEntry_t *entry);
+
+/* *******************   Public Function Definitions   ******************** */
+
+//-------------------------------
+// Function: eventLogInit
+//
+// Description: Finds where the log left off and logs the power up. The EEPROM driver must
+//		already be initialized.
+//
+//-------------------------------
+void eventLogInit(void)
+{
+	EventLogStoredEntry_t entry;
+	bool prev_valid = false;
+	bool valid;
+	uint8_t prev_seq = 0;
+
+	stage_head = 0;
+	stage_tail = 0;
+	num_dropped = 0;
+	hold = false;
+
+	next_slot = 0;
+	next_seq = 0;
+	num_entries = 0;
+
+	// Look one past the end so the last entry is compared with the first.
+	for (uint8_t i = 0; i <= EVENT_LOG_NUM_ENTRIES; i++)
+	{
+		valid = EntryRead(i % EVENT_LOG_NUM_ENTRIES, &entry);
+
+		if ((i < EVENT_LOG_NUM_ENTRIES) && valid)
+		{
+			num_entries++;
+		}
+
+		// The newest entry is the one whose successor isn't the next in sequence.
+		if (prev_valid && (!valid || (entry.seq != EVENT_LOG_SEQ_NEXT(prev_seq))))
+		{
+			next_slot = i % EVENT_LOG_NUM_ENTRIES;
+			next_seq = EVENT_LOG_SEQ_NEXT(prev_seq);
+		}
+
+		prev_valid = valid;
+		prev_seq = entry.seq;
+	}
+
+	eventLogAdd(EVENT_LOG_POWER_UP, 0);
+}
+
+//-------------------------------
+// Function: eventLogAdd
+//
+// Description: Logs an event. It's time stamped now and goes to EEPROM at the next
+//		eventLogFlush(). Can be called from interrupts.
+//
+//-------------------------------
+void eventLogAdd(EventLogCode_t code, uint16_t data)
+{
+	uint8_t next_head;
+
+	// Critical section. An interrupt could add an event part way through.
+	uint8_t start_gie_state = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+
+	next_head = (stage_head + 1) % EVENT_LOG_STAGE_LEN;
+	if (next_head == stage_tail)
+	{
+		if (num_dropped < UINT16_MAX)
+		{
+			num_dropped++;
+		}
+	}
+	else
+	{
+		stage[stage_head].uptime_ms = stopwatchUptimeGet();
+		stage[stage_head].code = (uint8_t)code;
+		stage[stage_head].data = data;
+		stage_head = next_head;
+	}
+
+	INTCONbits.GIE = start_gie_state; // Re-Enable global interrupts if required
+}
+
+//-------------------------------
+// Function: eventLogFlush
+//
+// Description: Writes the staged events to EEPROM, in one go where they don't wrap around the
+//		end of the log. Whatever doesn't fit in the EEPROM write queue is left for next time.
+//
+//-------------------------------
+void eventLogFlush(void)
+{
+	static EventLogStoredEntry_t entries[EVENT_LOG_STAGE_LEN];
+	uint8_t num = 0;
+	uint8_t first_seq = next_seq;
+	uint16_t dropped;
+	uint8_t start_gie_state;
+
+	if (hold)
+	{
+		return;
+	}
+
+	// Note events that were lost, once there's room for the note.
+	if (num_dropped > 0)
+	{
+		start_gie_state = INTCONbits.GIE;
+		INTCONbits.GIE = 0;
+		dropped = num_dropped;
+		num_dropped = 0;
+		INTCONbits.GIE = start_gie_state;
+
+		eventLogAdd(EVENT_LOG_DROPPED, dropped);
+	}
+
+	// Stop at the end of the log, or at what the write queue can take.
+	while ((stage_tail != stage_head) && ((next_slot + num) < EVENT_LOG_NUM_ENTRIES) &&
+		   eepromBspWriteRoom(1, (uint8_t)((num + 1) * sizeof(EventLogStoredEntry_t))))
+	{
+		entries[num].seq = next_seq;
+		entries[num].code = stage[stage_tail].code;
+		entries[num].data = stage[stage_tail].data;
+		entries[num].uptime_ms = stage[stage_tail].uptime_ms;
+		entries[num].seq_check = (uint8_t)(~next_seq);
+
+		next_seq = EVENT_LOG_SEQ_NEXT(next_seq);
+		stage_tail = (stage_tail + 1) % EVENT_LOG_STAGE_LEN;
+		num++;
+	}
+
+	if (num == 0)
+	{
+		return;
+	}
+
+	if (!eepromBspWriteBuffer(EVENT_LOG_ENTRY_ADDR(next_slot), num * sizeof(EventLogStoredEntry_t), (uint8_t *)entries, 0))
+	{
+		// Lost. Count them with the dropped events rather than assert, assertion_trap() flushes
+		// the log and would end up back here. The next entries take their slots and sequences.
+		start_gie_state = INTCONbits.GIE;
+		INTCONbits.GIE = 0;
+		num_dropped = ((UINT16_MAX - num_dropped) > num) ? (num_dropped + num) : UINT16_MAX;
+		INTCONbits.GIE = start_gie_state;
+
+		next_seq = first_seq;
+		return;
+	}
+
+	next_slot = (next_slot + num) % EVENT_LOG_NUM_ENTRIES;
+	num_entries = ((num_entries + num) < EVENT_LOG_NUM_ENTRIES) ? (num_entries + num) : EVENT_LOG_NUM_ENTRIES;
+}
+
+//-------------------------------
+// Function: eventLogReadStart
+//
+// Description: Starts reading back the log. Nothing new goes to EEPROM until eventLogReadEnd(),
+//		events are staged until then.
+//
+// return: How many entries there are to read.
+//
+//-------------------------------
+uint8_t eventLogReadStart(void)
+{
+	hold = true;
+	return num_entries;
+}
+
+//-------------------------------
+// Function: eventLogReadReady
+//
+// Description: Lets the caller know if entries can be read back without waiting. A read has to
+//		wait for queued EEPROM writes to finish, so a caller in a task checks this first and comes
+//		back later rather than sit there.
+//
+//-------------------------------
+bool eventLogReadReady(void)
+{
+	return !eepromBspWriteBusy();
+}
+
+//-------------------------------
+// Function: eventLogReadEntry
+//
+// Description: Reads back one entry. Index 0 is the oldest. Waits for queued EEPROM writes
+//		unless eventLogReadReady() says there are none.
+//
+// return: false if there's no such entry, or it was damaged.
+//
+//-------------------------------
+bool eventLogReadEntry(uint8_t index, EventLogEntry_t *entry)
+{
+	EventLogStoredEntry_t stored;
+
+	if (index >= num_entries)
+	{
+		return false;
+	}
+
+	if (!EntryRead((uint8_t)((next_slot + EVENT_LOG_NUM_ENTRIES - num_entries + index) % EVENT_LOG_NUM_ENTRIES), &stored))
+	{
+		return false;
+	}
+
+	entry->uptime_ms = stored.uptime_ms;
+	entry->code = stored.code;
+	entry->data = stored.data;
+	return true;
+}
+
+//-------------------------------
+// Function: eventLogReadEnd
+//
+// Description: Finishes reading back the log.
+//
+//-------------------------------
+void eventLogReadEnd(void)
+{
+	hold = false;
+}
+
+/* ********************   Private Function Definitions   ****************** */
+
+//-------------------------------
+// Function: EntryRead
+//
+// Description: Reads the entry in a slot of the ring.
+//
+// return: true if it was written in full.
+//
+//-------------------------------
+static bool EntryRead(uint8_t slot, EventLogStoredEntry_t *entry)
+{
+	uint8_t seq_check;
+
+	(void)eepromBspReadSection(EVENT_LOG_ENTRY_ADDR(slot), sizeof(EventLogStoredEntry_t), (uint8_t *)entry, 0);
+
+	// Cut down to 8 bits before comparing, ~ works on the promoted int.
+	seq_check = (uint8_t)(~entry->seq);
+	return (entry->seq != EVENT_LOG_SEQ_ERASED) && (entry->seq_check == seq_check);
+}
+
+// end of file.
+//-------------------------------------------------------------------------
@@ -73,7 +73,9 @@
 /************************************ Symbolic Constants **********************************/
 #define MIN_TIME_FOR_SUBSTATE_ms (GENERAL_OUTPUT_CTRL_UPDATE_RATE_ms)
 
-#define STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS (3)
+/// Size of the state change request ring. MUST be a power of 2 and no more than 128.
+#define STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS (16)
+#define STATE_CHANGE_REQ_CIRC_BUF_IDX_MASK  (STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS - 1)
 
 /*
  **************************************************************************************************
@@ -97,17 +99,30 @@ typedef struct
  **************************************************************************************************
  */
 
+// NOTE: Nothing defines OK_TO_USE_CONTROL_SCHEME and main.c doesn't call GenOutCtrlApp_Init(), so the
+// NOTE: firmware doesn't build anything below. tools/gen_out_ctrl_test builds it on the host and checks
+// NOTE: the request ring and the sleep-until-next-transition timing.
 #ifdef OK_TO_USE_CONTROL_SCHEME
 
-static volatile unsigned int state_change_req_circ_buf_pos_head = 0;
-static volatile unsigned int state_change_req_circ_buf_pos_tail = 0;
-static volatile unsigned int state_change_req_circ_buf_slots_in_use = 0;
+/**
+ * State change request ring. Single producer (task level callers of GenOutCtrlApp_SetState*()) and single
+ * consumer (ControlTask). The indexes are free running bytes, so each is written by one side only with a
+ * single instruction and no critical section is needed. Slots in use is (tail - head).
+ */
+static volatile uint8_t state_change_req_circ_buf_pos_head = 0;     // Written by the consumer only.
+static volatile uint8_t state_change_req_circ_buf_pos_tail = 0;     // Written by the producer only.
 static StateCtrl_t state_change_req_circ_buf[STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS];
 
+/// Requests turned away because the ring was full. Stops at 255.
+static uint8_t state_change_req_num_dropped = 0;
+
 /// @brief Event that wakes up this module's task if it needs to to something useful.
 static volatile Evt_t os_event_wake_task_id;
 
-static GenOutCtrlStateStepDef_t control_disabled_in_state[] =
+/// Time, in ms, until the next output transition. GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL when there is none.
+static GenOutCtrlTime_t next_transition_ms = GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL;
+
+static const GenOutCtrlStateStepDef_t control_disabled_in_state[] =
 {
     GEN_OUT_CTRL_END_OF_STATE
 };
@@ -115,12 +130,12 @@ static GenOutCtrlStateStepDef_t control_disabled_in_state[] =
 static bool g_BT_State = GPIO_LOW;
 
 // LED state processing definitions
-static GenOutCtrlStateStepDef_t LED_Steady_Off_StateDefinition[] =
+static const GenOutCtrlStateStepDef_t LED_Steady_Off_StateDefinition[] =
 {
     GEN_OUT_CTRL_ALWAYS_OFF,        // Turn off LED
     GEN_OUT_CTRL_END_OF_STATE
 };
-static GenOutCtrlStateStepDef_t LED_Steady_On_StateDefinition[] =
+static const GenOutCtrlStateStepDef_t LED_Steady_On_StateDefinition[] =
 {
     GEN_OUT_CTRL_ALWAYS_ON,        // Turn on LED
     GEN_OUT_CTRL_END_OF_STATE
@@ -131,7 +146,7 @@ static GenOutCtrlStateStepDef_t LED_Steady_On_StateDefinition[] =
 // LED0 ON = Green color
 //
 // GEN_OUT_CTRL_STATE_BLUETOOTH_OUTPUT
-static GenOutCtrlStateStepDef_t led0_state_BLUETOOTH_OUTPUT[] =
+static const GenOutCtrlStateStepDef_t led0_state_BLUETOOTH_OUTPUT[] =
 {
     //{250, 750, GEN_OUT_CTRL_REPEAT_PATTERN_FOREVER_VAL}, // This blinks the LED green.
     GEN_OUT_CTRL_ALWAYS_OFF,        // Turn off Green LED
@@ -139,14 +154,14 @@ static GenOutCtrlStateStepDef_t led0_state_BLUETOOTH_OUTPUT[] =
 };
 
 // GEN_OUT_CTRL_STATE_HEAD_ARRAY_ACTIVE
-static GenOutCtrlStateStepDef_t led0_state_HEAD_ARRAY_ACTIVE[] =
+static const GenOutCtrlStateStepDef_t led0_state_HEAD_ARRAY_ACTIVE[] =
 {
     GEN_OUT_CTRL_ALWAYS_ON,         // Turn ON Green LED
     GEN_OUT_CTRL_END_OF_STATE
 };
 
 // GEN_OUT_CTRL_STATE_NO_OUTPUT
-static GenOutCtrlStateStepDef_t led0_state_NO_OUTPUT[] =
+static const GenOutCtrlStateStepDef_t led0_state_NO_OUTPUT[] =
 {
     GEN_OUT_CTRL_ALWAYS_OFF,
     GEN_OUT_CTRL_END_OF_STATE
@@ -162,7 +177,7 @@ static GenOutCtrlStateStepDef_t led0_state_NO_OUTPUT[] =
 // control_disabled_in_state
 
 // GEN_OUT_CTRL_STATE_BLUETOOTH_OUTPUT
-static GenOutCtrlStateStepDef_t led1_state_BLUETOOTH_OUTPUT[] =
+static const GenOutCtrlStateStepDef_t led1_state_BLUETOOTH_OUTPUT[] =
 {
     //{250, 750, GEN_OUT_CTRL_REPEAT_PATTERN_FOREVER_VAL}, // This blinks LED orange.
     GEN_OUT_CTRL_ALWAYS_ON,     // Turn on Orange LED
@@ -170,7 +185,7 @@ static GenOutCtrlStateStepDef_t led1_state_BLUETOOTH_OUTPUT[] =
 };
 
 // GEN_OUT_CTRL_STATE_HEAD_ARRAY_ACTIVE
-static GenOutCtrlStateStepDef_t led1_state_HEAD_ARRAY_ACTIVE[] =
+static const GenOutCtrlStateStepDef_t led1_state_HEAD_ARRAY_ACTIVE[] =
 {
     GEN_OUT_CTRL_ALWAYS_OFF,    // Turn off Orange LED
     GEN_OUT_CTRL_END_OF_STATE
@@ -184,28 +199,28 @@ static GenOutCtrlStateStepDef_t led1_state_HEAD_ARRAY_ACTIVE[] =
 
 /**************************** Internal System Action (reset line) ****************************/
 // GEN_OUT_CTRL_STATE_HEAD_ARRAY_RESETTING
-static GenOutCtrlStateStepDef_t int_sys_act_HEAD_ARRAY_RESETTING[] =
+static const GenOutCtrlStateStepDef_t int_sys_act_HEAD_ARRAY_RESETTING[] =
 {
     { 100, MIN_TIME_FOR_SUBSTATE_ms, 1 },
     GEN_OUT_CTRL_END_OF_STATE
 };
 
 // GEN_OUT_CTRL_STATE_STATE_USER_BTN_NEXT_FUNCTION
-static GenOutCtrlStateStepDef_t int_sys_act_STATE_USER_BTN_NEXT_FUNCTION[] =
+static const GenOutCtrlStateStepDef_t int_sys_act_STATE_USER_BTN_NEXT_FUNCTION[] =
 {
     { 500, MIN_TIME_FOR_SUBSTATE_ms, 1 },
     GEN_OUT_CTRL_END_OF_STATE
 };
 
 // GEN_OUT_CTRL_STATE_USER_BTN_NEXT_PROFILE
-static GenOutCtrlStateStepDef_t int_sys_act_STATE_USER_BTN_NEXT_PROFILE[] =
+static const GenOutCtrlStateStepDef_t int_sys_act_STATE_USER_BTN_NEXT_PROFILE[] =
 {
     { 1500, MIN_TIME_FOR_SUBSTATE_ms, 1 },
     GEN_OUT_CTRL_END_OF_STATE
 };
 
 // GEN_OUT_CTRL_RNET_SLEEP
-static GenOutCtrlStateStepDef_t int_sys_act_STATE_USER_RNET_SLEEP[] =
+static const GenOutCtrlStateStepDef_t int_sys_act_STATE_USER_RNET_SLEEP[] =
 {
     { 3000, MIN_TIME_FOR_SUBSTATE_ms, 1 },
     GEN_OUT_CTRL_END_OF_STATE
@@ -213,14 +228,14 @@ static GenOutCtrlStateStepDef_t int_sys_act_STATE_USER_RNET_SLEEP[] =
 
 
 // GEN_OUT_CTRL_STATE_MODE_ACTIVE
-static GenOutCtrlStateStepDef_t int_sys_act_STATE_MODE_ACTIVE[] =
+static const GenOutCtrlStateStepDef_t int_sys_act_STATE_MODE_ACTIVE[] =
 {
     GEN_OUT_CTRL_ALWAYS_ON,     // Active the Pin 5 & 6.
     GEN_OUT_CTRL_END_OF_STATE
 };
 
 // GEN_OUT_CTRL_STATE_MODE_INACTIVE
-static GenOutCtrlStateStepDef_t int_sys_act_STATE_MODE_INACTIVE[] =
+static const GenOutCtrlStateStepDef_t int_sys_act_STATE_MODE_INACTIVE[] =
 {
     GEN_OUT_CTRL_ALWAYS_OFF,     // Inactivate the Pin 5 & 6.
     GEN_OUT_CTRL_END_OF_STATE
@@ -229,14 +244,14 @@ static GenOutCtrlStateStepDef_t int_sys_act_STATE_MODE_INACTIVE[] =
 //**************************** Internal System Action (reset line) ****************************
 
 // GEN_OUT_BLUETOOTH_ON
-static GenOutCtrlStateStepDef_t bluetooth_enable_BLUETOOTH_LED_CTRL[] =
+static const GenOutCtrlStateStepDef_t bluetooth_enable_BLUETOOTH_LED_CTRL[] =
 {
     GEN_OUT_CTRL_ALWAYS_OFF,     // Turn on the LED
     GEN_OUT_CTRL_END_OF_STATE
 };
 
 // GEN_OUT_BLUETOOTH_OFF
-static GenOutCtrlStateStepDef_t bluetooth_disable_BLUETOOTH_LED_CTRL[] =
+static const GenOutCtrlStateStepDef_t bluetooth_disable_BLUETOOTH_LED_CTRL[] =
 {
     GEN_OUT_CTRL_ALWAYS_OFF,     // Turn off the LED.
     GEN_OUT_CTRL_END_OF_STATE
@@ -245,6 +260,95 @@ static GenOutCtrlStateStepDef_t bluetooth_disable_BLUETOOTH_LED_CTRL[] =
 // GEN_OUT_STATE_CTRL_TEST
 // control_disabled_in_state
 
+/************************************** State Tables *************************************/
+// Each output controller's list of states. These live in program memory and are handed to the
+// driver as is, so nothing here is copied into RAM.
+//
+// NOTE: The first entry is executed at Power Up. So it's the one to set the initial state of the item.
+// NOTE: After a new state is defined above, it must be added to the list of the output controller
+// NOTE: that uses it in order for it to be able to be used!
+
+// State definitions for LED1, Forward Pad LED
+static const GenOutCtrlStateDef_t forward_pad_led_states[] =
+{
+    { GEN_OUT_FORWARD_PAD_INACTIVE, true, 0, LED_Steady_Off_StateDefinition },
+    { GEN_OUT_FORWARD_PAD_ACTIVE, true, 0, LED_Steady_On_StateDefinition }
+};
+
+// State definitions for LED3, Left Pad LED
+static const GenOutCtrlStateDef_t left_pad_led_states[] =
+{
+    { GEN_OUT_LEFT_PAD_INACTIVE, true, 0, LED_Steady_Off_StateDefinition },
+    { GEN_OUT_LEFT_PAD_ACTIVE, true, 0, LED_Steady_On_StateDefinition }
+};
+
+// State definitions for LED4, Right Pad LED
+static const GenOutCtrlStateDef_t right_pad_led_states[] =
+{
+    { GEN_OUT_RIGHT_PAD_INACTIVE, true, 0, LED_Steady_Off_StateDefinition },
+    { GEN_OUT_RIGHT_PAD_ACTIVE, true, 0, LED_Steady_On_StateDefinition }
+};
+
+// State definitions for LED2, Reverse Pad LED
+static const GenOutCtrlStateDef_t reverse_pad_led_states[] =
+{
+    { GEN_OUT_REVERSE_PAD_INACTIVE, true, 0, LED_Steady_Off_StateDefinition },
+    { GEN_OUT_REVERSE_PAD_ACTIVE, true, 0, LED_Steady_On_StateDefinition }
+};
+
+// State definitions for LEDx, Power LED
+static const GenOutCtrlStateDef_t power_led_states[] =
+{
+    { GEN_OUT_POWER_LED_ON, true, 0, LED_Steady_On_StateDefinition },
+    { GEN_OUT_POWER_LED_OFF, true, 0, LED_Steady_Off_StateDefinition }
+};
+
+// State definitions for LED1. (Amber Color)
+//static const GenOutCtrlStateDef_t led1_states[] =
+//{
+//    { GEN_OUT_CTRL_STATE_BLUETOOTH_OUTPUT, false, 0, led1_state_BLUETOOTH_OUTPUT },
+//    { GEN_OUT_CTRL_STATE_HEAD_ARRAY_ACTIVE, false, 0, control_disabled_in_state },
+//    { GEN_OUT_CTRL_STATE_NO_OUTPUT, false, 0, control_disabled_in_state },
+//    { GEN_OUT_STATE_CTRL_TEST, false, 0, control_disabled_in_state }
+//};
+
+// State definitions for internal system action output control.
+//static const GenOutCtrlStateDef_t int_sys_act_states[] =
+//{
+//    { GEN_OUT_CTRL_STATE_HEAD_ARRAY_RESETTING, true, 0, int_sys_act_HEAD_ARRAY_RESETTING },
+//    { GEN_OUT_CTRL_STATE_STATE_USER_BTN_NEXT_FUNCTION, true, 0, int_sys_act_STATE_USER_BTN_NEXT_FUNCTION },
+//    { GEN_OUT_CTRL_STATE_USER_BTN_NEXT_PROFILE, true, 0, int_sys_act_STATE_USER_BTN_NEXT_PROFILE },
+//    { GEN_OUT_STATE_CTRL_TEST, false, 0, control_disabled_in_state },
+//    { GEN_OUT_CTRL_STATE_MODE_ACTIVE, true, 0, int_sys_act_STATE_MODE_ACTIVE },
+//    { GEN_OUT_CTRL_STATE_MODE_INACTIVE, true, 0, int_sys_act_STATE_MODE_INACTIVE },
+//    { GEN_OUT_CTRL_RNET_SLEEP, true, 0, int_sys_act_STATE_USER_RNET_SLEEP }
+//};
+
+// State definitions for Bluetooth Blue LED control.
+//static const GenOutCtrlStateDef_t bt_led_states[] =
+//{
+//    { GEN_OUT_BLUETOOTH_ENABLED, true, 0, bluetooth_enable_BLUETOOTH_LED_CTRL },
+//    { GEN_OUT_BLUETOOTH_DISABLED, true, 0, bluetooth_disable_BLUETOOTH_LED_CTRL }
+//};
+
+#define STATE_TABLE(x) { (x), (uint8_t)(sizeof(x) / sizeof((x)[0])) }
+#define NO_STATE_TABLE { (const GenOutCtrlStateDef_t *)NULL, 0 }
+
+/// State tables for all output controllers. MUST be in GenOutCtrlId_t order!
+static const GenOutCtrlStateTable_t state_tables[GEN_OUT_CTRL_ID_MAX] =
+{
+    STATE_TABLE(forward_pad_led_states),    // GEN_OUT_CTRL_ID_FORWARD_PAD_LED
+    STATE_TABLE(left_pad_led_states),       // GEN_OUT_CTRL_ID_LEFT_PAD_LED
+    STATE_TABLE(right_pad_led_states),      // GEN_OUT_CTRL_ID_RIGHT_PAD_LED
+    STATE_TABLE(reverse_pad_led_states),    // GEN_OUT_CTRL_ID_REVERSE_PAD_LED
+    STATE_TABLE(power_led_states),          // GEN_OUT_CTRL_ID_POWER_LED
+    NO_STATE_TABLE,                         // GEN_OUT_CTRL_ID_FORWARD_DEMAND
+    NO_STATE_TABLE,                         // GEN_OUT_CTRL_ID_REVERSE_DEMAND
+    NO_STATE_TABLE,                         // GEN_OUT_CTRL_ID_LEFT_DEMAND
+    NO_STATE_TABLE,                         // GEN_OUT_CTRL_ID_RIGHT_DEMAND
+    NO_STATE_TABLE                          // GEN_OUT_CTRL_ID_RESET_OUT
+};
+
 /*
  **************************************************************************************************
  *                                       FILE LOCAL FUNCTIONS DECLARATIONS
@@ -252,7 +356,9 @@ static GenOutCtrlStateStepDef_t bluetooth_disable_BLUETOOTH_LED_CTRL[] =
  */
 
 static void ControlTask(void);
-static void AddStates(void);
+static bool QueueStateChangeRequest(bool set_all, GenOutCtrlId_t item_id, GenOutState_t ctrlr_state);
+static bool MergeIntoWaitingRequest(uint8_t pos, GenOutState_t ctrlr_state);
+static bool ServiceStateChangeRequests(void);
 static void SetOutputControllersToNewState(StateCtrl_t *stateData);
 
 /*
@@ -280,8 +386,11 @@ bool GenOutCtrlApp_Init(void)
 
 #ifdef OK_TO_USE_CONTROL_SCHEME
 
-    AddStates();
-    
+    if (!GenOutCtrl_StateTablesSet(state_tables))
+    {
+        ASSERT(false);
+    }
+
 #if defined(GENERAL_OUTPUT_CTRL_USE_MUTEX)
     /// @todo actually fill these in!
     GenOutCtrl_AppRtosCb_MutexLock_Set((GenOutCtrl_AppCbFunc_t)NULL);
@@ -303,22 +412,12 @@ bool GenOutCtrlApp_Init(void)
  * @brief Makes a request to set the state of all output controllers.
  *
  * @param ctrlr_state State to set the output controller to.
+ *
+ * @return true if the request was queued, false if there was no room for it.
  */
-void GenOutCtrlApp_SetStateAll(GenOutState_t ctrlr_state)
+bool GenOutCtrlApp_SetStateAll(GenOutState_t ctrlr_state)
 {
-    if (state_change_req_circ_buf_slots_in_use < STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS)
-    {
-        state_change_req_circ_buf[state_change_req_circ_buf_pos_tail].set_all = true;
-        state_change_req_circ_buf[state_change_req_circ_buf_pos_tail].id = GEN_OUT_CTRL_ID_MAX;
-        state_change_req_circ_buf[state_change_req_circ_buf_pos_tail].state = ctrlr_state;
-
-        state_change_req_circ_buf_slots_in_use++;
-        state_change_req_circ_buf_pos_tail = (state_change_req_circ_buf_pos_tail == (STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS - 1)) ? 0 : (state_change_req_circ_buf_pos_tail + 1);
-    }
-    else
-    {
-        ASSERT(false);
-    }
+    return QueueStateChangeRequest(true, GEN_OUT_CTRL_ID_MAX, ctrlr_state);
 }
 
 /**
@@ -326,22 +425,23 @@ void GenOutCtrlApp_SetStateAll(GenOutState_t ctrlr_state)
  *
  * @param item_id ID of the output control item that is to be modified
  * @param ctrlr_state State to set the output controller to.
+ *
+ * @return true if the request was queued, false if there was no room for it.
  */
-void GenOutCtrlApp_SetState(GenOutCtrlId_t item_id, GenOutState_t ctrlr_state)
+bool GenOutCtrlApp_SetState(GenOutCtrlId_t item_id, GenOutState_t ctrlr_state)
 {
-    if (state_change_req_circ_buf_slots_in_use < STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS)
-    {
-        state_change_req_circ_buf[state_change_req_circ_buf_pos_tail].set_all = false;
-        state_change_req_circ_buf[state_change_req_circ_buf_pos_tail].id = item_id;
-        state_change_req_circ_buf[state_change_req_circ_buf_pos_tail].state = ctrlr_state;
+    return QueueStateChangeRequest(false, item_id, ctrlr_state);
+}
 
-        state_change_req_circ_buf_slots_in_use++;
-        state_change_req_circ_buf_pos_tail = (state_change_req_circ_buf_pos_tail == (STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS - 1)) ? 0 : (state_change_req_circ_buf_pos_tail + 1);
-    }
-    else
-    {
-        ASSERT(false);
-    }
+/**
+ * @brief Lets the caller know how many state change requests have been turned away because the
+ *        ring was full.
+ *
+ * @return Number of requests dropped since power up, stopping at 255.
+ */
+uint8_t GenOutCtrlApp_NumDroppedRequestsGet(void)
+{
+    return state_change_req_num_dropped;
 }
 
 /**
@@ -349,10 +449,13 @@ void GenOutCtrlApp_SetState(GenOutCtrlId_t item_id, GenOutState_t ctrlr_state)
  *        state change request. 
  * 
  * @return true: need to send event to have task carry out state change request, false: no need to send event.
+ *
+ * @note The task sleeps until the next output transition, so an event is needed whenever that is further
+ *       off than the old polling rate.
  */
 bool genOutCtrlAppNeedSendEvent(void)
 {
-    return !GenOutCtrl_AtLeastOneOutputCtrlrIsActive();
+    return (next_transition_ms > GENERAL_OUTPUT_CTRL_UPDATE_RATE_ms);
 }
 
 /**
@@ -381,42 +484,43 @@ static void ControlTask(void)
     task_open();
     
     // Service any state change requests that may be pending.
-    // We'll have control of the OS through this entire loop. Run through all requested state changes
     //
     // NOTE: We do this check here as tasks that run before this one on boot
     // NOTE: may request state changes where the event will be "sent" but thrown away by the
     // NOTE: OS kernel.
-    while (state_change_req_circ_buf_slots_in_use > 0)
-    {
-        SetOutputControllersToNewState(&state_change_req_circ_buf[state_change_req_circ_buf_pos_head]);
-
-        state_change_req_circ_buf_slots_in_use--;
-        state_change_req_circ_buf_pos_head = (state_change_req_circ_buf_pos_head == (STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS - 1)) ? 0 : (state_change_req_circ_buf_pos_head + 1);
-    }
+    (void)ServiceStateChangeRequests();
     
     StopWatch_t task_time_elapsed_sw;
     stopwatchStart(&task_time_elapsed_sw);
 
+    next_transition_ms = GenOutCtrl_NextTransitionGet_ms();
+
 //    GenOutCtrl_Stop (GEN_OUT_CTRL_ID_BT_LED);
 
 	while (1)
 	{
-        if (!GenOutCtrl_AtLeastOneOutputCtrlrIsActive())
+        if (next_transition_ms == GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL)
         {
-            // Wait forever as no output controllers are active and we want to use as
+            // Wait forever as no output controller has a transition coming up and we want to use as
             // little energy and processing power as possible at all times.
 			event_wait(os_event_wake_task_id);
             stopwatchZero(&task_time_elapsed_sw);
         }
-        
-        // Service any state change requests that may be pending.
-        // We'll have control of the OS through this entire loop. Run through all requested state changes
-        while (state_change_req_circ_buf_slots_in_use > 0)
+        else
         {
-            SetOutputControllersToNewState(&state_change_req_circ_buf[state_change_req_circ_buf_pos_head]);
+            // Sleep until the next output transition is due. A state change request wakes us up early.
+            // NOTE: A timeout of 0 means "wait forever" to the OS, so always wait at least one tick.
+            event_wait_timeout(os_event_wake_task_id, MILLISECONDS_TO_TICKS((next_transition_ms > 0) ? next_transition_ms : 1));
+        }
 
-            state_change_req_circ_buf_slots_in_use--;
-            state_change_req_circ_buf_pos_head = (state_change_req_circ_buf_pos_head == (STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS - 1)) ? 0 : (state_change_req_circ_buf_pos_head + 1);
+        // Bring the running output controllers up to date first so the time spent asleep isn't
+        // credited to any state started by the requests below.
+        next_transition_ms = GenOutCtrl_TickUpdateAll_ms(stopwatchTimeElapsed(&task_time_elapsed_sw, true));
+
+        // Service any state change requests that may be pending.
+        if (ServiceStateChangeRequests())
+        {
+            next_transition_ms = GenOutCtrl_NextTransitionGet_ms();
         }
 
         // Turn the BLUE Bluetooth LED on/off based upon the Bluetooth feature
@@ -425,92 +529,133 @@ static void ControlTask(void)
         if ((eeprom8bitGet(EEPROM_STORED_ITEM_ENABLED_FEATURES) & FUNC_FEATURE_OUT_CTRL_TO_BT_MODULE_BIT_MASK) > 0)
         {
             GenOutCtrl_Disable (GEN_OUT_CTRL_ID_BT_LED);
-            GenOutCtrlApp_SetStateAll (GEN_OUT_BLUETOOTH_ENABLED);
+            (void)GenOutCtrlApp_SetStateAll (GEN_OUT_BLUETOOTH_ENABLED);
         }
         else 
         {
             GenOutCtrl_Enable (GEN_OUT_CTRL_ID_BT_LED);
-            GenOutCtrlApp_SetStateAll (GEN_OUT_BLUETOOTH_DISABLED);
+            (void)GenOutCtrlApp_SetStateAll (GEN_OUT_BLUETOOTH_DISABLED);
         }
 #endif 
-        
-		task_wait(MILLISECONDS_TO_TICKS(GENERAL_OUTPUT_CTRL_UPDATE_RATE_ms));
-        GenOutCtrl_TickUpdateAll_ms(stopwatchTimeElapsed(&task_time_elapsed_sw, true));
     }
     task_close();
 }
 
 /**
- * Adds all the states for all the output controllers.
+ * @brief Puts a state change request in the ring for ControlTask.
+ *
+ * A request for an output that already has a request waiting replaces the waiting one's state rather
+ * than taking another slot, as long as no "set all" request was queued after it. Likewise for back to
+ * back "set all" requests. Bursts of changes to the same outputs therefore never fill the ring.
+ *
+ * @param set_all       true to set every output controller, false to set only item_id.
+ * @param item_id       ID of the output control item that is to be modified. Ignored when set_all is true.
+ * @param ctrlr_state   State to set the output controller(s) to.
+ *
+ * @return true if the request was queued or merged, false if the ring was full.
  *
- * @note    After a new state is defined at the top of this file, a new line of code must be added
- *          here in order for it to be able to be used!
+ * @note Producer side of the ring. Call from task level only, never from an ISR.
  */
-static void AddStates(void)
+static bool QueueStateChangeRequest(bool set_all, GenOutCtrlId_t item_id, GenOutState_t ctrlr_state)
 {
-    // Add state definitions for LED1, Forward Pad LED
-    if (!GenOutCtrl_AddState(GEN_OUT_CTRL_ID_FORWARD_PAD_LED, GEN_OUT_FORWARD_PAD_INACTIVE, true, 0, LED_Steady_Off_StateDefinition) ||
-        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_FORWARD_PAD_LED, GEN_OUT_FORWARD_PAD_ACTIVE, true, 0, LED_Steady_On_StateDefinition))
-    {
-        ASSERT(false);
-    }
+    uint8_t head = state_change_req_circ_buf_pos_head;
+    uint8_t tail = state_change_req_circ_buf_pos_tail;
+    uint8_t pos = tail;
 
-    // Add state definitions for LED2, Reverse Pad LED
-    if (!GenOutCtrl_AddState(GEN_OUT_CTRL_ID_REVERSE_PAD_LED, GEN_OUT_REVERSE_PAD_INACTIVE, true, 0, LED_Steady_Off_StateDefinition) ||
-        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_REVERSE_PAD_LED, GEN_OUT_REVERSE_PAD_ACTIVE, true, 0, LED_Steady_On_StateDefinition))
+    // Walk back from the newest waiting request looking for one to merge with.
+    while (pos != head)
     {
-        ASSERT(false);
+        StateCtrl_t *req = &state_change_req_circ_buf[(uint8_t)(pos - 1) & STATE_CHANGE_REQ_CIRC_BUF_IDX_MASK];
+
+        if (set_all || req->set_all)
+        {
+            // Can't merge across a "set all" request without changing the outcome.
+            if (set_all && req->set_all && (pos == tail) && MergeIntoWaitingRequest((uint8_t)(pos - 1), ctrlr_state))
+            {
+                return true;
+            }
+            break;
+        }
+
+        if (req->id == item_id)
+        {
+            if (MergeIntoWaitingRequest((uint8_t)(pos - 1), ctrlr_state))
+            {
+                return true;
+            }
+            break;
+        }
+
+        pos--;
     }
 
-//    // Add state definitions for LED3, Left Pad LED
-    if (!GenOutCtrl_AddState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, GEN_OUT_LEFT_PAD_INACTIVE, true, 0, LED_Steady_Off_StateDefinition) ||
-        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, GEN_OUT_LEFT_PAD_ACTIVE, true, 0, LED_Steady_On_StateDefinition))
+    if ((uint8_t)(tail - head) < STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS)
     {
-        ASSERT(false);
+        StateCtrl_t *req = &state_change_req_circ_buf[tail & STATE_CHANGE_REQ_CIRC_BUF_IDX_MASK];
+
+        req->set_all = set_all;
+        req->id = set_all ? GEN_OUT_CTRL_ID_MAX : item_id;
+        req->state = ctrlr_state;
+
+        // Publish the request only after it is completely written.
+        state_change_req_circ_buf_pos_tail = (uint8_t)(tail + 1);
+        return true;
     }
 
-    // Add state definitions for LED4, Right Pad LED
-    if (!GenOutCtrl_AddState(GEN_OUT_CTRL_ID_RIGHT_PAD_LED, GEN_OUT_RIGHT_PAD_INACTIVE, true, 0, LED_Steady_Off_StateDefinition) || 
-        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_RIGHT_PAD_LED, GEN_OUT_RIGHT_PAD_ACTIVE, true, 0, LED_Steady_On_StateDefinition))
+    if (state_change_req_num_dropped < UINT8_MAX)
     {
-        ASSERT(false);
+        state_change_req_num_dropped++;
     }
+    return false;
+}
+
+/**
+ * @brief Changes the state of a request that's already in the ring.
+ *
+ * The consumer only ever reads the slot at head, and only moves head forward. So if, after the new
+ * state is written, head still hasn't got as far as the slot, the consumer will see the new state.
+ * If it has, the consumer may have used the old state, and the caller queues the request again. At
+ * worst the same state is then set twice.
+ *
+ * @param pos           Ring position of the waiting request.
+ * @param ctrlr_state   State to set the output controller(s) to.
+ *
+ * @return true if the consumer is sure to see the new state.
+ */
+static bool MergeIntoWaitingRequest(uint8_t pos, GenOutState_t ctrlr_state)
+{
+    uint8_t head;
+
+    state_change_req_circ_buf[pos & STATE_CHANGE_REQ_CIRC_BUF_IDX_MASK].state = ctrlr_state;
 
-    // NOTE: The first entry is executed at Power Up. So it's the one to set the initial state of the item.
-    // Add state definitions for LEDx, Power LED
-    if (!GenOutCtrl_AddState(GEN_OUT_CTRL_ID_POWER_LED, GEN_OUT_POWER_LED_ON, true, 0, LED_Steady_On_StateDefinition) || 
-        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_POWER_LED, GEN_OUT_POWER_LED_OFF, true, 0, LED_Steady_Off_StateDefinition))
+    head = state_change_req_circ_buf_pos_head;
+    return (pos != head) && ((uint8_t)(pos - head) < (uint8_t)(state_change_req_circ_buf_pos_tail - head));
+}
+
+/**
+ * @brief Carries out all waiting state change requests.
+ *
+ * @return true if at least one request was carried out.
+ *
+ * @note Consumer side of the ring. Call from ControlTask only.
+ */
+static bool ServiceStateChangeRequests(void)
+{
+    bool serviced = false;
+
+    // We'll have control of the OS through this entire loop. Run through all requested state changes
+    while (state_change_req_circ_buf_pos_head != state_change_req_circ_buf_pos_tail)
     {
-        ASSERT(false);
+        uint8_t head = state_change_req_circ_buf_pos_head;
+
+        SetOutputControllersToNewState(&state_change_req_circ_buf[head & STATE_CHANGE_REQ_CIRC_BUF_IDX_MASK]);
+
+        // Free the slot only after it has been used.
+        state_change_req_circ_buf_pos_head = (uint8_t)(head + 1);
+        serviced = true;
     }
 
-    // Add state definitions for LED1. (Amber Color)
-//    if (!GenOutCtrl_AddState(GEN_OUT_CTRL_ID_LED1, GEN_OUT_CTRL_STATE_BLUETOOTH_OUTPUT, false, 0, led1_state_BLUETOOTH_OUTPUT) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_LED1, GEN_OUT_CTRL_STATE_HEAD_ARRAY_ACTIVE, false, 0, control_disabled_in_state) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_LED1, GEN_OUT_CTRL_STATE_NO_OUTPUT, false, 0, control_disabled_in_state) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_LED1, GEN_OUT_STATE_CTRL_TEST, false, 0, control_disabled_in_state))
-//    {
-//        ASSERT(false);
-//    }
-
-    // Add state definitions for internal system action output control.
-//    if (!GenOutCtrl_AddState(GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION, GEN_OUT_CTRL_STATE_HEAD_ARRAY_RESETTING, true, 0, int_sys_act_HEAD_ARRAY_RESETTING) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION, GEN_OUT_CTRL_STATE_STATE_USER_BTN_NEXT_FUNCTION, true, 0, int_sys_act_STATE_USER_BTN_NEXT_FUNCTION) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION, GEN_OUT_CTRL_STATE_USER_BTN_NEXT_PROFILE, true, 0, int_sys_act_STATE_USER_BTN_NEXT_PROFILE) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION, GEN_OUT_STATE_CTRL_TEST, false, 0, control_disabled_in_state) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION, GEN_OUT_CTRL_STATE_MODE_ACTIVE, true, 0, int_sys_act_STATE_MODE_ACTIVE) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION, GEN_OUT_CTRL_STATE_MODE_INACTIVE, true, 0, int_sys_act_STATE_MODE_INACTIVE) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION, GEN_OUT_CTRL_RNET_SLEEP, true, 0, int_sys_act_STATE_USER_RNET_SLEEP))
-//    {
-//        ASSERT(false);
-//    }
-
-    // Add state definitions for Bluetooth Blue LED control.
-//    if (!GenOutCtrl_AddState(GEN_OUT_CTRL_ID_BT_LED, GEN_OUT_BLUETOOTH_ENABLED, true, 0, bluetooth_enable_BLUETOOTH_LED_CTRL) ||
-//        !GenOutCtrl_AddState(GEN_OUT_CTRL_ID_BT_LED, GEN_OUT_BLUETOOTH_DISABLED, true, 0, bluetooth_disable_BLUETOOTH_LED_CTRL))
-//    {
-//        ASSERT(false);
-//    }
+    return serviced;
 }
 
 /**
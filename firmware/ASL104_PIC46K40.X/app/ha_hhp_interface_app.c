@@ -27,12 +27,13 @@
 #include "rtos_task_priorities.h"
 #include "bsp.h"
 #include "common.h"
-#include "isrs.h"
 #include "test_gpio.h"
 #include "version.h"
 #include "eeprom_app.h"
 #include "app_common.h"
 #include "config.h"
+#include "stopwatch.h"
+#include "event_log.h"
 
 // from local
 #include "ha_hhp_interface_bsp.h"
@@ -62,7 +63,14 @@ typedef enum
     HA_HHP_CMD_SAVE_PARAMETERS = 0x3E,
     HA_HHP_CMD_RESET_PARAMETERS = 0x3F,
     HA_HHP_CMD_DRIVE_OFFSET_GET = 0x40,
-    HA_HHP_CMD_DRIVE_OFFSET_SET = 0x41
+    HA_HHP_CMD_DRIVE_OFFSET_SET = 0x41,
+    HA_HHP_CMD_PAD_DATA_SUBSCRIBE = 0x42,
+    HA_HHP_CMD_PARAMETERS_GET = 0x43,
+    HA_HHP_CMD_PARAMETERS_SET = 0x44,
+    HA_HHP_CMD_EEPROM_WEAR_GET = 0x45,
+    HA_HHP_CMD_PROFILE_GET = 0x46,
+    HA_HHP_CMD_PROFILE_SELECT = 0x47,
+    HA_HHP_CMD_EVENT_LOG_READ = 0x48
 } HaHhpIfCmd_t;
 
 // Slave responses to commands from master.
@@ -87,6 +95,37 @@ typedef enum
 #define COMMS_PAD_TYPE_DIGITAL 		('D')
 #define COMMS_PAD_TYPE_PROPORTIONAL ('P')
 
+// Longest a packet may take to come in, and longest the master may hold RTS after sending one.
+#define HHP_RX_TIMEOUT_ms			(20)
+
+// Longest a response waits for the master to let go of RTS before it's thrown away. A master
+// holding on this long has given up on it.
+#define HHP_TX_HOLD_OFF_ms			(100)
+
+// The task sleeps on the link event. This is only a backstop in case an RTS edge is missed.
+#define HHP_IDLE_POLL_ms			(100)
+
+// Pad data stream. The requested period is in units of 10 ms and can't be shorter than this.
+#define HHP_STREAM_PERIOD_UNIT_ms	(10)
+#define HHP_STREAM_MIN_PERIOD_ms	(20)
+#define HHP_STREAM_FRAME_LEN		(16)		// <LEN><CMD><SEQ>, 4 bytes for each of 3 pads, <CHKSUM>
+
+// Event log read. Each entry is <UPTIME><CODE><DATA>, 4 + 1 + 2 bytes.
+#define HHP_EVENT_LOG_ENTRY_LEN		(7)
+#define HHP_EVENT_LOG_ENTRIES_PER_FRAME	((HHP_RX_TX_BUFF_LEN - 4) / HHP_EVENT_LOG_ENTRY_LEN)
+
+// Largest drive offset, as a percentage of full drive.
+#define HHP_MAX_MIN_DRIVE_SPEED		(60)
+
+// Largest pad threshold, as a percentage of the pad's calibrated range.
+#define HHP_MAX_THRESH_PERC			(100)
+
+// Long press time is sent in tenths of a second and kept in ms.
+#define HHP_LONG_PRESS_UNIT_ms		(100)
+
+// Bits of the second feature byte that mean anything.
+#define HHP_FEATURES_2_BITS			(FUNC_FEATURE2_RNET_SLEEP_BIT_MASK | FUNC_FEATURE2_MODE_REVERSE_BIT_MASK)
+
 
 //-------------------------------
 // Normally these macros would be functions, but we're flash space constrained on this device
@@ -105,9 +144,32 @@ static uint8_t hhp_tx_pkt_buff[HHP_RX_TX_BUFF_LEN];
 
 static volatile uint8_t ha_hhp_if_task_id;
 
+// Signaled from the ISR when the master asserts RTS, a packet is in, or a response is out.
+static Evt_t hhp_link_event;
+
+// Task locals don't survive a task_wait().
+static uint8_t hhp_wait_ms;
+
+// A response in hhp_tx_pkt_buff that couldn't go out yet because the master was still holding
+// RTS, and how long it has waited.
+static bool hhp_tx_pending = false;
+static uint8_t hhp_tx_wait_ms;
+
+// Pad data stream. Period of 0 means nobody is subscribed.
+static uint16_t stream_period_ms = 0;
+static TimerTick_t stream_next_ms;
+static TimerTick_t stream_wait_ms = HHP_IDLE_POLL_ms;
+static uint8_t stream_seq;
+
+// Event log read. Entries still to be pushed, from event_log_read_next on.
+static bool event_log_read_active = false;
+static uint8_t event_log_read_num;
+static uint8_t event_log_read_next;
+
 /* ***********************   Function Prototypes   ************************ */
 
 static void HaHhpInterfaceHandlingTask(void);
+static void LinkEventIsr(void);
 static void ProcessRxdPacket(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
 static void BuildAckPacket(uint8_t *pkt_to_tx);
 static void BuildNackPacket(uint8_t *pkt_to_tx);
@@ -117,6 +179,10 @@ static void HandlePadAssignmentSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
 static void HandlePadCalibrationDataGet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
 static void HandlePadCalibrationDataSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
 static void HandlePadDataGet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
+static void PadDataRead(HeadArraySensor_t sensor_id, HeadArrayInputType_t input_type, TypeAccess16Bit_t *raw, TypeAccess16Bit_t *adjusted);
+static void HandlePadDataSubscribe(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
+static bool StreamFrameDue(TimerTick_t *wait_ms);
+static void BuildStreamFramePacket(uint8_t *pkt_to_tx);
 static void BuildEnabledFeaturesResponsePacket(uint8_t *pkt_to_tx);
 static void HandleEnabledFeaturesSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
 static void HandleModeOfOpSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
@@ -129,6 +195,23 @@ static HeadArrayInputType_t TranslateInputTypeValToEnum(uint8_t input_type);
 static uint8_t CalcChecksum(uint8_t *packet, uint8_t len);
 static void CreateGetOffsetResponse (uint8_t *pkt_to_tx);
 static void CreateSetOffsetResponse (uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
+static void HandleParametersGet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
+static void HandleParametersSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
+static bool ParameterSetAllowed(EepromItemId_t item_id, uint16_t val);
+static bool InputTypeValid(uint16_t val);
+static bool OutputMapValid(uint16_t val);
+static bool ThresholdValid(uint16_t val);
+static bool LongPressTimeValid(uint16_t val);
+static bool Features2Valid(uint16_t val);
+static bool ActiveFeatureValid(uint16_t val);
+static bool NeutralDacSettingValid(uint16_t val);
+static bool DriveOffsetValid(uint16_t val);
+static void CreateEepromWearResponse(uint8_t *pkt_to_tx);
+static void CreateProfileGetResponse(uint8_t *pkt_to_tx);
+static void HandleProfileSelect(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
+static void HandleEventLogRead(uint8_t *rxd_pkt, uint8_t *pkt_to_tx);
+static bool BuildEventLogFramePacket(uint8_t *pkt_to_tx);
+static void EventLogReadStop(void);
 
 /* *******************   Public Function Definitions   ******************** */
 
@@ -142,6 +225,9 @@ void haHhpApp_Init(void)
 {
 	haHhp_Init();
 
+	hhp_link_event = event_create();
+	haHhpBsp_EventCallbackSet(LinkEventIsr);
+
     ha_hhp_if_task_id = task_create(HaHhpInterfaceHandlingTask, NULL, HA_HHP_IF_MGMT_TASK_PRIO, NULL, 0, 0);
 }
 
@@ -158,35 +244,87 @@ static void HaHhpInterfaceHandlingTask(void)
     task_open();
 	while (1)
     {
-		if (haHhpBsp_MasterRtsAsserted())
+		if (hhp_tx_pending)
+		{
+			// The response goes out as soon as the master lets go of the channel. Nothing else may
+			// use hhp_tx_pkt_buff until then.
+			if (haHhpBsp_TransmitPacket(hhp_tx_pkt_buff, hhp_tx_pkt_buff[0]) || (hhp_tx_wait_ms >= HHP_TX_HOLD_OFF_ms))
+			{
+				hhp_tx_pending = false;
+			}
+			else
+			{
+				hhp_tx_wait_ms++;
+				task_wait(MILLISECONDS_TO_TICKS(1));
+			}
+		}
+		else if (!(haHhpBsp_MasterRtsAsserted() && haHhpBsp_ReadyToReceivePacket()))
+		{
+			if (haHhpBsp_ReadyToReceivePacket() && !haHhpBsp_MasterRtsAsserted() && BuildEventLogFramePacket(hhp_tx_pkt_buff))
+			{
+				// Push the next part of an event log read. These go back to back until it's all out.
+				// Unlike a response, a frame the master asserts RTS ahead of isn't kept, the master
+				// is asking for something else and that stops the read anyway.
+				(void)haHhpBsp_TransmitPacket(hhp_tx_pkt_buff, hhp_tx_pkt_buff[0]);
+			}
+			else if (haHhpBsp_ReadyToReceivePacket() && !haHhpBsp_MasterRtsAsserted() && StreamFrameDue(&stream_wait_ms))
+			{
+				// Push the next pad data frame. The master hears it like any other response.
+				BuildStreamFramePacket(hhp_tx_pkt_buff);
+				(void)haHhpBsp_TransmitPacket(hhp_tx_pkt_buff, hhp_tx_pkt_buff[0]);
+			}
+			else
+			{
+				// Nothing to do until the master asserts RTS, the last packet is out, or the next
+				// stream frame is due.
+				event_wait_timeout(hhp_link_event, MILLISECONDS_TO_TICKS(stream_wait_ms));
+			}
+		}
+		else
 		{
-			// Receive, process, and respond to the packet without fear of OS ticks in
-			// and mucking with timing.  Note: sys tick is active, but only processes the
-			// absolute essentials.
-			isrsOsTickEnable(false);
+			// The MSSP interrupt collects the packet and signals once the whole thing is in,
+			// so the OS keeps running while it comes in.
+			haHhp_RxPacketStart(hhp_rx_data_buff);
+			haHhpBsp_SlaveReadyToReceivePacket();
 
-			if (haHhpBsp_ReadyToReceivePacket())
+			event_wait_timeout(hhp_link_event, MILLISECONDS_TO_TICKS(HHP_RX_TIMEOUT_ms));
+
+			if (haHhp_RxPacketStatus() == HA_HHP_BSP_RX_DONE)
 			{
-				haHhpBsp_SlaveReadyToReceivePacket();
+				// The master has moved on, so don't push the rest of an event log read at it.
+				EventLogReadStop();
+				ProcessRxdPacket(hhp_rx_data_buff, hhp_tx_pkt_buff);
+			}
 
-				if(haHhp_RxPacket(hhp_rx_data_buff))
-				{
-					ProcessRxdPacket(hhp_rx_data_buff, hhp_tx_pkt_buff);
+			// Wait for the master to let go of the channel. It does so right after sending, so poll.
+			for (hhp_wait_ms = 0; haHhpBsp_MasterRtsAsserted() && (hhp_wait_ms < HHP_RX_TIMEOUT_ms); hhp_wait_ms++)
+			{
+				task_wait(MILLISECONDS_TO_TICKS(1));
+			}
 
-					// There's always a response from slave->master
-					haHhpBsp_TransmitPacket(hhp_tx_pkt_buff, hhp_tx_pkt_buff[0]);
-				}
+			if (haHhp_RxPacketStatus() == HA_HHP_BSP_RX_DONE)
+			{
+				// There's always a response from slave->master. If the master is still holding
+				// the channel, keep it until the master lets go.
+				hhp_tx_pending = !haHhpBsp_TransmitPacket(hhp_tx_pkt_buff, hhp_tx_pkt_buff[0]);
+				hhp_tx_wait_ms = hhp_wait_ms;
 			}
-			
-			isrsOsTickEnable(true);
 		}
-
-		// Need to keep the wait very short, but need to wait.
-		task_wait(MILLISECONDS_TO_TICKS(1));
 	}
     task_close();
 }
 
+//-------------------------------
+// Function: LinkEventIsr
+//
+// Description: Wakes the HHP task. Called by the BSP from interrupt context.
+//
+//-------------------------------
+static void LinkEventIsr(void)
+{
+	event_ISR_signal(hhp_link_event);
+}
+
 //-------------------------------
 // Function: ProcessRxdPacket
 //
@@ -242,7 +380,6 @@ static void ProcessRxdPacket(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 				// 			<SENSOR TYPE> = "D", "P" 
 				//  		<ACK/NAK> = ACK if all is good, NACK if packet is malformed on reception.	
 				HandlePadAssignmentSet(rxd_pkt, pkt_to_tx);
-				BuildAckPacket(pkt_to_tx);
 				break;
 
 			// Sets a pad's input min/max raw input value as well as the min/max threshold values for input->output translation.
@@ -278,7 +415,6 @@ static void ProcessRxdPacket(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 				// 			<MAX_THRESH> = A value in the range [0,1023]. 
 				// 			<ACK/NAK> = ACK if all is good, NACK if packet is malformed on reception.	
 				HandlePadCalibrationDataSet(rxd_pkt, pkt_to_tx);
-				BuildAckPacket(pkt_to_tx);
 				break;
 			
 			// Start calibration session
@@ -388,7 +524,6 @@ static void ProcessRxdPacket(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
                 //              0x02 is MODE_REVERSE, 1=enabled, 0=disabled (Normal Pin5 operation)
 				// 			<ACK/NAK> = ACK if all is good, NACK if packet is malformed on reception.
 				HandleEnabledFeaturesSet(rxd_pkt, pkt_to_tx);
-				BuildAckPacket(pkt_to_tx);
 				break;
 
 			// Set mode of operation of head array.
@@ -471,7 +606,7 @@ static void ProcessRxdPacket(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
                 //
                 //  <LEN><SAVE_PARAMETERS_CMD><CHKSUM>
                 //  <LEN><ACK><CHKSUM>
-                eepromFlush (true);      // save all parameters.
+                eepromFlush (false);     // save whatever has changed now, rather than waiting for the supervisor.
 				BuildAckPacket(pkt_to_tx);
                 break;
 
@@ -501,6 +636,135 @@ static void ProcessRxdPacket(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 				CreateSetOffsetResponse (rxd_pkt, pkt_to_tx);
                 break;
 
+			case HA_HHP_CMD_PAD_DATA_SUBSCRIBE:
+				// Starts or stops a stream of pad data frames, pushed by the slave.
+				//
+				// Received packet structure:
+				// <LEN><PAD_DATA_SUBSCRIBE_CMD><PERIOD><CHKSUM>
+				//
+				// Response packet structure:
+				// <LEN><ACK/NACK><CHKSUM>
+				//
+				// Then every PERIOD until stopped:
+				// <LEN><PAD_DATA_SUBSCRIBE_CMD><SEQ><L RAW><L ADJ><R RAW><R ADJ><C RAW><C ADJ><CHKSUM>
+				//
+				// Where:	<PAD_DATA_SUBSCRIBE_CMD> = 0x42
+				// 			<PERIOD> = frame period in 10 ms units, at least 20 ms. 0 stops the stream.
+				// 			<SEQ> = counts up by one each frame so dropped frames can be spotted.
+				// 			<RAW> = 2 bytes, high byte first. Same as PAD_DATA_GET.
+				// 			<ADJ> = 2 bytes, high byte first, the processed demand. Same as PAD_DATA_GET.
+				HandlePadDataSubscribe(rxd_pkt, pkt_to_tx);
+				break;
+
+			case HA_HHP_CMD_PARAMETERS_GET:
+				// Reads any number of stored items in one go.
+				//
+				// Received packet structure:
+				// <LEN><PARAMETERS_GET_CMD><ID>...<ID><CHKSUM>
+				//
+				// Response packet structure:
+				// <LEN><PARAMETERS_GET_CMD><ID><SIZE><VALUE>...<ID><SIZE><VALUE><CHKSUM>
+				// or
+				// <LEN><NACK><CHKSUM>
+				//
+				// Where:	<PARAMETERS_GET_CMD> = 0x43
+				// 			<ID> = an EepromItemId_t value.
+				// 			<SIZE> = 1 or 2, the number of bytes in <VALUE>.
+				// 			<VALUE> = the stored value, high byte first.
+				// 			NACK if an <ID> is unknown or the answer doesn't fit in one packet.
+				HandleParametersGet(rxd_pkt, pkt_to_tx);
+				break;
+
+			case HA_HHP_CMD_PARAMETERS_SET:
+				// Writes any number of stored items in one go. Either all of them are
+				// taken, or none are.
+				//
+				// Received packet structure:
+				// <LEN><PARAMETERS_SET_CMD><ID><SIZE><VALUE>...<ID><SIZE><VALUE><CHKSUM>
+				//
+				// Response packet structure:
+				// <LEN><ACK/NACK><CHKSUM>
+				//
+				// Where:	<PARAMETERS_SET_CMD> = 0x44
+				// 			<ID>, <SIZE>, <VALUE> = same as PARAMETERS_GET.
+				// 			<ACK/NAK> = ACK once the items are saved. NACK if the packet is malformed,
+				// 					an <ID> is unknown or read only, a <SIZE> is wrong or a value is
+				// 					out of range. Nothing is changed on a NACK.
+				HandleParametersSet(rxd_pkt, pkt_to_tx);
+				break;
+
+			case HA_HHP_CMD_EEPROM_WEAR_GET:
+				// Reports how much the settings in EEPROM have been written, to estimate how
+				// long it has left.
+				//
+				// Received packet structure:
+				// <LEN><EEPROM_WEAR_GET_CMD><CHKSUM>
+				//
+				// Response packet structure:
+				// <LEN><EEPROM_WEAR_GET_CMD><WRITES>...<WRITES><CHKSUM>
+				//
+				// Where:	<EEPROM_WEAR_GET_CMD> = 0x45
+				// 			<WRITES> = 4 bytes, high byte first. Times a settings log page has been
+				// 					written over the life of the unit, one per page.
+				CreateEepromWearResponse(pkt_to_tx);
+				break;
+
+			case HA_HHP_CMD_PROFILE_GET:
+				// Reports which user profile is active.
+				//
+				// Received packet structure:
+				// <LEN><PROFILE_GET_CMD><CHKSUM>
+				//
+				// Response packet structure:
+				// <LEN><PROFILE_GET_CMD><ACTIVE><NUM_PROFILES><CHKSUM>
+				//
+				// Where:	<PROFILE_GET_CMD> = 0x46
+				// 			<ACTIVE> = the active profile, from 0.
+				// 			<NUM_PROFILES> = how many profiles there are.
+				CreateProfileGetResponse(pkt_to_tx);
+				break;
+
+			case HA_HHP_CMD_PROFILE_SELECT:
+				// Switches to another user profile. Pad input types, output maps, thresholds
+				// and minimum drive offsets all come from the active profile, and the
+				// single item commands get and set the active profile's.
+				//
+				// Received packet structure:
+				// <LEN><PROFILE_SELECT_CMD><PROFILE><CHKSUM>
+				//
+				// Response packet structure:
+				// <LEN><ACK/NACK><CHKSUM>
+				//
+				// Where:	<PROFILE_SELECT_CMD> = 0x47
+				// 			<PROFILE> = the profile to make active, from 0.
+				// 			<ACK/NAK> = ACK once switched. NACK if the packet is malformed or
+				// 					there's no such profile.
+				HandleProfileSelect(rxd_pkt, pkt_to_tx);
+				break;
+
+			case HA_HHP_CMD_EVENT_LOG_READ:
+				// Reads back the event log, oldest entry first. The entries follow the response
+				// in frames pushed by the slave, back to back, the same way as the pad data
+				// stream. Any packet from the master stops them.
+				//
+				// Received packet structure:
+				// <LEN><EVENT_LOG_READ_CMD><CHKSUM>
+				//
+				// Response packet structure:
+				// <LEN><EVENT_LOG_READ_CMD><NUM_ENTRIES><CHKSUM>
+				//
+				// Then until all NUM_ENTRIES are out:
+				// <LEN><EVENT_LOG_READ_CMD><INDEX><ENTRY>...<ENTRY><CHKSUM>
+				//
+				// Where:	<EVENT_LOG_READ_CMD> = 0x48
+				// 			<INDEX> = which entry the frame starts with, 0 being the oldest.
+				// 			<ENTRY> = <UPTIME><CODE><DATA>
+				// 			<UPTIME> = 4 bytes, high byte first. ms since that power up.
+				// 			<CODE> = an EventLogCode_t value. 0 if the entry was damaged.
+				// 			<DATA> = 2 bytes, high byte first. Depends on <CODE>.
+				HandleEventLogRead(rxd_pkt, pkt_to_tx);
+				break;
+
 			default:
                 myData[0] = *rxd_pkt;
                 myData[1] = *(rxd_pkt+1);
@@ -610,23 +874,36 @@ static void HandlePadAssignmentGet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 //-------------------------------
 static void HandlePadAssignmentSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 {
-    UNUSED(pkt_to_tx);
-    
+	EepromItemId_t output_map_item;
+	EepromItemId_t input_type_item;
+	uint8_t output_map = (uint8_t)TranslateInputToOutputMapValToEnum(rxd_pkt[3]);
+	uint8_t input_type = (uint8_t)TranslateInputTypeValToEnum(rxd_pkt[4]);
+
 	if (rxd_pkt[2] == COMMS_PAD_SEL_LEFT)
 	{
-		eepromEnumSet(EEPROM_STORED_ITEM_LEFT_PAD_OUTPUT_MAP, (EepromStoredEnumType_t)TranslateInputToOutputMapValToEnum(rxd_pkt[3]));
-		eepromEnumSet(EEPROM_STORED_ITEM_LEFT_PAD_INPUT_TYPE, (EepromStoredEnumType_t)TranslateInputTypeValToEnum(rxd_pkt[4]));
+		output_map_item = EEPROM_STORED_ITEM_LEFT_PAD_OUTPUT_MAP;
+		input_type_item = EEPROM_STORED_ITEM_LEFT_PAD_INPUT_TYPE;
 	}
 	else if (rxd_pkt[2] == COMMS_PAD_SEL_RIGHT)
 	{
-		eepromEnumSet(EEPROM_STORED_ITEM_RIGHT_PAD_OUTPUT_MAP, (EepromStoredEnumType_t)TranslateInputToOutputMapValToEnum(rxd_pkt[3]));
-		eepromEnumSet(EEPROM_STORED_ITEM_RIGHT_PAD_INPUT_TYPE, (EepromStoredEnumType_t)TranslateInputTypeValToEnum(rxd_pkt[4]));
-
+		output_map_item = EEPROM_STORED_ITEM_RIGHT_PAD_OUTPUT_MAP;
+		input_type_item = EEPROM_STORED_ITEM_RIGHT_PAD_INPUT_TYPE;
 	}
 	else // COMMS_PAD_SEL_CTR
 	{
-		eepromEnumSet(EEPROM_STORED_ITEM_CTR_PAD_OUTPUT_MAP, (EepromStoredEnumType_t)TranslateInputToOutputMapValToEnum(rxd_pkt[3]));
-		eepromEnumSet(EEPROM_STORED_ITEM_CTR_PAD_INPUT_TYPE, (EepromStoredEnumType_t)TranslateInputTypeValToEnum(rxd_pkt[4]));
+		output_map_item = EEPROM_STORED_ITEM_CTR_PAD_OUTPUT_MAP;
+		input_type_item = EEPROM_STORED_ITEM_CTR_PAD_INPUT_TYPE;
+	}
+
+	if (OutputMapValid(output_map) && InputTypeValid(input_type))
+	{
+		eepromEnumSet(output_map_item, (EepromStoredEnumType_t)output_map);
+		eepromEnumSet(input_type_item, (EepromStoredEnumType_t)input_type);
+		BuildAckPacket(pkt_to_tx);
+	}
+	else
+	{
+		BuildNackPacket(pkt_to_tx);
 	}
 }
 
@@ -705,38 +982,37 @@ static void HandlePadCalibrationDataGet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 //-------------------------------
 static void HandlePadCalibrationDataSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 {
-	TypeAccess16Bit_t t_val;
+	TypeAccess16Bit_t min_thresh;
+	TypeAccess16Bit_t max_thresh;
+
+	min_thresh.bytes[0] = rxd_pkt[4];
+	min_thresh.bytes[1] = rxd_pkt[3];
+	max_thresh.bytes[0] = rxd_pkt[6];
+	max_thresh.bytes[1] = rxd_pkt[5];
+
+	if (!ThresholdValid(min_thresh.val) || !ThresholdValid(max_thresh.val))
+	{
+		BuildNackPacket(pkt_to_tx);
+		return;
+	}
 
 	if (rxd_pkt[2] == COMMS_PAD_SEL_LEFT)
 	{
-		t_val.bytes[0] = rxd_pkt[4];
-		t_val.bytes[1] = rxd_pkt[3];
-		eeprom16bitSet(EEPROM_STORED_ITEM_LEFT_PAD_MIN_THRESH_PERC, t_val.val);
-		
-		t_val.bytes[00] = rxd_pkt[6];
-		t_val.bytes[1] = rxd_pkt[5];
-		eeprom16bitSet(EEPROM_STORED_ITEM_LEFT_PAD_MAX_THRESH_PERC, t_val.val);
+		eeprom16bitSet(EEPROM_STORED_ITEM_LEFT_PAD_MIN_THRESH_PERC, min_thresh.val);
+		eeprom16bitSet(EEPROM_STORED_ITEM_LEFT_PAD_MAX_THRESH_PERC, max_thresh.val);
 	}
 	else if (rxd_pkt[2] == COMMS_PAD_SEL_RIGHT)
 	{
-		t_val.bytes[0] = rxd_pkt[4];
-		t_val.bytes[1] = rxd_pkt[3];
-		eeprom16bitSet(EEPROM_STORED_ITEM_RIGHT_PAD_MIN_THRESH_PERC, t_val.val);
-		
-		t_val.bytes[0] = rxd_pkt[6];
-		t_val.bytes[1] = rxd_pkt[5];
-		eeprom16bitSet(EEPROM_STORED_ITEM_RIGHT_PAD_MAX_THRESH_PERC, t_val.val);
+		eeprom16bitSet(EEPROM_STORED_ITEM_RIGHT_PAD_MIN_THRESH_PERC, min_thresh.val);
+		eeprom16bitSet(EEPROM_STORED_ITEM_RIGHT_PAD_MAX_THRESH_PERC, max_thresh.val);
 	}
 	else // COMMS_PAD_SEL_CTR
 	{
-		t_val.bytes[0] = rxd_pkt[4];
-		t_val.bytes[1] = rxd_pkt[3];
-		eeprom16bitSet(EEPROM_STORED_ITEM_CTR_PAD_MIN_THRESH_PERC, t_val.val);
-		
-		t_val.bytes[0] = rxd_pkt[6];
-		t_val.bytes[1] = rxd_pkt[5];
-		eeprom16bitSet(EEPROM_STORED_ITEM_CTR_PAD_MAX_THRESH_PERC, t_val.val);
+		eeprom16bitSet(EEPROM_STORED_ITEM_CTR_PAD_MIN_THRESH_PERC, min_thresh.val);
+		eeprom16bitSet(EEPROM_STORED_ITEM_CTR_PAD_MAX_THRESH_PERC, max_thresh.val);
 	}
+
+	BuildAckPacket(pkt_to_tx);
 }
 
 //-------------------------------
@@ -749,10 +1025,9 @@ static void HandlePadDataGet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 {
 	HeadArrayInputType_t input_type;
 	HeadArraySensor_t sensor_id;
+	TypeAccess16Bit_t raw;
+	TypeAccess16Bit_t adjusted;
 
-    uint16_t my_Neutral_DAC_setting = eeprom16bitGet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_SETTING);
-    uint16_t my_Neutral_DAC_range = eeprom16bitGet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_RANGE);
-    
 	switch (rxd_pkt[2])
 	{
 		case COMMS_PAD_SEL_LEFT:
@@ -776,56 +1051,157 @@ static void HandlePadDataGet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 			return; // Save some code space by doing this instead of using some "cleaner" method.
 	}
 
+	PadDataRead(sensor_id, input_type, &raw, &adjusted);
+
 	pkt_to_tx[0] = 6;
+	pkt_to_tx[1] = raw.bytes[1];
+	pkt_to_tx[2] = raw.bytes[0];
+	pkt_to_tx[3] = adjusted.bytes[1];
+	pkt_to_tx[4] = adjusted.bytes[0];
+}
+
+//-------------------------------
+// Function: PadDataRead
+//
+// Description: Gets a pad's raw input and its processed demand. For a digital pad both are the
+//		pad's on/off state. For a proportional pad the demand is a percentage of the DAC range.
+//
+//-------------------------------
+static void PadDataRead(HeadArraySensor_t sensor_id, HeadArrayInputType_t input_type, TypeAccess16Bit_t *raw, TypeAccess16Bit_t *adjusted)
+{
+    uint16_t my_Neutral_DAC_setting;
+    uint16_t my_Neutral_DAC_range;
 
 	if (input_type == HEAD_ARR_INPUT_DIGITAL)
 	{
-		pkt_to_tx[1] = 0x00;
-		pkt_to_tx[2] = (uint8_t)headArrayDigitalInputValue(sensor_id);
-		pkt_to_tx[3] = 0x00;
-		pkt_to_tx[4] = (uint8_t)headArrayDigitalInputValue(sensor_id);
+		raw->val = (uint8_t)headArrayDigitalInputValue(sensor_id);
+		adjusted->val = raw->val;
+		return;
 	}
-	else
+
+	my_Neutral_DAC_setting = eeprom16bitGet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_SETTING);
+	my_Neutral_DAC_range = eeprom16bitGet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_RANGE);
+
+	raw->val = headArrayProportionalInputValueRaw(sensor_id);
+
+	switch (sensor_id)
 	{
-		TypeAccess16Bit_t t_val;
-		
-		t_val.val = headArrayProportionalInputValueRaw(sensor_id);
-		pkt_to_tx[1] = t_val.bytes[1];
-		pkt_to_tx[2] = t_val.bytes[0];
-		
-        switch (sensor_id)
-        {
-            // Create a percentage based upon the DAC output.
-            case HEAD_ARRAY_SENSOR_LEFT:
-                // This number is <= neutral for LEFT commands
-                t_val.val = headArrayOutputValue(HEAD_ARRAY_OUT_AXIS_LEFT_RIGHT);
-                if (t_val.val > my_Neutral_DAC_setting)
-                    t_val.val = 0;
-                else
-                    t_val.val = ((my_Neutral_DAC_setting - t_val.val) * 100) / my_Neutral_DAC_range;
-                break;
-            case HEAD_ARRAY_SENSOR_RIGHT:
-                // This number is >= neutral for RIGHT commands 
-                t_val.val = headArrayOutputValue(HEAD_ARRAY_OUT_AXIS_LEFT_RIGHT);
-                if (t_val.val < my_Neutral_DAC_setting)
-                    t_val.val = 0;
-                else
-                    t_val.val = ((t_val.val - my_Neutral_DAC_setting) * 100) / my_Neutral_DAC_range;
-                break;
-            case HEAD_ARRAY_SENSOR_CENTER:
-                // This number is >= neutral
-                t_val.val = headArrayOutputValue(HEAD_ARRAY_OUT_AXIS_FWD_REV);
-                if (t_val.val < my_Neutral_DAC_setting)
-                    t_val.val = 0;
-                else
-                    t_val.val = ((t_val.val - my_Neutral_DAC_setting) * 100) / my_Neutral_DAC_range;
-                break;
-            case HEAD_ARRAY_SENSOR_EOL: // Satisfies "not considered" compiler warning.
-                break;
-        } // end switch
-		pkt_to_tx[3] = t_val.bytes[1];
-		pkt_to_tx[4] = t_val.bytes[0];
+		// Create a percentage based upon the DAC output.
+		case HEAD_ARRAY_SENSOR_LEFT:
+			// This number is <= neutral for LEFT commands
+			adjusted->val = headArrayOutputValue(HEAD_ARRAY_OUT_AXIS_LEFT_RIGHT);
+			if (adjusted->val > my_Neutral_DAC_setting)
+				adjusted->val = 0;
+			else
+				adjusted->val = ((my_Neutral_DAC_setting - adjusted->val) * 100) / my_Neutral_DAC_range;
+			break;
+		case HEAD_ARRAY_SENSOR_RIGHT:
+			// This number is >= neutral for RIGHT commands 
+			adjusted->val = headArrayOutputValue(HEAD_ARRAY_OUT_AXIS_LEFT_RIGHT);
+			if (adjusted->val < my_Neutral_DAC_setting)
+				adjusted->val = 0;
+			else
+				adjusted->val = ((adjusted->val - my_Neutral_DAC_setting) * 100) / my_Neutral_DAC_range;
+			break;
+		case HEAD_ARRAY_SENSOR_CENTER:
+			// This number is >= neutral
+			adjusted->val = headArrayOutputValue(HEAD_ARRAY_OUT_AXIS_FWD_REV);
+			if (adjusted->val < my_Neutral_DAC_setting)
+				adjusted->val = 0;
+			else
+				adjusted->val = ((adjusted->val - my_Neutral_DAC_setting) * 100) / my_Neutral_DAC_range;
+			break;
+		default:
+			adjusted->val = 0;
+			break;
+	} // end switch
+}
+
+//-------------------------------
+// Function: HandlePadDataSubscribe
+//
+// Description: Starts, changes or stops the pad data stream. The first frame goes out right away.
+//
+//-------------------------------
+static void HandlePadDataSubscribe(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
+{
+	uint16_t period_ms = (uint16_t)rxd_pkt[2] * HHP_STREAM_PERIOD_UNIT_ms;
+
+	if ((period_ms != 0) && (period_ms < HHP_STREAM_MIN_PERIOD_ms))
+	{
+		BuildNackPacket(pkt_to_tx);
+		return;
 	}
+
+	stream_period_ms = period_ms;
+	stream_next_ms = stopwatchCurrentTime();
+	stream_seq = 0;
+	BuildAckPacket(pkt_to_tx);
+}
+
+//-------------------------------
+// Function: StreamFrameDue
+//
+// Description: Lets the HHP task know whether a pad data frame should go out now. If not, wait_ms
+//		is how long the task can sleep before checking again.
+//
+//-------------------------------
+static bool StreamFrameDue(TimerTick_t *wait_ms)
+{
+	TimerTick_t late_ms;
+
+	*wait_ms = HHP_IDLE_POLL_ms;
+
+	if (stream_period_ms == 0)
+	{
+		return false;
+	}
+
+	late_ms = stopwatchCurrentTime() - stream_next_ms;
+	if (late_ms < 0x8000)
+	{
+		// Due. If we fell a whole period behind, don't try to catch up.
+		stream_next_ms = (late_ms < stream_period_ms) ? (stream_next_ms + stream_period_ms) : (stopwatchCurrentTime() + stream_period_ms);
+		return true;
+	}
+
+	// Not due yet, late_ms is negative.
+	late_ms = (TimerTick_t)(0 - late_ms);
+	if (late_ms < *wait_ms)
+	{
+		*wait_ms = (late_ms > 0) ? late_ms : 1;
+	}
+	return false;
+}
+
+//-------------------------------
+// Function: BuildStreamFramePacket
+//
+// Description: Builds one pad data stream frame, see HA_HHP_CMD_PAD_DATA_SUBSCRIBE.
+//
+//-------------------------------
+static void BuildStreamFramePacket(uint8_t *pkt_to_tx)
+{
+	static const HeadArraySensor_t stream_sensors[] = {HEAD_ARRAY_SENSOR_LEFT, HEAD_ARRAY_SENSOR_RIGHT, HEAD_ARRAY_SENSOR_CENTER};
+	static const EepromItemId_t stream_input_types[] = {EEPROM_STORED_ITEM_LEFT_PAD_INPUT_TYPE, EEPROM_STORED_ITEM_RIGHT_PAD_INPUT_TYPE, EEPROM_STORED_ITEM_CTR_PAD_INPUT_TYPE};
+	TypeAccess16Bit_t raw;
+	TypeAccess16Bit_t adjusted;
+	uint8_t idx = 3;
+
+	pkt_to_tx[0] = HHP_STREAM_FRAME_LEN;
+	pkt_to_tx[1] = HA_HHP_CMD_PAD_DATA_SUBSCRIBE;
+	pkt_to_tx[2] = stream_seq++;
+
+	for (uint8_t i = 0; i < (sizeof(stream_sensors) / sizeof(stream_sensors[0])); i++)
+	{
+		PadDataRead(stream_sensors[i], (HeadArrayInputType_t)eepromEnumGet(stream_input_types[i]), &raw, &adjusted);
+		pkt_to_tx[idx++] = raw.bytes[1];
+		pkt_to_tx[idx++] = raw.bytes[0];
+		pkt_to_tx[idx++] = adjusted.bytes[1];
+		pkt_to_tx[idx++] = adjusted.bytes[0];
+	}
+
+	pkt_to_tx[HHP_STREAM_FRAME_LEN - 1] = CalcChecksum(pkt_to_tx, HHP_STREAM_FRAME_LEN - 1);
 }
 
 //-------------------------------
@@ -854,10 +1230,18 @@ static void HandleEnabledFeaturesSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
     
     item1 = rxd_pkt[2];
     item2 = rxd_pkt[4];
+
+	// Every bit of the first feature byte is a feature, so only the second needs checking.
+	if (!Features2Valid(item2))
+	{
+		BuildNackPacket(pkt_to_tx);
+		return;
+	}
     
 	eeprom8bitSet(EEPROM_STORED_ITEM_ENABLED_FEATURES, item1);
-	eeprom16bitSet(EEPROM_STORED_ITEM_USER_BTN_LONG_PRESS_ACT_TIME, (uint16_t)rxd_pkt[3] * (uint16_t)100);
+	eeprom16bitSet(EEPROM_STORED_ITEM_USER_BTN_LONG_PRESS_ACT_TIME, (uint16_t)rxd_pkt[3] * (uint16_t)HHP_LONG_PRESS_UNIT_ms);
 	eeprom8bitSet(EEPROM_STORED_ITEM_ENABLED_FEATURES_2, item2);
+	BuildAckPacket(pkt_to_tx);
 
 //	eeprom8bitSet(EEPROM_STORED_ITEM_ENABLED_FEATURES, rxd_pkt[2]);
 //	eeprom16bitSet(EEPROM_STORED_ITEM_USER_BTN_LONG_PRESS_ACT_TIME, (uint16_t)rxd_pkt[3] * (uint16_t)100);
@@ -877,7 +1261,7 @@ static void HandleModeOfOpSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 
 	// The current mapping for values received in rxd_pkt[2] and FunctionalFeature_t is a simple offset of 1.
 	// Also, cannot change the current feature if device is not active (must "power on" device first)
-	if (appCommonFeatureIsEnabled((FunctionalFeature_t)rxd_pkt[2] - 1))
+	if (ActiveFeatureValid((uint8_t)(rxd_pkt[2] - 1)))
 	{
 		eepromEnumSet(EEPROM_STORED_ITEM_CURRENT_ACTIVE_FEATURE, (EepromStoredEnumType_t)(rxd_pkt[2] - 1));
 		pkt_to_tx[1] = HA_HHP_RESP_ACK;
@@ -954,18 +1338,13 @@ static void Buid_DAC_Get_Response(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 static void Handle_DAC_SetCommand(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 {
     TypeAccess16Bit_t t_val;
-    int16_t my16Val, DAC_Constant, DAC_Range;
 
 	t_val.bytes[0] = rxd_pkt[3];
 	t_val.bytes[1] = rxd_pkt[2];
-    my16Val = t_val.val;
-    DAC_Constant = eeprom16bitGet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_COUNTS);
-    DAC_Range = eeprom16bitGet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_RANGE);
     // Check the value for something valid.
-    if ((my16Val <= (DAC_Constant + DAC_Range))
-       && (my16Val >= (DAC_Constant - DAC_Range)))
+    if (NeutralDacSettingValid(t_val.val))
     {
-		eeprom16bitSet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_SETTING, my16Val);
+		eeprom16bitSet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_SETTING, t_val.val);
 		pkt_to_tx[1] = HA_HHP_RESP_ACK;
 	}
 	else
@@ -1005,9 +1384,9 @@ static void CreateGetOffsetResponse (uint8_t *pkt_to_tx)
 //-------------------------------
 static void CreateSetOffsetResponse (uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
 {
-    if ((rxd_pkt[2] >= 0) && (rxd_pkt[2] <= 60) // Is the value a valid range for Center Pad
-        && (rxd_pkt[3] >= 0) && (rxd_pkt[3] <= 60) // Is the value a valid range for Left Pad
-        && (rxd_pkt[4] >= 0) && (rxd_pkt[4] <= 60)) // Is the value a valid range for Right Pad
+    if (DriveOffsetValid(rxd_pkt[2])		// Is the value a valid range for Center Pad
+        && DriveOffsetValid(rxd_pkt[3])		// Is the value a valid range for Left Pad
+        && DriveOffsetValid(rxd_pkt[4]))	// Is the value a valid range for Right Pad
     {
     	eeprom8bitSet(EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET, rxd_pkt[2]);
     	eeprom8bitSet(EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET, rxd_pkt[3]);
@@ -1021,6 +1400,416 @@ static void CreateSetOffsetResponse (uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
     pkt_to_tx[0] = 3;   // Set msg length to 3 for NAK or ACK.
 }
 
+//-------------------------------
+// Function: HandleParametersGet
+//
+// Description: Builds one response holding every item asked for.
+//
+//-------------------------------
+static void HandleParametersGet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
+{
+	uint8_t rx_idx;
+	uint8_t tx_idx = 2;
+	uint8_t size;
+	uint16_t val;
+
+	pkt_to_tx[1] = HA_HHP_CMD_PARAMETERS_GET;
+
+	// Everything between the command and the checksum is an item id.
+	for (rx_idx = 2; rx_idx < (uint8_t)(rxd_pkt[0] - 1); rx_idx++)
+	{
+		size = eepromItemSizeGet((EepromItemId_t)rxd_pkt[rx_idx]);
+
+		// Leave room for this item and the checksum.
+		if ((size == 0) || ((tx_idx + 2 + size + 1) > HHP_RX_TX_BUFF_LEN))
+		{
+			BuildNackPacket(pkt_to_tx);
+			return;
+		}
+
+		val = eepromItemGet((EepromItemId_t)rxd_pkt[rx_idx]);
+
+		pkt_to_tx[tx_idx++] = rxd_pkt[rx_idx];
+		pkt_to_tx[tx_idx++] = size;
+		if (size == 2)
+		{
+			pkt_to_tx[tx_idx++] = (uint8_t)(val >> 8);
+		}
+		pkt_to_tx[tx_idx++] = (uint8_t)val;
+	}
+
+	pkt_to_tx[0] = tx_idx + 1;
+}
+
+//-------------------------------
+// Function: HandleParametersSet
+//
+// Description: Checks every item in the packet before touching any of them, then puts
+//		them all in the RAM copy and writes the ones that changed to EEPROM once.
+//
+//-------------------------------
+static void HandleParametersSet(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
+{
+	uint8_t end = rxd_pkt[0] - 1;
+	uint8_t idx;
+	uint8_t size;
+	uint16_t val;
+
+	// First pass. Check the whole packet.
+	for (idx = 2; idx < end; idx += 2 + size)
+	{
+		size = ((idx + 1) < end) ? rxd_pkt[idx + 1] : 0;
+
+		if ((size == 0) || (size != eepromItemSizeGet((EepromItemId_t)rxd_pkt[idx])) || ((idx + 2 + size) > end))
+		{
+			BuildNackPacket(pkt_to_tx);
+			return;
+		}
+
+		val = (size == 2) ? (((uint16_t)rxd_pkt[idx + 2] << 8) | rxd_pkt[idx + 3]) : rxd_pkt[idx + 2];
+
+		if (!ParameterSetAllowed((EepromItemId_t)rxd_pkt[idx], val))
+		{
+			BuildNackPacket(pkt_to_tx);
+			return;
+		}
+	}
+
+	// Second pass. Nothing else runs until this returns, so the rest of the system
+	// sees either none or all of the new values.
+	for (idx = 2; idx < end; idx += 2 + size)
+	{
+		size = rxd_pkt[idx + 1];
+		val = (size == 2) ? (((uint16_t)rxd_pkt[idx + 2] << 8) | rxd_pkt[idx + 3]) : rxd_pkt[idx + 2];
+		eepromItemSet((EepromItemId_t)rxd_pkt[idx], val);
+	}
+
+	eepromFlush(false);
+	BuildAckPacket(pkt_to_tx);
+}
+
+//-------------------------------
+// Function: ParameterSetAllowed
+//
+// Description: Keeps PARAMETERS_SET to the items the single item commands can set, with the
+//		same checks. Anything not listed, e.g. the bookkeeping items, the ADC calibration and
+//		the active profile (only PROFILE_SELECT switches it), can't be set this way.
+//
+//-------------------------------
+static bool ParameterSetAllowed(EepromItemId_t item_id, uint16_t val)
+{
+	switch (item_id)
+	{
+		// PAD_ASSIGNMENT_SET
+		case EEPROM_STORED_ITEM_LEFT_PAD_INPUT_TYPE:
+		case EEPROM_STORED_ITEM_RIGHT_PAD_INPUT_TYPE:
+		case EEPROM_STORED_ITEM_CTR_PAD_INPUT_TYPE:
+			return InputTypeValid(val);
+
+		case EEPROM_STORED_ITEM_LEFT_PAD_OUTPUT_MAP:
+		case EEPROM_STORED_ITEM_RIGHT_PAD_OUTPUT_MAP:
+		case EEPROM_STORED_ITEM_CTR_PAD_OUTPUT_MAP:
+			return OutputMapValid(val);
+
+		// CAL_RANGE_SET
+		case EEPROM_STORED_ITEM_LEFT_PAD_MIN_THRESH_PERC:
+		case EEPROM_STORED_ITEM_LEFT_PAD_MAX_THRESH_PERC:
+		case EEPROM_STORED_ITEM_RIGHT_PAD_MIN_THRESH_PERC:
+		case EEPROM_STORED_ITEM_RIGHT_PAD_MAX_THRESH_PERC:
+		case EEPROM_STORED_ITEM_CTR_PAD_MIN_THRESH_PERC:
+		case EEPROM_STORED_ITEM_CTR_PAD_MAX_THRESH_PERC:
+			return ThresholdValid(val);
+
+		// ENABLED_FEATURES_SET. Every bit of the first feature byte is a feature.
+		case EEPROM_STORED_ITEM_ENABLED_FEATURES:
+			return true;
+
+		case EEPROM_STORED_ITEM_ENABLED_FEATURES_2:
+			return Features2Valid(val);
+
+		case EEPROM_STORED_ITEM_USER_BTN_LONG_PRESS_ACT_TIME:
+			return LongPressTimeValid(val);
+
+		// MODE_OF_OPERATION_SET
+		case EEPROM_STORED_ITEM_CURRENT_ACTIVE_FEATURE:
+			return ActiveFeatureValid(val);
+
+		// NEUTRAL_DAC_SET
+		case EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_SETTING:
+			return NeutralDacSettingValid(val);
+
+		// DRIVE_OFFSET_SET
+		case EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET:
+		case EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET:
+		case EEPROM_STORED_ITEM_MM_RIGHT_PAD_MINIMUM_DRIVE_OFFSET:
+			return DriveOffsetValid(val);
+
+		default:
+			return false;
+	}
+}
+
+//-------------------------------
+// Function: InputTypeValid
+//
+// Description: Checks a pad input type, as kept in EEPROM.
+//
+//-------------------------------
+static bool InputTypeValid(uint16_t val)
+{
+	return (val == HEAD_ARR_INPUT_DIGITAL) || (val == HEAD_ARR_INPUT_PROPORTIONAL);
+}
+
+//-------------------------------
+// Function: OutputMapValid
+//
+// Description: Checks a pad output map, as kept in EEPROM.
+//
+//-------------------------------
+static bool OutputMapValid(uint16_t val)
+{
+	switch (val)
+	{
+		case HEAD_ARRAY_OUT_FUNC_LEFT:
+		case HEAD_ARRAY_OUT_FUNC_RIGHT:
+		case HEAD_ARRAY_OUT_FUNC_FWD:
+		case HEAD_ARRAY_OUT_FUNC_REV:
+		case HEAD_ARRAY_OUT_FUNC_NONE:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+//-------------------------------
+// Function: ThresholdValid
+//
+// Description: Checks a pad's min or max threshold percentage.
+//
+//-------------------------------
+static bool ThresholdValid(uint16_t val)
+{
+	return (val <= HHP_MAX_THRESH_PERC);
+}
+
+//-------------------------------
+// Function: LongPressTimeValid
+//
+// Description: Checks a long press time in ms. ENABLED_FEATURES_SET can only give whole tenths
+//		of a second that fit in a byte, so nothing else is allowed.
+//
+//-------------------------------
+static bool LongPressTimeValid(uint16_t val)
+{
+	return ((val % HHP_LONG_PRESS_UNIT_ms) == 0) && ((val / HHP_LONG_PRESS_UNIT_ms) <= 0xFF);
+}
+
+//-------------------------------
+// Function: Features2Valid
+//
+// Description: Checks the second feature byte has no undefined bits set.
+//
+//-------------------------------
+static bool Features2Valid(uint16_t val)
+{
+	return ((val & ~(uint16_t)HHP_FEATURES_2_BITS) == 0);
+}
+
+//-------------------------------
+// Function: ActiveFeatureValid
+//
+// Description: Checks a FunctionalFeature_t can be made the active one.
+//
+//-------------------------------
+static bool ActiveFeatureValid(uint16_t val)
+{
+	return (val < FUNC_FEATURE_EOL) && appCommonFeatureIsEnabled((FunctionalFeature_t)val);
+}
+
+//-------------------------------
+// Function: NeutralDacSettingValid
+//
+// Description: Checks a neutral DAC setting is within the stored range of the DAC midpoint.
+//
+//-------------------------------
+static bool NeutralDacSettingValid(uint16_t val)
+{
+    int16_t my16Val, DAC_Constant, DAC_Range;
+
+    my16Val = (int16_t)val;
+    DAC_Constant = eeprom16bitGet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_COUNTS);
+    DAC_Range = eeprom16bitGet(EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_RANGE);
+
+    return (my16Val <= (DAC_Constant + DAC_Range))
+        && (my16Val >= (DAC_Constant - DAC_Range));
+}
+
+//-------------------------------
+// Function: DriveOffsetValid
+//
+// Description: Checks a pad's minimum drive offset.
+//
+//-------------------------------
+static bool DriveOffsetValid(uint16_t val)
+{
+	return (val <= HHP_MAX_MIN_DRIVE_SPEED);
+}
+
+//-------------------------------
+// Function: CreateEepromWearResponse
+//
+// Description: Builds up a packet to send as a response to a HA_HHP_CMD_EEPROM_WEAR_GET command.
+//
+//-------------------------------
+static void CreateEepromWearResponse(uint8_t *pkt_to_tx)
+{
+	uint8_t idx = 2;
+	uint32_t writes;
+
+	pkt_to_tx[1] = HA_HHP_CMD_EEPROM_WEAR_GET;
+
+	for (uint8_t page = 0; page < EEPROM_NUM_LOG_PAGES; page++)
+	{
+		writes = eepromLogPageWritesGet(page);
+		pkt_to_tx[idx++] = (uint8_t)(writes >> 24);
+		pkt_to_tx[idx++] = (uint8_t)(writes >> 16);
+		pkt_to_tx[idx++] = (uint8_t)(writes >> 8);
+		pkt_to_tx[idx++] = (uint8_t)writes;
+	}
+
+	pkt_to_tx[0] = idx + 1;
+}
+
+//-------------------------------
+// Function: CreateProfileGetResponse
+//
+// Description: Builds up a packet to send as a response to a HA_HHP_CMD_PROFILE_GET command.
+//
+//-------------------------------
+static void CreateProfileGetResponse(uint8_t *pkt_to_tx)
+{
+	pkt_to_tx[0] = 5;
+	pkt_to_tx[1] = HA_HHP_CMD_PROFILE_GET;
+	pkt_to_tx[2] = eepromProfileActiveGet();
+	pkt_to_tx[3] = EEPROM_NUM_PROFILES;
+}
+
+//-------------------------------
+// Function: HandleProfileSelect
+//
+// Description: Handles a HA_HHP_CMD_PROFILE_SELECT command. Only the active profile number
+//		is written to EEPROM, the profiles themselves are already there.
+//
+//-------------------------------
+static void HandleProfileSelect(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
+{
+	if ((rxd_pkt[0] != 4) || !eepromProfileSelect(rxd_pkt[2]))
+	{
+		BuildNackPacket(pkt_to_tx);
+		return;
+	}
+
+	eepromFlush(false);
+	BuildAckPacket(pkt_to_tx);
+}
+
+//-------------------------------
+// Function: HandleEventLogRead
+//
+// Description: Starts reading back the event log. The entries follow in frames pushed by
+//		BuildEventLogFramePacket().
+//
+//-------------------------------
+static void HandleEventLogRead(uint8_t *rxd_pkt, uint8_t *pkt_to_tx)
+{
+	if (rxd_pkt[0] != 3)
+	{
+		BuildNackPacket(pkt_to_tx);
+		return;
+	}
+
+	event_log_read_num = eventLogReadStart();
+	event_log_read_next = 0;
+	event_log_read_active = true;
+
+	pkt_to_tx[0] = 4;
+	pkt_to_tx[1] = HA_HHP_CMD_EVENT_LOG_READ;
+	pkt_to_tx[2] = event_log_read_num;
+}
+
+//-------------------------------
+// Function: BuildEventLogFramePacket
+//
+// Description: Builds the next frame of an event log read, see HA_HHP_CMD_EVENT_LOG_READ.
+//
+// return: false if there's no read under way, or no frame yet because EEPROM writes are queued.
+//
+//-------------------------------
+static bool BuildEventLogFramePacket(uint8_t *pkt_to_tx)
+{
+	EventLogEntry_t entry;
+	uint8_t idx = 3;
+
+	if (!event_log_read_active)
+	{
+		return false;
+	}
+
+	if (event_log_read_next >= event_log_read_num)
+	{
+		EventLogReadStop();
+		return false;
+	}
+
+	// Reading would wait for queued EEPROM writes. Come back to it, the task checks again within
+	// HHP_IDLE_POLL_ms.
+	if (!eventLogReadReady())
+	{
+		return false;
+	}
+
+	pkt_to_tx[1] = HA_HHP_CMD_EVENT_LOG_READ;
+	pkt_to_tx[2] = event_log_read_next;
+
+	for (uint8_t i = 0; (i < HHP_EVENT_LOG_ENTRIES_PER_FRAME) && (event_log_read_next < event_log_read_num); i++)
+	{
+		if (!eventLogReadEntry(event_log_read_next++, &entry))
+		{
+			entry.uptime_ms = 0;
+			entry.code = EVENT_LOG_NONE;
+			entry.data = 0;
+		}
+
+		pkt_to_tx[idx++] = (uint8_t)(entry.uptime_ms >> 24);
+		pkt_to_tx[idx++] = (uint8_t)(entry.uptime_ms >> 16);
+		pkt_to_tx[idx++] = (uint8_t)(entry.uptime_ms >> 8);
+		pkt_to_tx[idx++] = (uint8_t)entry.uptime_ms;
+		pkt_to_tx[idx++] = entry.code;
+		pkt_to_tx[idx++] = (uint8_t)(entry.data >> 8);
+		pkt_to_tx[idx++] = (uint8_t)entry.data;
+	}
+
+	pkt_to_tx[0] = idx + 1;
+	pkt_to_tx[idx] = CalcChecksum(pkt_to_tx, idx);
+	return true;
+}
+
+//-------------------------------
+// Function: EventLogReadStop
+//
+// Description: Ends an event log read, whether or not it got to the end.
+//
+//-------------------------------
+static void EventLogReadStop(void)
+{
+	if (event_log_read_active)
+	{
+		event_log_read_active = false;
+		eventLogReadEnd();
+	}
+}
+
 //-------------------------------
 // Function: TranslateInputToOutputMapValFromEnum
 //
@@ -60,6 +60,7 @@ FunctionalFeature_t appCommonGetPreviousEnabledFeature(void);
 void AppCommonDeviceActiveSet(bool is_active);
 bool AppCommonDeviceActiveGet(void);
 void AppCommonForceActiveState (bool is_active);
+bool AppCommonFlashCheckPassed(void);
 
 //void AppCommonCalibrationActiveSet(bool put_into_calibration);
 //bool AppCommonCalibrationActiveGet(void);
@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: bt_status.h
+//
+// Description: Decodes the Bluetooth module's status LED (BT_LED input) into a link state.
+//
+// Author(s): G. Chopcinski (Kg Solutions, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef BT_STATUS_H
+#define BT_STATUS_H
+
+/* ***************************    Includes     **************************** */
+
+// from stdlib
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ******************************   Types   ******************************* */
+
+// Link state as reported by the module's status LED.
+typedef enum
+{
+	BT_LINK_UNKNOWN,		// Not enough edges seen yet to tell.
+	BT_LINK_OFF,			// LED steady off. Module is disabled or not powered.
+	BT_LINK_PAIRING,		// Fast blink. Module is discoverable/waiting for a host.
+	BT_LINK_CONNECTED,		// Slow blink or steady on. Module is connected to a host.
+
+	// Nothing else may be defined past this point!
+	BT_LINK_EOL
+} BtLinkState_t;
+
+/* ***********************   Function Prototypes   ************************ */
+
+void btStatusInit(void);
+void btStatusEdgeIsr(void);
+void btStatusUpdate(void);
+BtLinkState_t btStatusLinkStateGet(void);
+uint16_t btStatusBlinkPeriodGet(void);
+
+#endif // BT_STATUS_H
+
+// end of file.
+//-------------------------------------------------------------------------
@@ -33,10 +33,42 @@
 #define	EFIX_COMMUNICATION_H
 
 #include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+
+// m_LastRxAge_ms when nothing good has been received lately.
+#define EFIX_RX_AGE_UNKNOWN (0xffff)
+
+// Health of the link from the eFix controller.
+typedef struct
+{
+    uint16_t m_GoodFrames;          // Frames that passed the checksum.
+    uint16_t m_ChecksumErrors;      // Frames that failed the checksum.
+    uint16_t m_UnknownFrames;       // Good frames with a Message ID we don't keep.
+    uint16_t m_DiscardedChars;      // Characters seen while looking for a start of frame.
+    uint16_t m_FramingErrors;       // From the UART.
+    uint16_t m_OverrunErrors;       // From the UART.
+    uint16_t m_BufferOverflows;     // Receive ring was full.
+    uint16_t m_LastRxAge_ms;        // Time since the last good frame.
+} eFixLinkStats_t;
+
+// How close the transmit side has come to the eFix's 100 ms watchdog.
+typedef struct
+{
+    uint16_t m_KeepAlivesSent;      // No Command messages the timer interrupt had to send.
+    uint16_t m_NearMisses;          // Gaps between frames that were uncomfortably long.
+    uint16_t m_Misses;              // Gaps long enough for the eFix to fault.
+    uint8_t m_WorstGap_ms;          // Longest gap between frames.
+    uint8_t m_MinMargin_ms;         // Least time that was left before the watchdog.
+} eFixKeepAliveStats_t;
 
 void eFix_Communincation_Initialize(void);
 void RS232_TransmitChar (unsigned char item);
 void SetSpeedAndDirection (int speed, int direction);
+void eFix_LinkStatsGet (eFixLinkStats_t *stats);
+bool eFix_ReceivedMessageGet (uint8_t msgID, uint16_t *payload, uint16_t *age_ms);
+void eFix_KeepAliveTickIsr (void);
+void eFix_KeepAliveStatsGet (eFixKeepAliveStats_t *stats);
 
 
 #endif	/* EFIX_COMMUNICATION_H */
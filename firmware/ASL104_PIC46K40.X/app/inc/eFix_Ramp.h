@@ -0,0 +1,38 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: eFix_Ramp.h
+//
+// Description: Ramps the speed and steering sent to the eFix toward the demands.
+//
+// Author(s): G. Chopcinski (Kg Solutions, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef EFIX_RAMP_H
+#define EFIX_RAMP_H
+
+/* ******************************   Macros   ****************************** */
+
+// Ramp limits in eFix units (full scale is 1000) per second. Speed ramps up at
+// the acceleration rate and back toward neutral at the deceleration rate. Steering
+// turns in at the turn rate and returns to center at the turn return rate.
+#define EFIX_SPEED_ACCEL_PER_SEC (800)
+#define EFIX_SPEED_DECEL_PER_SEC (2000)
+#define EFIX_TURN_RATE_PER_SEC (1500)
+#define EFIX_TURN_RETURN_PER_SEC (3000)
+
+// Most the output can move in one update, when the ramp runs every period_ms.
+// Rounded up so the ramp is never slower than asked. Constant arguments make
+// this a compile time constant.
+#define EFIX_RAMP_STEP(per_sec, period_ms) ((int)((((long)(per_sec) * (period_ms)) + 999L) / 1000L))
+
+/* ***********************   Function Prototypes   ************************ */
+
+int eFix_RampToward (int output, int target, int accelStep, int decelStep);
+
+#endif // EFIX_RAMP_H
+
+// end of file.
+//-------------------------------------------------------------------------
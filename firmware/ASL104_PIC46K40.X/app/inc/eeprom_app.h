@@ -20,6 +20,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// from RTOS
+#include "cocoos.h"
+
 // from project
 #include "user_button.h"
 #include "head_array.h"
@@ -35,54 +38,99 @@
 // 4 = Original plus some stuff, supported by 1.6.x
 // 5 = Changed to support Minimum Drive Speed for all 3 pads.
 // 6 = [9/18/20] Added RNet Sleep feature and Mode Switch Schema feature.
-#define EEPROM_DATA_STRUCTURE_VERSION				((uint8_t)0x06)
+// 7 = Added user profiles. Each profile has its own pad settings, Active Profile picks one.
+#define EEPROM_DATA_STRUCTURE_VERSION				((uint8_t)0x07)
+
+/* ******************************   Macros   ****************************** */
+
+// Settings are kept in a log that alternates between this many pages.
+#define EEPROM_NUM_LOG_PAGES						((uint8_t)2)
+
+// Number of complete sets of pad settings. Only one is in use at a time.
+#define EEPROM_NUM_PROFILES							((uint8_t)4)
+
+/* ******************************   Schema   ****************************** */
+#ifdef ASL110
+
+// Every stored item, in the order it's laid out in EEPROM:
+//
+// 	EEPROM_ITEM(id, type, field, default_val, scope)
+//
+// 	id				EEPROM_STORED_ITEM_<id> in EepromItemId_t.
+// 	type			BOOL, ENUM, UINT8 or UINT16.
+// 	field			Its member of the RAM copy, EepromDataItems_t in eeprom_app.c.
+// 	default_val		What SetDefaultValues() gives it.
+// 	scope			GLOBAL if there's one of it, PROFILE if each profile has its own. Gets and
+// 					sets of a PROFILE item go to the active profile's.
+//
+// The ids, the layout, the type table and the defaults are all generated from this list, so
+// it's the only place an item has to be added. Items can only ever be appended, never moved
+// or removed. Older firmware kept them at fixed addresses in this same order.
+#define EEPROM_ITEM_LIST(EEPROM_ITEM) \
+	EEPROM_ITEM(EEPROM_INITIALIZED,					UINT8,	eeprom_intiailized,				EEPROM_INITIALIZED_VAL,				GLOBAL) \
+\
+	EEPROM_ITEM(LEFT_PAD_INPUT_TYPE,				ENUM,	left_pad_input_type,			HEAD_ARR_INPUT_PROPORTIONAL,		PROFILE) \
+	EEPROM_ITEM(RIGHT_PAD_INPUT_TYPE,				ENUM,	right_pad_input_type,			HEAD_ARR_INPUT_PROPORTIONAL,		PROFILE) \
+	EEPROM_ITEM(CTR_PAD_INPUT_TYPE,					ENUM,	center_pad_input_type,			HEAD_ARR_INPUT_PROPORTIONAL,		PROFILE) \
+\
+	EEPROM_ITEM(LEFT_PAD_OUTPUT_MAP,				ENUM,	left_pad_output_map,			HEAD_ARRAY_OUT_FUNC_LEFT,			PROFILE) \
+	EEPROM_ITEM(RIGHT_PAD_OUTPUT_MAP,				ENUM,	right_pad_output_map,			HEAD_ARRAY_OUT_FUNC_RIGHT,			PROFILE) \
+	EEPROM_ITEM(CTR_PAD_OUTPUT_MAP,					ENUM,	center_pad_output_map,			HEAD_ARRAY_OUT_FUNC_FWD,			PROFILE) \
+\
+	EEPROM_ITEM(USER_BTN_LONG_PRESS_ACT_TIME,		UINT16,	user_btn_long_press_act_time,	1000,								GLOBAL) \
+\
+	/* All features start off disabled. */ \
+	EEPROM_ITEM(ENABLED_FEATURES,					UINT8,	enabled_features,				0,									GLOBAL) \
+	EEPROM_ITEM(CURRENT_ACTIVE_FEATURE,				ENUM,	current_active_feature,			FUNC_FEATURE_POWER_ON_OFF,			GLOBAL) \
+\
+	EEPROM_ITEM(LEFT_PAD_MIN_ADC_VAL,				UINT16,	left_pad_min_adc_val,			ADC_LEFT_PAD_MIN_VAL,				GLOBAL) \
+	EEPROM_ITEM(LEFT_PAD_MAX_ADC_VAL,				UINT16,	left_pad_max_adc_val,			ADC_LEFT_PAD_MAX_VAL,				GLOBAL) \
+	EEPROM_ITEM(LEFT_PAD_MIN_THRESH_PERC,			UINT16,	left_pad_min_thresh_perc,		2,									PROFILE) \
+	EEPROM_ITEM(LEFT_PAD_MAX_THRESH_PERC,			UINT16,	left_pad_max_thresh_perc,		30,									PROFILE) \
+\
+	EEPROM_ITEM(RIGHT_PAD_MIN_ADC_VAL,				UINT16,	right_pad_min_adc_val,			ADC_RIGHT_PAD_MIN_VAL,				GLOBAL) \
+	EEPROM_ITEM(RIGHT_PAD_MAX_ADC_VAL,				UINT16,	right_pad_max_adc_val,			ADC_RIGHT_PAD_MAX_VAL,				GLOBAL) \
+	EEPROM_ITEM(RIGHT_PAD_MIN_THRESH_PERC,			UINT16,	right_pad_min_thresh_perc,		2,									PROFILE) \
+	EEPROM_ITEM(RIGHT_PAD_MAX_THRESH_PERC,			UINT16,	right_pad_max_thresh_perc,		30,									PROFILE) \
+\
+	EEPROM_ITEM(CTR_PAD_MIN_ADC_VAL,				UINT16,	ctr_pad_min_adc_val,			ADC_CTR_PAD_MIN_VAL,				GLOBAL) \
+	EEPROM_ITEM(CTR_PAD_MAX_ADC_VAL,				UINT16,	ctr_pad_max_adc_val,			ADC_CTR_PAD_MAX_VAL,				GLOBAL) \
+	EEPROM_ITEM(CTR_PAD_MIN_THRESH_PERC,			UINT16,	ctr_pad_min_thresh_perc,		2,									PROFILE) \
+	EEPROM_ITEM(CTR_PAD_MAX_THRESH_PERC,			UINT16,	ctr_pad_max_thresh_perc,		30,									PROFILE) \
+\
+	/* Added in EEPROM version 2. The DAC counts aren't used. */ \
+	EEPROM_ITEM(MM_NEUTRAL_DAC_COUNTS,				UINT16,	neutral_DAC_counts,				EEPROM_NEUTRAL_DAC_COUNTS_DEFAULT,	GLOBAL) \
+	EEPROM_ITEM(MM_NEUTRAL_DAC_SETTING,				UINT16,	neutral_DAC_setting,			EEPROM_NEUTRAL_DAC_SETTING_DEFAULT,	GLOBAL) \
+	EEPROM_ITEM(MM_NEUTRAL_DAC_RANGE,				UINT16,	neutral_DAC_range,				410,								GLOBAL) \
+\
+	/* Added in EEPROM version 3. Identifies the version/makeup of the stored data. */ \
+	EEPROM_ITEM(MM_EEPROM_VERSION,					UINT8,	EEPROM_Version,					EEPROM_DATA_STRUCTURE_VERSION,		GLOBAL) \
+\
+	/* Added in EEPROM version 4 as the one drive offset, became the center pad's in version 5. */ \
+	/* The drive percentage when in proportional and the digital sensor is active. */ \
+	EEPROM_ITEM(MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET,	UINT8,	CenterPad_MinimumDriveSpeed,	20,									PROFILE) \
+\
+	/* Added in EEPROM version 5. */ \
+	EEPROM_ITEM(MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET,	UINT8,	LeftPad_MinimumDriveSpeed,		20,									PROFILE) \
+	EEPROM_ITEM(MM_RIGHT_PAD_MINIMUM_DRIVE_OFFSET,	UINT8,	RightPad_MinimumDriveSpeed,		20,									PROFILE) \
+\
+	/* Added in EEPROM version 6. RNet Sleep and Mode Switch Schema, all disabled. */ \
+	EEPROM_ITEM(ENABLED_FEATURES_2,					UINT8,	enabled_features2,				0,									GLOBAL) \
+\
+	/* Added in EEPROM version 7. Which of the profiles is in use. */ \
+	EEPROM_ITEM(ACTIVE_PROFILE,						UINT8,	active_profile,					0,									GLOBAL)
+
+#endif // #ifdef ASL110
 
 /* ******************************   Types   ******************************* */
 #ifdef ASL110
 
 typedef enum
 {
-	EEPROM_STORED_ITEM_EEPROM_INITIALIZED,
-
-	EEPROM_STORED_ITEM_LEFT_PAD_INPUT_TYPE,
-	EEPROM_STORED_ITEM_RIGHT_PAD_INPUT_TYPE,
-	EEPROM_STORED_ITEM_CTR_PAD_INPUT_TYPE,
-
-	EEPROM_STORED_ITEM_LEFT_PAD_OUTPUT_MAP,
-	EEPROM_STORED_ITEM_RIGHT_PAD_OUTPUT_MAP,
-	EEPROM_STORED_ITEM_CTR_PAD_OUTPUT_MAP,
-
-	EEPROM_STORED_ITEM_USER_BTN_LONG_PRESS_ACT_TIME,
-
-	EEPROM_STORED_ITEM_ENABLED_FEATURES,
-	EEPROM_STORED_ITEM_CURRENT_ACTIVE_FEATURE,
-	
-	EEPROM_STORED_ITEM_LEFT_PAD_MIN_ADC_VAL,
-	EEPROM_STORED_ITEM_LEFT_PAD_MAX_ADC_VAL,
-	EEPROM_STORED_ITEM_LEFT_PAD_MIN_THRESH_PERC,
-	EEPROM_STORED_ITEM_LEFT_PAD_MAX_THRESH_PERC,
-	
-	EEPROM_STORED_ITEM_RIGHT_PAD_MIN_ADC_VAL,
-	EEPROM_STORED_ITEM_RIGHT_PAD_MAX_ADC_VAL,
-	EEPROM_STORED_ITEM_RIGHT_PAD_MIN_THRESH_PERC,
-	EEPROM_STORED_ITEM_RIGHT_PAD_MAX_THRESH_PERC,
-	
-	EEPROM_STORED_ITEM_CTR_PAD_MIN_ADC_VAL,
-	EEPROM_STORED_ITEM_CTR_PAD_MAX_ADC_VAL,
-	EEPROM_STORED_ITEM_CTR_PAD_MIN_THRESH_PERC,
-	EEPROM_STORED_ITEM_CTR_PAD_MAX_THRESH_PERC,
-	
-    EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_COUNTS,
-    EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_SETTING,
-    EEPROM_STORED_ITEM_MM_NEUTRAL_DAC_RANGE,
-
-    EEPROM_STORED_ITEM_MM_EEPROM_VERSION,
-
-    EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET,
-    EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET,
-    EEPROM_STORED_ITEM_MM_RIGHT_PAD_MINIMUM_DRIVE_OFFSET,
-            
-    EEPROM_STORED_ITEM_ENABLED_FEATURES_2,
+#define EEPROM_ITEM_ID(id, type, field, default_val, scope)	EEPROM_STORED_ITEM_##id,
+	EEPROM_ITEM_LIST(EEPROM_ITEM_ID)
+#undef EEPROM_ITEM_ID
+
 	// Nothing else may be defined past this point!
 	EEPROM_STORED_ITEM_EOL
 } EepromItemId_t;
@@ -97,6 +145,13 @@ typedef uint8_t EepromStoredEnumType_t;
 bool eepromAppInit(void);
 void SetDefaultValues(void);
 void eepromFlush(bool force_save_all);
+bool eepromFlushBusy(void);
+Evt_t eepromFlushDoneEventGet(void);
+bool eepromFlushNeeded(void);
+uint32_t eepromLogPageWritesGet(uint8_t page);
+
+uint8_t eepromProfileActiveGet(void);
+bool eepromProfileSelect(uint8_t profile);
 uint8_t eepromAppNumTimesAnyDataHasBeenUpdated(void);
 
 void eepromBoolSet(EepromItemId_t item_id, bool val);
@@ -111,6 +166,10 @@ uint8_t eeprom8bitGet(EepromItemId_t item_id);
 void eeprom16bitSet(EepromItemId_t item_id, uint16_t val);
 uint16_t eeprom16bitGet(EepromItemId_t item_id);
 
+uint8_t eepromItemSizeGet(EepromItemId_t item_id);
+void eepromItemSet(EepromItemId_t item_id, uint16_t val);
+uint16_t eepromItemGet(EepromItemId_t item_id);
+
 #endif // #ifdef ASL110
 
 #endif // EEPROM_APP_H
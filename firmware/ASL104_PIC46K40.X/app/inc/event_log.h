@@ -0,0 +1,68 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: event_log.h
+//
+// Description: Keeps a record of faults and other notable events in EEPROM, so there's
+//		something to look at when a unit misbehaves in the field.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+/* ***************************    Includes     **************************** */
+
+// from stdlib
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ******************************   Macros   ****************************** */
+
+// Where the log lives. Straight after the settings, see eeprom_app.c, to the end of EEPROM.
+#define EVENT_LOG_EEPROM_ADDR			((uint16_t)0x2C8)
+#define EVENT_LOG_EEPROM_END			((uint16_t)0x400)
+
+/* ******************************   Types   ******************************* */
+
+// Codes are kept in EEPROM and read back by the HHP. Only ever add to the end.
+typedef enum
+{
+	EVENT_LOG_NONE = 0,
+	EVENT_LOG_POWER_UP,					// data: 0
+	EVENT_LOG_ASSERT,					// data: line number
+	EVENT_LOG_EFIX_LINK_MISS,			// data: gap between frames, ms
+	EVENT_LOG_OUT_OF_NEUTRAL_AT_POWER_UP,	// data: 0
+	EVENT_LOG_DROPPED,					// data: events lost because they came in too fast
+	EVENT_LOG_FLASH_CRC_MISMATCH,		// data: CRC program memory came to
+	EVENT_LOG_FLASH_SCAN_TIME,			// data: ms from power up to the first flash check being done
+	EVENT_LOG_FLASH_SCAN_TIMEOUT,		// data: ms the first flash check had run before Burst mode
+
+	// Nothing else may be defined past this point!
+	EVENT_LOG_EOL
+} EventLogCode_t;
+
+typedef struct
+{
+	uint32_t uptime_ms;
+	uint8_t code;
+	uint16_t data;
+} EventLogEntry_t;
+
+/* ***********************   Function Prototypes   ************************ */
+
+void eventLogInit(void);
+void eventLogAdd(EventLogCode_t code, uint16_t data);
+void eventLogFlush(void);
+uint8_t eventLogReadStart(void);
+bool eventLogReadReady(void);
+bool eventLogReadEntry(uint8_t index, EventLogEntry_t *entry);
+void eventLogReadEnd(void);
+
+#endif // EVENT_LOG_H
+
+// end of file.
+//-------------------------------------------------------------------------
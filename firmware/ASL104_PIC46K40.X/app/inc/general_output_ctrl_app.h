@@ -64,8 +64,9 @@
 // 12/12/20 GChop. For now i'm removing the General Output Control because
 // of inconsistent behaviour.
 bool GenOutCtrlApp_Init(void);
-//void GenOutCtrlApp_SetStateAll(GenOutState_t ctrlr_state);
-//void GenOutCtrlApp_SetState(GenOutCtrlId_t item_id, GenOutState_t ctrlr_state);
+//bool GenOutCtrlApp_SetStateAll(GenOutState_t ctrlr_state);
+//bool GenOutCtrlApp_SetState(GenOutCtrlId_t item_id, GenOutState_t ctrlr_state);
+//uint8_t GenOutCtrlApp_NumDroppedRequestsGet(void);
 //bool genOutCtrlAppNeedSendEvent(void);
 //Evt_t genOutCtrlAppWakeEvent(void);
 
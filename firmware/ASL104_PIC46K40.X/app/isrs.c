@@ -25,6 +25,14 @@
 // from project
 #include "test_gpio.h"
 #include "stopwatch.h"
+#include "user_button_bsp.h"
+#include "bt_status.h"
+#include "RS232.h"
+#include "ha_hhp_interface_bsp.h"
+#include "eeprom_bsp.h"
+#ifdef EFIX
+#include "inc/eFix_Communication.h"
+#endif
 
 static uint32_t num_os_ticks_to_process = 0;
 static bool can_process_os_ticks = true;
@@ -76,6 +84,9 @@ __interrupt(low_priority) void lowPrioIsr(void)
         PIR4bits.TMR2IF = 0;
         
 		stopwatchTick();
+#ifdef EFIX
+		eFix_KeepAliveTickIsr();
+#endif
 		num_os_ticks_to_process++;
 		
 		// This tick takes ~240 us. Which, when doing certain time critical operations may not be acceptable.
@@ -87,11 +98,20 @@ __interrupt(low_priority) void lowPrioIsr(void)
 			num_os_ticks_to_process = 0;
 		}
     }
+
+    // Bluetooth module status LED changed state.
+    if (PIR0bits.IOCIF && BT_LED_EdgeDetected())
+    {
+        btStatusEdgeIsr();
+    }
 #else
     if (PIR1bits.TMR2IF)
     {
         PIR1bits.TMR2IF = 0;
 		stopwatchTick();
+#ifdef EFIX
+		eFix_KeepAliveTickIsr();
+#endif
 		num_os_ticks_to_process++;
 		
 		// This tick takes ~240 us. Which, when doing certain time critical operations may not be acceptable.
@@ -103,6 +123,15 @@ __interrupt(low_priority) void lowPrioIsr(void)
 		}
     }
 #endif
+
+    // eFix serial link.
+    RS232_Isr();
+
+    // HHP link.
+    haHhpBsp_Isr();
+
+    // EEPROM byte written, start the next.
+    eepromBspIsr();
 }
 
 // end of file.
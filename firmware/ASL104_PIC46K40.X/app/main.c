@@ -29,9 +29,12 @@
 #include "bsp.h"
 #include "test_gpio.h"
 #include "eeprom_app.h"
+#include "eeprom_bsp.h"
+#include "event_log.h"
 #include "head_array.h"
 #include "beeper.h"
 #include "user_button.h"
+#include "bt_status.h"
 //#include "general_output_ctrl_app.h"
 #include "general_output_ctrl_bsp.h"
 #include "ha_hhp_interface_app.h"
@@ -80,9 +83,13 @@ int main(void)
 	// Other high level modules depend on EEPROM being initialized, therefore it must be initialized here.
 #ifdef ASL110
 	bool eeprom_initialized_before = eepromAppInit();
+#else
+	eepromBspInit();
 #endif 
+	eventLogInit();
 	beeperInit();
 	userButtonInit();
+	btStatusInit();         // Needs the BT LED input set up by userButtonInit()
 	headArrayinit();
     
     //eFix_Communincation_Initialize();
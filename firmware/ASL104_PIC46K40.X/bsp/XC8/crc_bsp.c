@@ -0,0 +1,271 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: crc_bsp.c
+//
+// Description: CRC-16 calculation using the PIC18F46K40's CRC module.
+//
+//	The CRC is CRC-16/XMODEM: polynomial 0x1021, seed 0, MSb first. Parts without the CRC
+//	module work it out in software, with the same result.
+//
+//	The CRC module's memory scanner also checks program memory in the background. It only
+//	reads flash on cycles the CPU isn't using it (Peek mode), so code runs at full speed. How
+//	long that takes depends on the code that's running, so a scan can also be run in Burst
+//	mode, which stalls the CPU until it's done. The build stores the expected CRC at CRC_FLASH_CRC_ADDR, see the linker checksum option in
+//	nbproject/configurations.xml, which has to cover the same range:
+//
+//		0-FFFD@FFFE,width=-2,algorithm=5,polynomial=0x1021,offset=0,revword=2
+//
+//	The scanner feeds whole words, high byte first, hence revword. Flash the build doesn't use
+//	reads back 0xFF, and the project's fill options fill it with 0xFF so the checksum sees the
+//	same. tools/flash_crc_check works both CRCs out from a built .hex and checks they match.
+//	crcBspCalc16() needs the module too, so it aborts a scan that's under way. The caller
+//	starts it again later.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/* **************************   Header Files   *************************** */
+
+// NOTE: This must ALWAYS be the first include in a file.
+#include "device.h"
+
+// from stdlib
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_assert.h"
+
+// from local
+#include "crc_bsp.h"
+
+/* ******************************   Macros   ****************************** */
+
+#define CRC_POLYNOMIAL			((uint16_t)0x1021)
+#define CRC_SEED				((uint16_t)0x0000)
+
+// Program memory checked by the scanner, up to the CRC the build puts at the very end.
+#define CRC_FLASH_START_ADDR	((uint32_t)0x000000)
+#define CRC_FLASH_CRC_ADDR		((uint32_t)0x00FFFE)
+#define CRC_FLASH_END_ADDR		(CRC_FLASH_CRC_ADDR - 2)	// Last word scanned.
+
+// SCANCON0 MODE. Peek only reads flash when the CPU isn't, Burst stalls the CPU until done.
+#define CRC_SCAN_MODE_PEEK		(0b10)
+#define CRC_SCAN_MODE_BURST		(0b01)
+
+/* ***********************   File Scope Variables   *********************** */
+
+static bool flash_scan_running = false;
+
+/* ***********************   Function Prototypes   ************************ */
+
+static void FlashScanAbort(void);
+
+/* *******************   Public Function Definitions   ******************** */
+
+//-------------------------------
+// Function: crcBspCalc16
+//
+// Description: Calculates the CRC of a buffer. Blocks until done, which is only a few
+//		instruction cycles per byte.
+//
+//-------------------------------
+uint16_t crcBspCalc16(const uint8_t *data, uint8_t len)
+{
+	ASSERT(data != 0);
+
+#ifdef _18F46K40
+	FlashScanAbort();
+
+	CRCCON0bits.EN = 1;
+	CRCCON0bits.CRCGO = 0;
+	CRCCON0bits.ACCM = 1;		// Augment with zeros, so CRCACC ends up holding the CRC.
+	CRCCON0bits.SHIFTM = 0;		// MSb first.
+	CRCCON1bits.DLEN = 8 - 1;	// Byte wide data.
+	CRCCON1bits.PLEN = 16 - 1;	// 16-bit polynomial.
+	CRCXORH = (uint8_t)(CRC_POLYNOMIAL >> 8);
+	CRCXORL = (uint8_t)CRC_POLYNOMIAL;
+	CRCACCH = (uint8_t)(CRC_SEED >> 8);
+	CRCACCL = (uint8_t)CRC_SEED;
+	CRCCON0bits.CRCGO = 1;
+
+	for (uint8_t i = 0; i < len; i++)
+	{
+		while (CRCCON0bits.FULL)
+		{
+			(void)0;
+		}
+		CRCDATL = data[i];
+	}
+
+	while (CRCCON0bits.BUSY)
+	{
+		(void)0;
+	}
+	CRCCON0bits.CRCGO = 0;
+
+	return ((uint16_t)CRCACCH << 8) | CRCACCL;
+#else
+	uint16_t crc = CRC_SEED;
+
+	for (uint8_t i = 0; i < len; i++)
+	{
+		crc ^= (uint16_t)data[i] << 8;
+
+		for (uint8_t bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x8000) ? ((crc << 1) ^ CRC_POLYNOMIAL) : (crc << 1);
+		}
+	}
+
+	return crc;
+#endif
+}
+
+//-------------------------------
+// Function: crcBspFlashScanAvailable
+//
+// Description: Lets the caller know whether this part can check program memory at all.
+//
+//-------------------------------
+bool crcBspFlashScanAvailable(void)
+{
+#ifdef _18F46K40
+	return true;
+#else
+	return false;
+#endif
+}
+
+//-------------------------------
+// Function: crcBspFlashScanStart
+//
+// Description: Starts a CRC of program memory. Check on it with crcBspFlashScanStatus().
+//
+//		burst: false to scan in the background. true to stall the CPU, interrupts and all,
+//			until the scan is done. Only for when nothing else can wait any longer.
+//
+//-------------------------------
+void crcBspFlashScanStart(bool burst)
+{
+#ifdef _18F46K40
+	FlashScanAbort();
+
+	// Both modules are on out of reset and nothing turns them off, but the check can never pass
+	// if they are. The scanner also needs SCANE on in the configuration bits, see device_xc8.h.
+	PMD0bits.CRCMD = 0;
+	PMD0bits.SCANMD = 0;
+
+	CRCCON0bits.EN = 1;
+	CRCCON0bits.CRCGO = 0;
+	CRCCON0bits.ACCM = 1;		// Augment with zeros, so CRCACC ends up holding the CRC.
+	CRCCON0bits.SHIFTM = 0;		// MSb first.
+	CRCCON1bits.DLEN = 16 - 1;	// Program memory words.
+	CRCCON1bits.PLEN = 16 - 1;	// 16-bit polynomial.
+	CRCXORH = (uint8_t)(CRC_POLYNOMIAL >> 8);
+	CRCXORL = (uint8_t)CRC_POLYNOMIAL;
+	CRCACCH = (uint8_t)(CRC_SEED >> 8);
+	CRCACCL = (uint8_t)CRC_SEED;
+
+	SCANCON0bits.EN = 1;
+	SCANCON0bits.MODE = burst ? CRC_SCAN_MODE_BURST : CRC_SCAN_MODE_PEEK;
+	SCANLADRU = (uint8_t)(CRC_FLASH_START_ADDR >> 16);
+	SCANLADRH = (uint8_t)(CRC_FLASH_START_ADDR >> 8);
+	SCANLADRL = (uint8_t)CRC_FLASH_START_ADDR;
+	SCANHADRU = (uint8_t)(CRC_FLASH_END_ADDR >> 16);
+	SCANHADRH = (uint8_t)(CRC_FLASH_END_ADDR >> 8);
+	SCANHADRL = (uint8_t)CRC_FLASH_END_ADDR;
+
+	CRCCON0bits.CRCGO = 1;
+	flash_scan_running = true;
+	SCANCON0bits.GO = 1;
+#else
+	(void)burst;
+#endif
+}
+
+//-------------------------------
+// Function: crcBspFlashScanStatus
+//
+// Description: Checks on the scan started by crcBspFlashScanStart(). Once it's done, crc is
+//		set and the scan is over.
+//
+// return: CRC_BSP_SCAN_IDLE if there's no scan under way, e.g. crcBspCalc16() aborted it.
+//		Always the case on parts without the scanner, see crcBspFlashScanAvailable().
+//
+//-------------------------------
+CrcBspScanStatus_t crcBspFlashScanStatus(uint16_t *crc)
+{
+#ifdef _18F46K40
+	if (!flash_scan_running)
+	{
+		return CRC_BSP_SCAN_IDLE;
+	}
+
+	// The scanner clears GO once it has read the last word.
+	if (SCANCON0bits.GO || CRCCON0bits.BUSY)
+	{
+		return CRC_BSP_SCAN_BUSY;
+	}
+
+	*crc = ((uint16_t)CRCACCH << 8) | CRCACCL;
+	FlashScanAbort();
+	return CRC_BSP_SCAN_DONE;
+#else
+	(void)crc;
+	return CRC_BSP_SCAN_IDLE;
+#endif
+}
+
+//-------------------------------
+// Function: crcBspFlashCrcExpected
+//
+// Description: Reads the CRC of program memory the build stored at CRC_FLASH_CRC_ADDR.
+//
+//-------------------------------
+uint16_t crcBspFlashCrcExpected(void)
+{
+	uint16_t crc;
+
+	TBLPTRU = (uint8_t)(CRC_FLASH_CRC_ADDR >> 16);
+	TBLPTRH = (uint8_t)(CRC_FLASH_CRC_ADDR >> 8);
+	TBLPTRL = (uint8_t)CRC_FLASH_CRC_ADDR;
+	asm("TBLRD*+");
+	crc = TABLAT;
+	asm("TBLRD*+");
+	crc |= (uint16_t)TABLAT << 8;
+
+	return crc;
+}
+
+/* ********************   Private Function Definitions   ****************** */
+
+//-------------------------------
+// Function: FlashScanAbort
+//
+// Description: Stops the scanner, if it's running, and hands the CRC module back.
+//
+//-------------------------------
+static void FlashScanAbort(void)
+{
+#ifdef _18F46K40
+	if (!flash_scan_running)
+	{
+		return;
+	}
+
+	SCANCON0bits.GO = 0;
+	while (SCANCON0bits.BUSY)
+	{
+		(void)0;
+	}
+	SCANCON0bits.EN = 0;
+	CRCCON0bits.CRCGO = 0;
+
+	flash_scan_running = false;
+#endif
+}
+
+// end of file.
+//-------------------------------------------------------------------------
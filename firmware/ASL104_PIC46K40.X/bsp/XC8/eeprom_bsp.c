@@ -4,6 +4,9 @@
 //
 // Description: Control driver for the PIC18F4550's internal EEPROM
 //
+//	Writes are queued. Each byte takes ~4 ms to program, so rather than spin on it the next
+//	byte is started from the write complete interrupt, see eepromBspIsr().
+//
 // Author(s): Trevor Parsh (Embedded Wizardry, LLC)
 //
 // Modified for ASL on Date:
@@ -19,6 +22,7 @@
 // from stdlib
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "user_assert.h"
 
 // from project
@@ -30,16 +34,61 @@
 
 /* ******************************   Macros   ****************************** */
 
-// TODO: The size of 46K40 EEPROM is 1024. However, this driver only supports 1-byte
-// TODO: addressing.
-#define EEPROM_SIZE_OF_EEPROM ((uint16_t)256)
+#ifdef _18F46K40
+	#define EEPROM_SIZE_OF_EEPROM ((uint16_t)1024)
+#else
+	#define EEPROM_SIZE_OF_EEPROM ((uint16_t)256)
+#endif
+
+// Bytes waiting to be written. Enough for a whole settings page and a few records.
+#define EEPROM_WRITE_QUEUE_LEN ((uint8_t)192)
+
+// Number of separate eepromBspWriteBuffer() calls that can be waiting.
+#define EEPROM_WRITE_SEGMENTS ((uint8_t)8)
+
+// Write complete interrupt.
+#ifdef _18F46K40
+	#define EEPROM_WRITE_DONE_IF	PIR7bits.NVMIF
+	#define EEPROM_WRITE_DONE_IE	PIE7bits.NVMIE
+	#define EEPROM_WRITE_DONE_IP	IPR7bits.NVMIP
+#else
+	#define EEPROM_WRITE_DONE_IF	PIR2bits.EEIF
+	#define EEPROM_WRITE_DONE_IE	PIE2bits.EEIE
+	#define EEPROM_WRITE_DONE_IP	IPR2bits.EEIP
+#endif
+
+/* ******************************   Types   ******************************* */
+
+// A run of bytes to be written to consecutive addresses. The bytes are in write_queue.
+typedef struct
+{
+	uint16_t address;
+	uint8_t len;
+} EepromWriteSegment_t;
+
+/* ***********************   File Scope Variables   *********************** */
+
+// Heads are only moved by the task, tails only by the interrupt.
+static uint8_t write_queue[EEPROM_WRITE_QUEUE_LEN];
+static volatile uint8_t write_queue_head;	// Next free byte.
+static volatile uint8_t write_queue_tail;	// Byte being written.
+
+static EepromWriteSegment_t write_segments[EEPROM_WRITE_SEGMENTS];
+static volatile uint8_t write_segment_head;
+static volatile uint8_t write_segment_tail;	// Segment being written.
+static volatile uint8_t write_segment_done;	// Bytes of it that are done.
+
+static volatile bool write_in_progress;
+
+static EepromBspCallback_t write_done_callback = NULL;
 
 /* ***********************   Function Prototypes   ************************ */
 
-static bool writeBuffer(uint8_t start_address, uint8_t num_bytes_to_write, uint8_t *data, uint16_t timeout_ms);
-static void writeByte(uint8_t address, uint8_t data);
-static bool waitForEepromToBeWritable(uint16_t timeout_ms);
-static void readIntoBuffer(uint8_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer);
+static bool writeBuffer(uint16_t start_address, uint8_t num_bytes_to_write, const uint8_t *data, uint16_t timeout_ms);
+static uint8_t writeQueueFree(void);
+static void writeNextByte(void);
+static void writeByte(uint16_t address, uint8_t data);
+static void readIntoBuffer(uint16_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer);
 
 /* *******************   Public Function Definitions   ******************** */
 
@@ -51,12 +100,21 @@ static void readIntoBuffer(uint8_t start_address, uint8_t num_bytes_to_read, uin
 //-------------------------------
 void eepromBspInit(void)
 {
-	(void)0;
+	write_queue_head = 0;
+	write_queue_tail = 0;
+	write_segment_head = 0;
+	write_segment_tail = 0;
+	write_segment_done = 0;
+	write_in_progress = false;
+
+	EEPROM_WRITE_DONE_IF = 0;
+	EEPROM_WRITE_DONE_IP = 0;	// Low priority, serviced from lowPrioIsr
+	EEPROM_WRITE_DONE_IE = 1;
     
 #ifdef TEST_BASIC_EEPROM_CONTROL
     static uint8_t read_bytes[6] = {0};
-    eepromBspWriteByte(0, 0xAA, 1);
-    (void)eepromBspReadSection(0, 1, read_bytes, 1);
+    eepromBspWriteByte(0x3FF, 0xAA, 1);
+    (void)eepromBspReadSection(0x3FF, 1, read_bytes, 1);
     
     uint8_t write_buff[4] = {1,2,3,4};
     eepromBspWriteBuffer(0, 4, write_buff, 4);
@@ -68,12 +126,14 @@ void eepromBspInit(void)
 //-------------------------------
 // Function: eepromBspWriteByte
 //
-// Description: Writes a single byte to the internal EEPROM
+// Description: Queues a single byte to be written to the internal EEPROM
+//
+// timeout_ms: Not used, the write is queued rather than waited for.
 //
-// timeout_ms: Time to wait before giving up on waiting for EEPROM write access to be available.
+// return: false if the queue is full, nothing is written in that case.
 //
 //-------------------------------
-bool eepromBspWriteByte(uint8_t address, uint8_t byte_to_write, uint16_t timeout_ms)
+bool eepromBspWriteByte(uint16_t address, uint8_t byte_to_write, uint16_t timeout_ms)
 {
 	UNUSED(timeout_ms);
 
@@ -85,14 +145,17 @@ bool eepromBspWriteByte(uint8_t address, uint8_t byte_to_write, uint16_t timeout
 //-------------------------------
 // Function: eepromBspWriteBuffer
 //
-// Description: Writes an entire buffer to the internal EEPROM
+// Description: Queues an entire buffer to be written to the internal EEPROM. The data is copied,
+//		so the buffer may be reused as soon as this returns.
 //
-// timeout_ms: Time to wait before giving up on waiting for EEPROM write access to be available.
+// timeout_ms: Not used, the write is queued rather than waited for.
+//
+// return: false if the queue doesn't have room for the whole buffer, nothing is written in that case.
 //
 //-------------------------------
-bool eepromBspWriteBuffer(uint8_t start_address, uint8_t num_bytes_to_write, uint8_t *data, uint16_t timeout_ms)
+bool eepromBspWriteBuffer(uint16_t start_address, uint8_t num_bytes_to_write, const uint8_t *data, uint16_t timeout_ms)
 {
-	ASSERT(((uint16_t)start_address + (uint16_t)num_bytes_to_write) < (uint16_t)EEPROM_SIZE_OF_EEPROM);
+	ASSERT((start_address + (uint16_t)num_bytes_to_write) <= (uint16_t)EEPROM_SIZE_OF_EEPROM);
 	ASSERT(data != NULL);
 
 	UNUSED(timeout_ms);
@@ -110,14 +173,19 @@ bool eepromBspWriteBuffer(uint8_t start_address, uint8_t num_bytes_to_write, uin
 // buffer: Buffer that stores data read from the EEPROM.
 // timeout_ms: Time to wait before giving up on waiting for EEPROM read access to be available.
 //
+// NOTE: Waits for any queued writes to finish first, which needs interrupts to be running.
+//		That's ~4 ms a byte, most of a second after a settings compaction, so readers running
+//		in a task should only read when eepromBspWriteBusy() is false and try again later.
+//
 //-------------------------------
-bool eepromBspReadSection(uint8_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer, uint16_t timeout_ms)
+bool eepromBspReadSection(uint16_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer, uint16_t timeout_ms)
 {
-	ASSERT(((uint16_t)start_address + (uint16_t)num_bytes_to_read) < (uint16_t)EEPROM_SIZE_OF_EEPROM);
+	ASSERT((start_address + (uint16_t)num_bytes_to_read) <= (uint16_t)EEPROM_SIZE_OF_EEPROM);
 	ASSERT(buffer != NULL);
 
 	UNUSED(timeout_ms);
 
+	eepromBspWriteWait();
 	readIntoBuffer(start_address, num_bytes_to_read, buffer);
 
 	return true;
@@ -134,35 +202,179 @@ uint16_t eepromBspSizeOfEeprom(void)
     return (uint16_t)EEPROM_SIZE_OF_EEPROM;
 }
 
+//-------------------------------
+// Function: eepromBspWriteBusy
+//
+// Description: Lets the caller know if there are still bytes queued or being written.
+//
+//-------------------------------
+bool eepromBspWriteBusy(void)
+{
+	return write_in_progress;
+}
+
+//-------------------------------
+// Function: eepromBspWriteRoom
+//
+// Description: Lets the caller know if num_writes calls to eepromBspWriteBuffer() totalling
+//		num_bytes would all be queued. For callers whose writes only make sense together.
+//
+//-------------------------------
+bool eepromBspWriteRoom(uint8_t num_writes, uint8_t num_bytes)
+{
+	uint8_t free_segments = (uint8_t)(((uint16_t)write_segment_tail + EEPROM_WRITE_SEGMENTS - write_segment_head - 1) % EEPROM_WRITE_SEGMENTS);
+
+	return (writeQueueFree() >= num_bytes) && (free_segments >= num_writes);
+}
+
+//-------------------------------
+// Function: eepromBspWriteWait
+//
+// Description: Waits for the write queue to empty. Reading while a byte is being programmed
+//		doesn't work.
+//
+//-------------------------------
+void eepromBspWriteWait(void)
+{
+	// TODO: Add timeout and feedback on failure.
+	while (write_in_progress)
+	{
+		// Before the OS starts nothing will service the interrupt, so do it here.
+		if (!(INTCONbits.GIEH && INTCONbits.GIEL))
+		{
+			eepromBspIsr();
+		}
+	}
+}
+
+//-------------------------------
+// Function: eepromBspWriteDoneCallbackSet
+//
+// Description: Sets a function to be called from interrupt context when the last queued byte
+//		has been written. Pass NULL to remove it.
+//
+//-------------------------------
+void eepromBspWriteDoneCallbackSet(EepromBspCallback_t callback)
+{
+	write_done_callback = callback;
+}
+
+//-------------------------------
+// Function: eepromBspIsr
+//
+// Description: Starts the next queued byte once the last one is written. Call from lowPrioIsr.
+//
+//-------------------------------
+void eepromBspIsr(void)
+{
+	if (!(EEPROM_WRITE_DONE_IE && EEPROM_WRITE_DONE_IF))
+	{
+		return;
+	}
+	EEPROM_WRITE_DONE_IF = 0;
+
+	write_queue_tail = (write_queue_tail + 1) % EEPROM_WRITE_QUEUE_LEN;
+
+	if (++write_segment_done >= write_segments[write_segment_tail].len)
+	{
+		write_segment_tail = (write_segment_tail + 1) % EEPROM_WRITE_SEGMENTS;
+		write_segment_done = 0;
+	}
+
+	if (write_segment_tail != write_segment_head)
+	{
+		writeNextByte();
+	}
+	else
+	{
+		write_in_progress = false;
+
+		if (write_done_callback != NULL)
+		{
+			write_done_callback();
+		}
+	}
+}
+
 /* ********************   Private Function Definitions   ****************** */
 
 //-------------------------------
 // Function: writeBuffer
 //
-// Description: Writes a buffer full of data to the internal EEPROM.
+// Description: Queues a buffer full of data to be written to the internal EEPROM, and starts
+//		writing if the EEPROM was idle.
 //
 // NOTE: Bounds checking is performed by the calling function.
 //
 //-------------------------------
-static bool writeBuffer(uint8_t start_address, uint8_t num_bytes_to_write, uint8_t *data, uint16_t timeout_ms)
+static bool writeBuffer(uint16_t start_address, uint8_t num_bytes_to_write, const uint8_t *data, uint16_t timeout_ms)
 {
 	UNUSED(timeout_ms);
 
-	bool no_timeout = true;
+	uint8_t head;
+	uint8_t next_segment;
+
+	if (num_bytes_to_write == 0)
+	{
+		return true;
+	}
+
+	// Keep the interrupt from finishing up the queue while it's being added to.
+	EEPROM_WRITE_DONE_IE = 0;
+
+	next_segment = (write_segment_head + 1) % EEPROM_WRITE_SEGMENTS;
+	if ((writeQueueFree() < num_bytes_to_write) || (next_segment == write_segment_tail))
+	{
+		EEPROM_WRITE_DONE_IE = 1;
+		return false;
+	}
 
+	head = write_queue_head;
 	for (uint8_t i = 0; i < num_bytes_to_write; i++)
 	{
-		no_timeout = waitForEepromToBeWritable(timeout_ms);
-		if (!no_timeout)
-		{
-			// EEPROM has been unable to be written to for too long, bounce.
-			break;
-		}
+		write_queue[head] = data[i];
+		head = (head + 1) % EEPROM_WRITE_QUEUE_LEN;
+	}
+	write_queue_head = head;
+
+	write_segments[write_segment_head].address = start_address;
+	write_segments[write_segment_head].len = num_bytes_to_write;
+	write_segment_head = next_segment;
 
-		writeByte(start_address + i, data[i]);
+	if (!write_in_progress)
+	{
+		write_in_progress = true;
+		writeNextByte();
 	}
 
-	return no_timeout;
+	EEPROM_WRITE_DONE_IE = 1;
+
+	return true;
+}
+
+//-------------------------------
+// Function: writeQueueFree
+//
+// Description: Number of bytes that can still be queued. One byte is always left empty so a
+//		full queue can be told apart from an empty one.
+//
+//-------------------------------
+static uint8_t writeQueueFree(void)
+{
+	uint8_t used = (uint8_t)(((uint16_t)write_queue_head + EEPROM_WRITE_QUEUE_LEN - write_queue_tail) % EEPROM_WRITE_QUEUE_LEN);
+
+	return (EEPROM_WRITE_QUEUE_LEN - 1) - used;
+}
+
+//-------------------------------
+// Function: writeNextByte
+//
+// Description: Starts writing the byte at the tail of the queue.
+//
+//-------------------------------
+static void writeNextByte(void)
+{
+	writeByte(write_segments[write_segment_tail].address + write_segment_done, write_queue[write_queue_tail]);
 }
 
 //-------------------------------
@@ -173,12 +385,12 @@ static bool writeBuffer(uint8_t start_address, uint8_t num_bytes_to_write, uint8
 // TODO: Dig more into this process and clean up code a bit more.
 //
 //-------------------------------
-static void writeByte(uint8_t address, uint8_t data)
+static void writeByte(uint16_t address, uint8_t data)
 {
 #ifdef _18F46K40
 	NVMCON1bits.NVMREG = 0;
-	NVMADRL = address;
-	NVMADRH = 0; // This application does not use that much EEPROM.
+	NVMADRL = (uint8_t)address;
+	NVMADRH = (uint8_t)(address >> 8);
 	NVMDAT = data;
 	NVMCON1bits.WREN = 1;
 
@@ -191,7 +403,7 @@ static void writeByte(uint8_t address, uint8_t data)
 	NVMCON1bits.WREN = 0;
 #else
 	// Set address and data registers accordingly.
-	EEADR = address;
+	EEADR = (uint8_t)address;
 	EEDATA = data;
 
 	// Point to data section of EEPROM and enable EEPROM writes
@@ -213,37 +425,6 @@ static void writeByte(uint8_t address, uint8_t data)
 }
 
 
-//-------------------------------
-// Function: waitForEepromToBeWritable
-//
-// Description: Waits for the internal EEPROM to be ready for a write.
-//
-// timeout_ms: Time to wait before giving up on waiting for EEPROM write access to be available.
-//
-//-------------------------------
-static bool waitForEepromToBeWritable(uint16_t timeout_ms)
-{
-	UNUSED(timeout_ms);
-
-#ifdef _18F46K40
-	// Make sure last attempt to write is complete
-	// TODO: Add timeout and feedback on failure.
-	while(NVMCON1bits.WR)
-	{
-		(void)0;
-	}
-#else
-	// Make sure last attempt to write is complete
-	// TODO: Add timeout and feedback on failure.
-	while(EECON1bits.WR)
-	{
-		(void)0;
-	}
-#endif
-
-	return true;
-}
-
 //-------------------------------
 // Function: readIntoBuffer
 //
@@ -252,14 +433,14 @@ static bool waitForEepromToBeWritable(uint16_t timeout_ms)
 // buffer: Buffer that stores data read from the EEPROM.
 //
 //-------------------------------
-static void readIntoBuffer(uint8_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer)
+static void readIntoBuffer(uint16_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer)
 {
 	for (uint8_t i = 0; i < num_bytes_to_read; i++)
 	{
 #ifdef _18F46K40
 		NVMCON1bits.NVMREG = 0;
-		NVMADRL = (start_address + i);
-		NVMADRH = 0; // This application does not use that much EEPROM.
+		NVMADRL = (uint8_t)(start_address + i);
+		NVMADRH = (uint8_t)((start_address + i) >> 8);
         
         NVMCON1bits.RD = 1;
         
@@ -48,6 +48,8 @@
 
 /********************************************** System *************************************************/
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <assert.h>
 /********************************************    User   ************************************************/
 #include "bsp.h"
@@ -125,27 +127,78 @@
 
 /*
  ********************************************************************************************************
- *                                         PUBLIC FUNCTIONS DEFINITIONS
+ *                                               DATA TYPES
  ********************************************************************************************************
  */
-void GenOutCtrlBsp_INIT(void)
+
+/// Where a general output lives and which level turns it on.
+typedef struct
+{
+    /// Output latch register of the port the output is on.
+    volatile uint8_t *lat;
+
+    /// Direction register of the port the output is on.
+    volatile uint8_t *tris;
+
+    /// Bit of the output in the port registers.
+    uint8_t mask;
+
+    /// Level, GPIO_HIGH or GPIO_LOW, that puts the output in its active state.
+    uint8_t active_level;
+} GenOutPinDef_t;
+
+/*
+ ********************************************************************************************************
+ *                                                VARIABLES
+ ********************************************************************************************************
+ */
+
+/**
+ * Pin mapping of every general output. This is the one place to change when a PCB revision moves a pin.
+ *
+ * @note MUST be in GenOutCtrlId_t order!
+ */
+static const GenOutPinDef_t pin_defs[GEN_OUT_CTRL_ID_MAX] =
 {
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_FORWARD_PAD_LED);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_LEFT_PAD_LED);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_RIGHT_PAD_LED);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_REVERSE_PAD_LED);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_POWER_LED);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_FORWARD_DEMAND);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_REVERSE_DEMAND);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_LEFT_DEMAND);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_RIGHT_DEMAND);
-    GenOutCtrlBsp_Enable (GEN_OUT_CTRL_ID_RESET_OUT);
+    { &LATE, &TRISE, 0x02, GPIO_LOW },      // GEN_OUT_CTRL_ID_FORWARD_PAD_LED, LED #5, E1
+    { &LATC, &TRISC, 0x01, GPIO_LOW },      // GEN_OUT_CTRL_ID_LEFT_PAD_LED, LED2, C0
+    { &LATE, &TRISE, 0x04, GPIO_LOW },      // GEN_OUT_CTRL_ID_RIGHT_PAD_LED, LED3, E2
+    { &LATA, &TRISA, 0x02, GPIO_LOW },      // GEN_OUT_CTRL_ID_REVERSE_PAD_LED, LED4, A1
+    { &LATE, &TRISE, 0x01, GPIO_LOW },      // GEN_OUT_CTRL_ID_POWER_LED, LED1, E0
+    { &LATA, &TRISA, 0x10, GPIO_HIGH },     // GEN_OUT_CTRL_ID_FORWARD_DEMAND, 9-pin connector, A4
+    { &LATD, &TRISD, 0x20, GPIO_HIGH },     // GEN_OUT_CTRL_ID_REVERSE_DEMAND, 9-pin connector, D5
+    { &LATD, &TRISD, 0x40, GPIO_HIGH },     // GEN_OUT_CTRL_ID_LEFT_DEMAND, 9-pin connector, D6
+    { &LATA, &TRISA, 0x04, GPIO_HIGH },     // GEN_OUT_CTRL_ID_RIGHT_DEMAND, 9-pin connector, A2
+    { &LATA, &TRISA, 0x08, GPIO_HIGH }      // GEN_OUT_CTRL_ID_RESET_OUT, 9-pin connector, A3
+};
+
+// The Bluetooth LED is being controlled by either enabling the port as an
+// output or as an input. This operation is being controlled elsewhere.
+// Rev 3 boards have it on C4, Rev 4 and later on A4. Either is active high.
+
+/*
+ ********************************************************************************************************
+ *                                       FILE LOCAL FUNCTIONS DECLARATIONS
+ ********************************************************************************************************
+ */
 
+static void PinWrite(const GenOutPinDef_t *pin, bool active);
 
+/*
+ ********************************************************************************************************
+ *                                         PUBLIC FUNCTIONS DEFINITIONS
+ ********************************************************************************************************
+ */
+void GenOutCtrlBsp_INIT(void)
+{
+    for (uint8_t i = 0; i < (uint8_t)GEN_OUT_CTRL_ID_MAX; i++)
+    {
+        (void)GenOutCtrlBsp_Enable((GenOutCtrlId_t)i);
+    }
 }
 
 /**
- * Sets up GPIO to control the general output control item.
+ * Sets up GPIO to control the general output control item. The output is left in its inactive state.
  *
  * @param item_id ID of the output control item that is to be modified
  *
@@ -153,83 +206,17 @@ void GenOutCtrlBsp_INIT(void)
  */
 bool GenOutCtrlBsp_Enable(GenOutCtrlId_t item_id)
 {
-	bool ret_val = true;
-
-	switch (item_id)
-	{
-        case GEN_OUT_CTRL_ID_POWER_LED:             // Power LED
-            TRISEbits.TRISE0 = GPIO_BIT_OUTPUT;     // LED1 control
-            LATEbits.LATE0 = GPIO_HIGH;             // This turns the LED off
-            break;
-            
-        case GEN_OUT_CTRL_ID_FORWARD_PAD_LED:       // Forward Pad Feedback LED
-            TRISEbits.TRISE1 = GPIO_BIT_OUTPUT;     // LED #5 control.
-            LATEbits.LATE1 = GPIO_HIGH;
-            break;
+    if (item_id >= GEN_OUT_CTRL_ID_MAX)
+    {
+        assert(false);
+        return false;
+    }
 
-        case GEN_OUT_CTRL_ID_LEFT_PAD_LED:          // Left Pad Feedback LED
-            TRISCbits.TRISC0 = GPIO_BIT_OUTPUT;     // LED2 control
-            LATCbits.LATC0 = GPIO_HIGH;             // This turns the LED off
-            break;
+    // Set the latch before turning on the driver so the pin never glitches active.
+    PinWrite(&pin_defs[item_id], false);
+    *pin_defs[item_id].tris &= (uint8_t)~pin_defs[item_id].mask;
 
-        case GEN_OUT_CTRL_ID_RIGHT_PAD_LED:         // Right Pad Feedback LED
-            TRISEbits.TRISE2 = GPIO_BIT_OUTPUT;     // LED3 control
-            LATEbits.LATE2 = GPIO_HIGH;             // This turns the LED off
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_PAD_LED:       // Reverse Pad Feedback LED
-            TRISAbits.TRISA1 = GPIO_BIT_OUTPUT;     // LED4 control
-            LATAbits.LATA1 = GPIO_HIGH;             // This turns the LED off
-            break;
-            
-        case GEN_OUT_CTRL_ID_FORWARD_DEMAND:        // Forward Drive demand pin on 9-pin connector
-            TRISAbits.TRISA4 = GPIO_BIT_OUTPUT;     // Set bit A4 for output control
-            LATAbits.LATA4 = GPIO_LOW;              // Sets low for no forward demand
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_DEMAND:        // Reverse Drive demand pin on 9-pin connector
-            TRISDbits.TRISD5 = GPIO_BIT_OUTPUT;     // Set bit D5 for output control
-            LATDbits.LATD5 = GPIO_LOW;              // Set low for no reverse demand
-            break;
-            
-        case GEN_OUT_CTRL_ID_LEFT_DEMAND:           // Left Drive demand pin on 9-pin connector
-            TRISDbits.TRISD6 = GPIO_BIT_OUTPUT;     // Set bit D6 for output control
-            LATDbits.LATD6 = GPIO_LOW;              // Set low for no Left demand
-            break;
-            
-        case GEN_OUT_CTRL_ID_RIGHT_DEMAND:          // Right Drive demand pin on 9-pin connector
-            TRISAbits.TRISA2 = GPIO_BIT_OUTPUT;     // Set bit A2 for output control
-            LATAbits.LATA2 = GPIO_LOW;              // Set low for no Right demand
-            break;
-            
-        case GEN_OUT_CTRL_ID_RESET_OUT:             // Reset Pin on 9-pin connector
-            TRISAbits.TRISA3 = GPIO_BIT_OUTPUT;     // Set bit A3 for output control
-            LATAbits.LATA3 = GPIO_LOW;              // Set low for no demand
-            break;
-            
-//    	case GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION:
-//			// Signal line used by this device to let the system know things like "resetting" and "user button short press"
-//			INTERNAL_SYS_ACTION_SIGNAL_INIT();
-//			break;
-//            
-        // The Bluetooth LED is being controlled by either enabling the port as an
-        // output or as an input. This operation is being controlled elsewhere.
-        // This function is called by a function that initializes all I/O.
-        // We will initialize the pin as an output here to turn off the Blue
-        // LED but will have to turn it on if the "Using Bluetooth" feature
-        // is turned on.
-//        case GEN_OUT_CTRL_ID_BT_LED:
-//            BLUETOOTH_LED_SIGNAL_INIT(); 
-//            break;
-
-	   	case GEN_OUT_CTRL_ID_MAX:
-	   	default:
-		   	ret_val = false;
-		   	return false;
-	}
-	
-	assert(ret_val);
-	return ret_val;
+	return true;
 }
 
 /**
@@ -241,67 +228,15 @@ bool GenOutCtrlBsp_Enable(GenOutCtrlId_t item_id)
  */
 bool GenOutCtrlBsp_Disable(GenOutCtrlId_t item_id)
 {
-	bool ret_val = true;
-
-	switch (item_id)
-	{
-        case GEN_OUT_CTRL_ID_POWER_LED:             // Power LED
-            TRISEbits.TRISE0 = GPIO_BIT_INPUT;      // LED1 control
-            break;
-            
-        case GEN_OUT_CTRL_ID_FORWARD_PAD_LED:       // Forward Pad Feedback LED
-            TRISEbits.TRISE1 = GPIO_BIT_INPUT;      // LED #5 control.
-            break;
+    if (item_id >= GEN_OUT_CTRL_ID_MAX)
+    {
+        assert(false);
+        return false;
+    }
 
-        case GEN_OUT_CTRL_ID_LEFT_PAD_LED:          // Left Pad Feedback LED
-            TRISCbits.TRISC0 = GPIO_BIT_INPUT;      // LED2 control
-            break;
+    *pin_defs[item_id].tris |= pin_defs[item_id].mask;
 
-        case GEN_OUT_CTRL_ID_RIGHT_PAD_LED:         // Right Pad Feedback LED
-            TRISEbits.TRISE2 = GPIO_BIT_INPUT;      // LED3 control
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_PAD_LED:       // Reverse Pad Feedback LED
-            TRISAbits.TRISA1 = GPIO_BIT_INPUT;      // LED4 control
-            break;
-            
-        case GEN_OUT_CTRL_ID_FORWARD_DEMAND:        // Forward Drive demand pin on 9-pin connector
-            TRISAbits.TRISA4 = GPIO_BIT_INPUT;      // Set for input to disable
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_DEMAND:        // Reverse Drive demand pin on 9-pin connector
-            TRISDbits.TRISD5 = GPIO_BIT_INPUT;      // Set for input to disable
-            break;
-            
-        case GEN_OUT_CTRL_ID_LEFT_DEMAND:           // Left Drive demand pin on 9-pin connector
-            TRISDbits.TRISD6 = GPIO_BIT_INPUT;      // Set for input to disable
-            break;
-            
-        case GEN_OUT_CTRL_ID_RIGHT_DEMAND:          // Right Drive demand pin on 9-pin connector
-            TRISAbits.TRISA2 = GPIO_BIT_INPUT;      // Set for input to disable
-            break;
-            
-        case GEN_OUT_CTRL_ID_RESET_OUT:             // Reset Pin on 9-pin connector
-            TRISAbits.TRISA3 = GPIO_BIT_INPUT;      // Set bit A3 for input to disable
-            break;
-
-            //    	case GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION:
-//			// Signal line used by this device to let the system know things like "resetting" and "user button short press"
-//			INTERNAL_SYS_ACTION_SIGNAL_DEINIT();
-//			break;
-
-//        case GEN_OUT_CTRL_ID_BT_LED:
-//            BLUETOOTH_LED_SIGNAL_DEINIT();
-//            break;
-            
-	   	case GEN_OUT_CTRL_ID_MAX:
-	   	default:
-		   	ret_val = false;
-		   	return false;
-	}
-//	
-	assert(ret_val);
-	return ret_val;
+	return true;
 }
 
 /**
@@ -313,72 +248,15 @@ bool GenOutCtrlBsp_Disable(GenOutCtrlId_t item_id)
  */
 bool GenOutCtrlBsp_SetActive(GenOutCtrlId_t item_id)
 {
-	bool ret_val = true;
-    
-	switch (item_id)
-	{
-        case GEN_OUT_CTRL_ID_POWER_LED:            // Power LED
-            LATEbits.LATE0 = GPIO_LOW;             // This turns the LED #1 on
-            break;
+    if (item_id >= GEN_OUT_CTRL_ID_MAX)
+    {
+        assert(false);
+        return false;
+    }
 
-        case GEN_OUT_CTRL_ID_FORWARD_PAD_LED:       // Forward Pad Feedback LED
-            LATEbits.LATE1 = GPIO_LOW;             // This turns the LED #5 on
-            break;
-            
-        case GEN_OUT_CTRL_ID_LEFT_PAD_LED:          // Left Pad Feedback LED
-            LATCbits.LATC0 = GPIO_LOW;             // This turns the LED on
-            break;
+    PinWrite(&pin_defs[item_id], true);
 
-        case GEN_OUT_CTRL_ID_RIGHT_PAD_LED:         // Right Pad Feedback LED
-            LATEbits.LATE2 = GPIO_LOW;             // This turns the LED on
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_PAD_LED:       // Reverse Pad Feedback LED
-            LATAbits.LATA1 = GPIO_LOW;              // This turns the LED on
-            break;
-            
-        case GEN_OUT_CTRL_ID_FORWARD_DEMAND:        // Forward Drive demand pin on 9-pin connector
-            LATAbits.LATA4 = GPIO_HIGH;             // Sets high to drive forward
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_DEMAND:        // Reverse Drive demand pin on 9-pin connector
-            LATDbits.LATD5 = GPIO_HIGH;             // Sets high to drive in reverse
-            break;
-            
-        case GEN_OUT_CTRL_ID_LEFT_DEMAND:           // Left Drive demand pin on 9-pin connector
-            LATDbits.LATD6 = GPIO_HIGH;             // Sets high to drive left
-            break;
-            
-        case GEN_OUT_CTRL_ID_RIGHT_DEMAND:          // Right Drive demand pin on 9-pin connector
-            LATAbits.LATA2 = GPIO_HIGH;             // Sets high to drive right
-            break;
-            
-        case GEN_OUT_CTRL_ID_RESET_OUT:             // Reset Pin on 9-pin connector
-            LATAbits.LATA3 = GPIO_HIGH;             // Sets high to make Reset active
-            break;
-            
-//    	case GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION:
-//			// Signal line used by this device to let the system know things like "resetting" and "user button short press"
-//			INTERNAL_SYS_ACTION_SIGNAL_INIT();
-//			break;
-//            
-        // The Bluetooth LED is being controlled by either enabling the port as an
-        // output or as an input. This operation is being controlled elsewhere.
-        // This function is called by a function that initializes all I/O.
-        // We will initialize the pin as an output here to turn off the Blue
-        // LED but will have to turn it on if the "Using Bluetooth" feature
-        // is turned on.
-//        case GEN_OUT_CTRL_ID_BT_LED:
-//            BLUETOOTH_LED_SIGNAL_INIT(); 
-//            break;
-
-	   	case GEN_OUT_CTRL_ID_MAX:
-	   	default:
-		   	ret_val = false;
-		   	return false;
-	}
-	assert(ret_val);
-	return ret_val;
+	return true;
 }
 
 /**
@@ -390,73 +268,15 @@ bool GenOutCtrlBsp_SetActive(GenOutCtrlId_t item_id)
  */
 bool GenOutCtrlBsp_SetInactive(GenOutCtrlId_t item_id)
 {
-	bool ret_val = true;
-
-	switch (item_id)
-	{
-        case GEN_OUT_CTRL_ID_POWER_LED:            // Power LED
-            LATEbits.LATE0 = GPIO_HIGH;             // This turns the LED off #1
-            break;
+    if (item_id >= GEN_OUT_CTRL_ID_MAX)
+    {
+        assert(false);
+        return false;
+    }
 
-        case GEN_OUT_CTRL_ID_FORWARD_PAD_LED:       // Forward Pad Feedback LED
-            LATEbits.LATE1 = GPIO_HIGH;             // This turns the LED #5 off
-            break;
-
-        case GEN_OUT_CTRL_ID_LEFT_PAD_LED:          // Left Pad Feedback LED
-            LATCbits.LATC0 = GPIO_HIGH;             // This turns the LED off
-            break;
+    PinWrite(&pin_defs[item_id], false);
 
-        case GEN_OUT_CTRL_ID_RIGHT_PAD_LED:         // Right Pad Feedback LED
-            LATEbits.LATE2 = GPIO_HIGH;             // This turns the LED off
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_PAD_LED:       // Reverse Pad Feedback LED
-            LATAbits.LATA1 = GPIO_HIGH;             // This turns the LED off
-            break;
-            
-        case GEN_OUT_CTRL_ID_FORWARD_DEMAND:        // Forward Drive demand pin on 9-pin connector
-            LATAbits.LATA4 = GPIO_LOW;              // This eliminates the Forward Drive demand
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_DEMAND:        // Reverse Drive demand pin on 9-pin connector
-            LATDbits.LATD5 = GPIO_LOW;              // This eliminates the Reverse Drive demand
-            break;
-            
-        case GEN_OUT_CTRL_ID_LEFT_DEMAND:           // Left Drive demand pin on 9-pin connector
-            LATDbits.LATD6 = GPIO_LOW;              // This eliminates the Left Drive demand
-            break;
-            
-        case GEN_OUT_CTRL_ID_RIGHT_DEMAND:          // Right Drive demand pin on 9-pin connector
-            LATAbits.LATA2 = GPIO_LOW;              // This eliminates the RightDrive demand
-            break;
-            
-        case GEN_OUT_CTRL_ID_RESET_OUT:             // Reset Pin on 9-pin connector
-            LATAbits.LATA3 = GPIO_LOW;             // Sets high to make Reset active
-            break;
-            
-//    	case GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION:
-//			// Signal line used by this device to let the system know things like "resetting" and "user button short press"
-//			INTERNAL_SYS_ACTION_SIGNAL_INIT();
-//			break;
-//            
-        // The Bluetooth LED is being controlled by either enabling the port as an
-        // output or as an input. This operation is being controlled elsewhere.
-        // This function is called by a function that initializes all I/O.
-        // We will initialize the pin as an output here to turn off the Blue
-        // LED but will have to turn it on if the "Using Bluetooth" feature
-        // is turned on.
-//        case GEN_OUT_CTRL_ID_BT_LED:
-//            BLUETOOTH_LED_SIGNAL_DEINIT(); 
-//            break;
-
-	   	case GEN_OUT_CTRL_ID_MAX:
-	   	default:
-		   	ret_val = false;
-		   	return false;
-	}
-
-	assert(ret_val);
-	return ret_val;
+	return true;
 }
 
 /**
@@ -468,53 +288,102 @@ bool GenOutCtrlBsp_SetInactive(GenOutCtrlId_t item_id)
  */
 bool GenOutCtrlBsp_Toggle(GenOutCtrlId_t item_id)
 {
-	bool ret_val = true;
+    if (item_id >= GEN_OUT_CTRL_ID_MAX)
+    {
+        assert(false);
+        return false;
+    }
 
-	switch (item_id)
-	{
-        case GEN_OUT_CTRL_ID_POWER_LED:            // Power LED
-            LATEbits.LATE0 = (LATEbits.LATE0 == GPIO_HIGH ? GPIO_LOW : GPIO_HIGH);             // This turns the LED #1 off
-            break;
-            
-        case GEN_OUT_CTRL_ID_FORWARD_PAD_LED:       // Forward Pad Feedback LED
-            LATEbits.LATE1 = (LATEbits.LATE1 == GPIO_HIGH ? GPIO_LOW : GPIO_HIGH);             // This turns the LED #5 off
-            break;
+    *pin_defs[item_id].lat ^= pin_defs[item_id].mask;
 
-        case GEN_OUT_CTRL_ID_LEFT_PAD_LED:          // Left Pad Feedback LED
-            LATCbits.LATC0 = (LATCbits.LATC0 == GPIO_HIGH ? GPIO_LOW : GPIO_HIGH);             // This turns the LED #2 off
-            break;
+	return true;
+}
 
-        case GEN_OUT_CTRL_ID_RIGHT_PAD_LED:         // Right Pad Feedback LED
-            LATEbits.LATE2 = (LATEbits.LATE2 == GPIO_HIGH ? GPIO_LOW : GPIO_HIGH);             // This turns the LED #3 off
-            break;
-            
-        case GEN_OUT_CTRL_ID_REVERSE_PAD_LED:       // Reverse Pad Feedback LED
-            LATAbits.LATA1 = (LATAbits.LATA1 == GPIO_HIGH ? GPIO_LOW : GPIO_HIGH);             // This turns the LED #4 off
-            break;
-            
-//    	case GEN_OUT_CTRL_ID_INTERNAL_SYS_ACTION:
-//			// Signal line used by this device to let the system know things like "resetting" and "user button short press"
-//			INTERNAL_SYS_ACTION_SIGNAL_INIT();
-//			break;
-//            
-        // The Bluetooth LED is being controlled by either enabling the port as an
-        // output or as an input. This operation is being controlled elsewhere.
-        // This function is called by a function that initializes all I/O.
-        // We will initialize the pin as an output here to turn off the Blue
-        // LED but will have to turn it on if the "Using Bluetooth" feature
-        // is turned on.
-//        case GEN_OUT_CTRL_ID_BT_LED:
-//            BLUETOOTH_LED_SIGNAL_INIT(); 
-//            break;
-
-	   	case GEN_OUT_CTRL_ID_MAX:
-	   	default:
-		   	ret_val = false;
-		   	return false;
-	}
-	
-	assert(ret_val);
-	return ret_val;
+/**
+ * Sets several general outputs at once, writing each port only once.
+ *
+ * @param item_ids      Outputs to change, one bit per GenOutCtrlId_t (see GEN_OUT_CTRL_BSP_ID_BIT()).
+ * @param active_ids    Of the outputs in item_ids, the ones to make active. The rest are made inactive.
+ *
+ * @note Outputs on the same port change on the same instruction. The port write is a read-modify-write,
+ *       so no pin on these ports may be driven from an interrupt.
+ */
+void GenOutCtrlBsp_SetMany(GenOutCtrlBspIdMask_t item_ids, GenOutCtrlBspIdMask_t active_ids)
+{
+    volatile uint8_t *lat;
+    uint8_t set_bits;
+    uint8_t clr_bits;
+
+    // Each pass picks the port of the lowest id still pending and applies every pending id on that port.
+    while (item_ids != 0)
+    {
+        lat = NULL;
+        set_bits = 0;
+        clr_bits = 0;
+
+        for (uint8_t i = 0; i < (uint8_t)GEN_OUT_CTRL_ID_MAX; i++)
+        {
+            GenOutCtrlBspIdMask_t id_bit = GEN_OUT_CTRL_BSP_ID_BIT(i);
+
+            if ((item_ids & id_bit) == 0)
+            {
+                continue;
+            }
+
+            if (lat == NULL)
+            {
+                lat = pin_defs[i].lat;
+            }
+            else if (pin_defs[i].lat != lat)
+            {
+                continue;
+            }
+
+            if (((active_ids & id_bit) != 0) == (pin_defs[i].active_level == GPIO_HIGH))
+            {
+                set_bits |= pin_defs[i].mask;
+            }
+            else
+            {
+                clr_bits |= pin_defs[i].mask;
+            }
+
+            item_ids &= (GenOutCtrlBspIdMask_t)~id_bit;
+        }
+
+        if (lat == NULL)
+        {
+            // Only bits past GEN_OUT_CTRL_ID_MAX were left.
+            assert(false);
+            break;
+        }
+
+        *lat = (uint8_t)((*lat & (uint8_t)~clr_bits) | set_bits);
+    }
+}
+
+/*
+ ********************************************************************************************************
+ *                                       FILE LOCAL FUNCTIONS DEFINITIONS
+ ********************************************************************************************************
+ */
+
+/**
+ * Drives an output to its active or inactive level.
+ *
+ * @param pin       Pin definition of the output.
+ * @param active    true to make the output active, false to make it inactive.
+ */
+static void PinWrite(const GenOutPinDef_t *pin, bool active)
+{
+    if (active == (pin->active_level == GPIO_HIGH))
+    {
+        *pin->lat |= pin->mask;
+    }
+    else
+    {
+        *pin->lat &= (uint8_t)~pin->mask;
+    }
 }
 
 // End of Doxygen grouping
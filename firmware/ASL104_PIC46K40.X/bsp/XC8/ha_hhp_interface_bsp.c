@@ -4,6 +4,17 @@
 //
 // Description: Defines the BSP level for the communications interface between a head array and HHP display device.
 //
+//	Bytes are shifted by the MSSP1 peripheral and moved in and out of memory by its interrupt, so
+//	nothing here blocks and the OS tick keeps running through a whole HHP exchange.
+//
+//	 Receive: MSSP1 is an SPI slave. The master's RTS line doubles as the slave select, so the
+//	          receiver only listens while the master is asserting RTS.
+//	 Transmit: MSSP1 is switched to SPI master and clocks the response out on the same clock and
+//	          data lines. Then it goes back to being a slave.
+//
+//	RTS/CTS handshaking stays on GPIO. The master asserting RTS is caught by an interrupt on change
+//	so the HHP task can sleep until something happens, see haHhpBsp_EventCallbackSet().
+//
 // Author(s): Trevor Parsh (Embedded Wizardry, LLC)
 //
 // Modified for ASL on Date: 
@@ -18,6 +29,7 @@
 // from stdlib
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 // from project
 #include "config.h"
@@ -31,117 +43,132 @@
 
 /* ******************************   Macros   ****************************** */
 
+// Bit rate when the slave clocks a response out to the master.
+#define HHP_SPI_TX_BIT_RATE_Hz			(100000UL)
+#define HHP_SPI_FOSC_Hz					(10000000UL)
+
+// SSPxCON1 settings
+#define HHP_SPI_SSPM_SLAVE_SS			(0x04)	// SPI slave, SCK pin is clock, SS pin control enabled
+#define HHP_SPI_SSPM_MASTER_ADD			(0x0A)	// SPI master, clock = FOSC/(4 * (SSPxADD + 1))
+#define HHP_SPI_MASTER_ADD_VAL			((uint8_t)((HHP_SPI_FOSC_Hz / (4UL * HHP_SPI_TX_BIT_RATE_Hz)) - 1UL))
+
 #ifdef _18F46K40
-    // Master ready to send line
-    // X6: Pin 6
-    #define COMMS_MASTER_RTS_ACTIVE_VAL     (GPIO_LOW)
-    #define COMMS_MASTER_RTS_INACTIVE_VAL   (GPIO_HIGH)
-    #define COMMS_MASTER_RTS_IS_ACTIVE()	(PORTCbits.RC2 == COMMS_MASTER_RTS_ACTIVE_VAL)
-    #define COMMS_MASTER_RTS_INIT()			INLINE_EXPR(TRISCbits.TRISC2 = GPIO_BIT_INPUT; ANSELCbits.ANSELC2 = 0)
-    #define COMMS_MASTER_RTS_DEINIT()
-
-    // Slave ready to send/clear to send line
-    // X6: Pin 2
-    #define COMMS_RTS_CTS_ACTIVE_VAL		(GPIO_LOW)
-    #define COMMS_RTS_CTS_INACTIVE_VAL		(GPIO_HIGH)
-    #define COMMS_RTS_CTS_IS_ACTIVE()		(LATBbits.LATB0 == COMMS_RTS_CTS_ACTIVE_VAL)
-    #define COMMS_RTS_CTS_SET(active)		INLINE_EXPR(LATBbits.LATB0 = active ? COMMS_RTS_CTS_ACTIVE_VAL : COMMS_RTS_CTS_INACTIVE_VAL)
-    #define COMMS_RTS_CTS_TOGGLE()			INLINE_EXPR(COMMS_RTS_CTS_SET(!COMMS_RTS_CTS_IS_ACTIVE()))
-    #define COMMS_RTS_CTS_INIT()			INLINE_EXPR(TRISBbits.TRISB0 = GPIO_BIT_OUTPUT; COMMS_RTS_CTS_SET(false); ANSELBbits.ANSELB0 = 0)
-    #define COMMS_RTS_CTS_DEINIT()			INLINE_EXPR(TRISBbits.TRISB0 = GPIO_BIT_INPUT)
-
-    // RX/TX data line
-    // X6: Pin 3
-    #define COMMS_DATA_ACTIVE_VAL			(GPIO_HIGH)
-    #define COMMS_DATA_INACTIVE_VAL			(GPIO_LOW)
-    #define COMMS_DATA_OUT_IS_HIGH()		(LATEbits.LATE2 == GPIO_HIGH)
-    #define COMMS_DATA_IN_IS_HIGH()			(PORTEbits.RE2 == GPIO_HIGH)
-    #define COMMS_DATA_SET(active)			INLINE_EXPR(LATEbits.LATE2 = active ? COMMS_DATA_ACTIVE_VAL : COMMS_DATA_INACTIVE_VAL)
-    #define COMMS_DATA_TOGGLE()				INLINE_EXPR(COMMS_DATA_SET(!COMMS_DATA_IS_ACTIVE()))
-    #define COMMS_DATA_CONFIG_RX()			INLINE_EXPR(TRISEbits.TRISE2 = GPIO_BIT_INPUT; ANSELEbits.ANSELE2 = 0)
-    #define COMMS_DATA_CONFIG_TX()			INLINE_EXPR(TRISEbits.TRISE2 = GPIO_BIT_OUTPUT; ANSELEbits.ANSELE2 = 0)
-
-    // Clock line
-    // X6: Pin 5
-    #define COMMS_CLK_ACTIVE_VAL			(GPIO_HIGH)
-    #define COMMS_CLK_INACTIVE_VAL			(GPIO_LOW)
-    #define COMMS_CLK_OUT_IS_HIGH()			(LATEbits.LATE0 == GPIO_HIGH)
-    #define COMMS_CLK_IN_IS_HIGH()			(PORTEbits.RE0 == GPIO_HIGH)
-    #define COMMS_CLK_SET(active)			INLINE_EXPR(LATEbits.LATE0 = active ? COMMS_CLK_ACTIVE_VAL : COMMS_CLK_INACTIVE_VAL)
-    #define COMMS_CLK_TOGGLE()				INLINE_EXPR(COMMS_CLK_SET(!COMMS_CLK_IS_ACTIVE()))
-    #define COMMS_CLK_CONFIG_RX()			INLINE_EXPR(TRISEbits.TRISE0 = GPIO_BIT_INPUT; ANSELEbits.ANSELE0 = 0)
-    #define COMMS_CLK_CONFIG_TX()			INLINE_EXPR(TRISEbits.TRISE0 = GPIO_BIT_OUTPUT; ANSELEbits.ANSELE0 = 0)
+	// The MSSP1 inputs can only be routed from PORTB and PORTC, so the HHP clock and data lines
+	// (RE0 and RE2 on earlier boards) have to be wired to RC3 and RB5 for this interface.
+
+	// Master ready to send line. Also the SPI slave select.
+	// X6: Pin 6
+	#define COMMS_MASTER_RTS_ACTIVE_VAL     (GPIO_LOW)
+	#define COMMS_MASTER_RTS_INACTIVE_VAL   (GPIO_HIGH)
+	#define COMMS_MASTER_RTS_IS_ACTIVE()	(PORTCbits.RC2 == COMMS_MASTER_RTS_ACTIVE_VAL)
+	#define COMMS_MASTER_RTS_INIT()			INLINE_EXPR(TRISCbits.TRISC2 = GPIO_BIT_INPUT; ANSELCbits.ANSELC2 = 0; SSP1SSPPS = 0x12)
+	// Interrupt when RTS goes active (falling edge). The IOC interrupt is shared, see isrs.c.
+	#define COMMS_MASTER_RTS_EDGE_INIT()	INLINE_EXPR(IOCCNbits.IOCCN2 = 1; IOCCFbits.IOCCF2 = 0; IPR0bits.IOCIP = 0; PIE0bits.IOCIE = 1)
+	#define COMMS_MASTER_RTS_EDGE_SEEN()	(PIE0bits.IOCIE && IOCCFbits.IOCCF2)
+	#define COMMS_MASTER_RTS_EDGE_CLEAR()	INLINE_EXPR(IOCCFbits.IOCCF2 = 0)
+
+	// Slave ready to send/clear to send line
+	// X6: Pin 2
+	#define COMMS_RTS_CTS_ACTIVE_VAL		(GPIO_LOW)
+	#define COMMS_RTS_CTS_INACTIVE_VAL		(GPIO_HIGH)
+	#define COMMS_RTS_CTS_IS_ACTIVE()		(LATBbits.LATB0 == COMMS_RTS_CTS_ACTIVE_VAL)
+	#define COMMS_RTS_CTS_SET(active)		INLINE_EXPR(LATBbits.LATB0 = active ? COMMS_RTS_CTS_ACTIVE_VAL : COMMS_RTS_CTS_INACTIVE_VAL)
+	#define COMMS_RTS_CTS_INIT()			INLINE_EXPR(TRISBbits.TRISB0 = GPIO_BIT_OUTPUT; COMMS_RTS_CTS_SET(false); ANSELBbits.ANSELB0 = 0)
+
+	// RX/TX data line, SDI1 in and SDO1 out on the same pin.
+	// X6: Pin 3
+	#define COMMS_DATA_IN_IS_HIGH()			(PORTBbits.RB5 == GPIO_HIGH)
+	#define COMMS_DATA_INIT()				INLINE_EXPR(ANSELBbits.ANSELB5 = 0; SSP1DATPPS = 0x0D; RB5PPS = 0x0E)
+	#define COMMS_DATA_CONFIG_RX()			INLINE_EXPR(TRISBbits.TRISB5 = GPIO_BIT_INPUT)
+	#define COMMS_DATA_CONFIG_TX()			INLINE_EXPR(TRISBbits.TRISB5 = GPIO_BIT_OUTPUT)
+
+	// Clock line, SCK1 in and out on the same pin.
+	// X6: Pin 5
+	#define COMMS_CLK_IN_IS_HIGH()			(PORTCbits.RC3 == GPIO_HIGH)
+	#define COMMS_CLK_INIT()				INLINE_EXPR(ANSELCbits.ANSELC3 = 0; SSP1CLKPPS = 0x13; RC3PPS = 0x0D)
+	#define COMMS_CLK_CONFIG_RX()			INLINE_EXPR(TRISCbits.TRISC3 = GPIO_BIT_INPUT)
+	#define COMMS_CLK_CONFIG_TX()			INLINE_EXPR(TRISCbits.TRISC3 = GPIO_BIT_OUTPUT)
+
+	#define HHP_SPI_CON1					SSP1CON1
+	#define HHP_SPI_CON1bits				SSP1CON1bits
+	#define HHP_SPI_STATbits				SSP1STATbits
+	#define HHP_SPI_BUF						SSP1BUF
+	#define HHP_SPI_ADD						SSP1ADD
+	#define HHP_SPI_IF						PIR3bits.SSP1IF
+	#define HHP_SPI_IE						PIE3bits.SSP1IE
+	#define HHP_SPI_IP						IPR3bits.SSP1IP
 #else // TODO: Don't know, we are not supporting I2C on any other PIC
-    // Master ready to send line
-    // X6: Pin 2
-    #define COMMS_MASTER_RTS_ACTIVE_VAL     (GPIO_LOW)
-    #define COMMS_MASTER_RTS_INACTIVE_VAL   (GPIO_HIGH)
-    #define COMMS_MASTER_RTS_IS_ACTIVE()	(PORTBbits.RB0 == COMMS_MASTER_RTS_ACTIVE_VAL)
-    #define COMMS_MASTER_RTS_INIT()			INLINE_EXPR(TRISBbits.TRISB0 = GPIO_BIT_INPUT)
-    #define COMMS_MASTER_RTS_DEINIT()
-
-    // Slave ready to send/clear to send line
-    // X6: Pin 6
-    #define COMMS_RTS_CTS_ACTIVE_VAL		(GPIO_LOW)
-    #define COMMS_RTS_CTS_INACTIVE_VAL		(GPIO_HIGH)
-    #define COMMS_RTS_CTS_IS_ACTIVE()		(LATCbits.LATC2 == COMMS_RTS_CTS_ACTIVE_VAL)
-    #define COMMS_RTS_CTS_SET(active)		INLINE_EXPR(LATCbits.LATC2 = active ? COMMS_RTS_CTS_ACTIVE_VAL : COMMS_RTS_CTS_INACTIVE_VAL)
-    #define COMMS_RTS_CTS_TOGGLE()			INLINE_EXPR(COMMS_RTS_CTS_SET(!COMMS_RTS_CTS_IS_ACTIVE()))
-    #define COMMS_RTS_CTS_INIT()			INLINE_EXPR(TRISCbits.TRISC2 = GPIO_BIT_OUTPUT; COMMS_RTS_CTS_SET(false))
-    #define COMMS_RTS_CTS_DEINIT()			INLINE_EXPR(TRISCbits.TRISC2 = GPIO_BIT_INPUT)
-
-    // RX/TX data line
-    // X6: Pin 3
-    #define COMMS_DATA_ACTIVE_VAL			(GPIO_HIGH)
-    #define COMMS_DATA_INACTIVE_VAL			(GPIO_LOW)
-    #define COMMS_DATA_OUT_IS_HIGH()		(LATEbits.LATE2 == GPIO_HIGH)
-    #define COMMS_DATA_IN_IS_HIGH()			(PORTEbits.RE2 == GPIO_HIGH)
-    #define COMMS_DATA_SET(active)			INLINE_EXPR(LATEbits.LATE2 = active ? COMMS_DATA_ACTIVE_VAL : COMMS_DATA_INACTIVE_VAL)
-    #define COMMS_DATA_TOGGLE()				INLINE_EXPR(COMMS_DATA_SET(!COMMS_DATA_IS_ACTIVE()))
-    #define COMMS_DATA_CONFIG_RX()			INLINE_EXPR(TRISEbits.TRISE2 = GPIO_BIT_INPUT)
-    #define COMMS_DATA_CONFIG_TX()			INLINE_EXPR(TRISEbits.TRISE2 = GPIO_BIT_OUTPUT)
-
-    // Clock line
-    // X6: Pin 5
-    #define COMMS_CLK_ACTIVE_VAL			(GPIO_HIGH)
-    #define COMMS_CLK_INACTIVE_VAL			(GPIO_LOW)
-    #define COMMS_CLK_OUT_IS_HIGH()			(LATEbits.LATE0 == GPIO_HIGH)
-    #define COMMS_CLK_IN_IS_HIGH()			(PORTEbits.RE0 == GPIO_HIGH)
-    #define COMMS_CLK_SET(active)			INLINE_EXPR(LATEbits.LATE0 = active ? COMMS_CLK_ACTIVE_VAL : COMMS_CLK_INACTIVE_VAL)
-    #define COMMS_CLK_TOGGLE()				INLINE_EXPR(COMMS_CLK_SET(!COMMS_CLK_IS_ACTIVE()))
-    #define COMMS_CLK_CONFIG_RX()			INLINE_EXPR(TRISEbits.TRISE0 = GPIO_BIT_INPUT)
-    #define COMMS_CLK_CONFIG_TX()			INLINE_EXPR(TRISEbits.TRISE0 = GPIO_BIT_OUTPUT)
+	// The MSSP pins are fixed on this part: SCK on RB1, SDI on RB0, SDO on RC7 and SS on RA5.
+	#define COMMS_MASTER_RTS_ACTIVE_VAL     (GPIO_LOW)
+	#define COMMS_MASTER_RTS_INACTIVE_VAL   (GPIO_HIGH)
+	#define COMMS_MASTER_RTS_IS_ACTIVE()	(PORTAbits.RA5 == COMMS_MASTER_RTS_ACTIVE_VAL)
+	#define COMMS_MASTER_RTS_INIT()			INLINE_EXPR(TRISAbits.TRISA5 = GPIO_BIT_INPUT)
+	// No interrupt on change for RA5. The HHP task falls back on its idle poll.
+	#define COMMS_MASTER_RTS_EDGE_INIT()
+	#define COMMS_MASTER_RTS_EDGE_SEEN()	(false)
+	#define COMMS_MASTER_RTS_EDGE_CLEAR()
+
+	#define COMMS_RTS_CTS_ACTIVE_VAL		(GPIO_LOW)
+	#define COMMS_RTS_CTS_INACTIVE_VAL		(GPIO_HIGH)
+	#define COMMS_RTS_CTS_IS_ACTIVE()		(LATCbits.LATC2 == COMMS_RTS_CTS_ACTIVE_VAL)
+	#define COMMS_RTS_CTS_SET(active)		INLINE_EXPR(LATCbits.LATC2 = active ? COMMS_RTS_CTS_ACTIVE_VAL : COMMS_RTS_CTS_INACTIVE_VAL)
+	#define COMMS_RTS_CTS_INIT()			INLINE_EXPR(TRISCbits.TRISC2 = GPIO_BIT_OUTPUT; COMMS_RTS_CTS_SET(false))
+
+	#define COMMS_DATA_IN_IS_HIGH()			(PORTBbits.RB0 == GPIO_HIGH)
+	#define COMMS_DATA_INIT()				INLINE_EXPR(TRISBbits.TRISB0 = GPIO_BIT_INPUT)
+	#define COMMS_DATA_CONFIG_RX()			INLINE_EXPR(TRISCbits.TRISC7 = GPIO_BIT_INPUT)
+	#define COMMS_DATA_CONFIG_TX()			INLINE_EXPR(TRISCbits.TRISC7 = GPIO_BIT_OUTPUT)
+
+	#define COMMS_CLK_IN_IS_HIGH()			(PORTBbits.RB1 == GPIO_HIGH)
+	#define COMMS_CLK_INIT()
+	#define COMMS_CLK_CONFIG_RX()			INLINE_EXPR(TRISBbits.TRISB1 = GPIO_BIT_INPUT)
+	#define COMMS_CLK_CONFIG_TX()			INLINE_EXPR(TRISBbits.TRISB1 = GPIO_BIT_OUTPUT)
+
+	#define HHP_SPI_CON1					SSPCON1
+	#define HHP_SPI_CON1bits				SSPCON1bits
+	#define HHP_SPI_STATbits				SSPSTATbits
+	#define HHP_SPI_BUF						SSPBUF
+	#define HHP_SPI_ADD						SSPADD
+	#define HHP_SPI_IF						PIR1bits.SSPIF
+	#define HHP_SPI_IE						PIE1bits.SSPIE
+	#define HHP_SPI_IP						IPR1bits.SSPIP
 #endif
 
 /* ******************************   Types   ******************************* */
 
 typedef enum
 {
-	PIN_ID_MASTER_RTS,
-	PIN_ID_RTS_CTS,
-	PIN_ID_DATA,
-	PIN_ID_CLK
-} HaHhpPinId_t;
+	LINK_IDLE,			// Listening, but nobody has asked for a packet.
+	LINK_RX,			// Collecting a packet from the master.
+	LINK_RX_DONE,		// Whole packet is in the buffer.
+	LINK_RX_ERROR,		// Bad length or the receiver overflowed. Ignoring the rest.
+	LINK_TX				// Clocking a response out to the master.
+} HaHhpLinkState_t;
+
+/* ***********************   File Scope Variables   *********************** */
+
+static volatile HaHhpLinkState_t link_state = LINK_IDLE;
+
+static uint8_t *volatile rx_buff = NULL;
+static uint8_t rx_buff_len;
+static volatile uint8_t rx_count;
+
+static const uint8_t *volatile tx_pkt = NULL;
+static volatile uint8_t tx_len;
+static volatile uint8_t tx_count;
+
+static HaHhpBspCallback_t event_callback = NULL;
 
 /* ***********************   Function Prototypes   ************************ */
 
-static void StartPacketTransmit(void);
-static void ConfigureIoForResponse(void);
-static void ConfigureIoForNewTransaction(void);
-static void TxByte(uint8_t tx_byte);
-static inline bool WaitForDataPinToGoHigh(uint8_t timeout_cycles);
-static inline bool WaitForDataPinToGoLow(uint8_t timeout_cycles);
-static inline bool WaitForClkPinToGoHigh(uint8_t timeout_cycles);
-static inline bool WaitForClkPinToGoLow(uint8_t timeout_cycles);
-static inline bool WaitForMstRtsPinToGoActive(uint8_t timeout_cycles);
-static inline bool WaitForMstRtsPinToGoInactive(uint8_t timeout_cycles);
-
-#if defined(HA_HHP_COMMS_BSP_TIMING_TEST) || defined(HA_HHP_COMMS_TEST_BASIC_HARDWARE) || defined(HA_HHP_BSP_DELAY_TEST)
+static void ConfigureForSlaveRx(void);
+static void ConfigureForMasterTx(void);
+static void NotifyEvent(void);
+
+#if defined(HA_HHP_COMMS_TEST_BASIC_HARDWARE) || defined(HA_HHP_BSP_DELAY_TEST)
     static void RunTests(void);
     
-	#if defined(HA_HHP_COMMS_BSP_TIMING_TEST)
-		static void BspTimingTest(void);
-	#elif defined(HA_HHP_BSP_DELAY_TEST)
+	#if defined(HA_HHP_BSP_DELAY_TEST)
 		static void DelayTimingTest(void);
 	#elif defined(HA_HHP_COMMS_TEST_BASIC_HARDWARE)
 		static void BasicHardwareTest(void);
@@ -158,12 +185,16 @@ static inline bool WaitForMstRtsPinToGoInactive(uint8_t timeout_cycles);
 //-------------------------------
 void haHhpBsp_Init(void)
 {
-//	COMMS_MASTER_RTS_INIT();
-//	COMMS_RTS_CTS_INIT();
-//	COMMS_DATA_CONFIG_RX();
-//	COMMS_CLK_CONFIG_RX();
+	COMMS_MASTER_RTS_INIT();
+	COMMS_RTS_CTS_INIT();
+	COMMS_DATA_INIT();
+	COMMS_CLK_INIT();
+
+	HHP_SPI_IP = 0;		// Low priority, serviced from lowPrioIsr
+	ConfigureForSlaveRx();
+	COMMS_MASTER_RTS_EDGE_INIT();
 	
-#if defined(HA_HHP_COMMS_BSP_TIMING_TEST) || defined(HA_HHP_COMMS_TEST_BASIC_HARDWARE) || defined(HA_HHP_BSP_DELAY_TEST)
+#if defined(HA_HHP_COMMS_TEST_BASIC_HARDWARE) || defined(HA_HHP_BSP_DELAY_TEST)
 	RunTests();
 #endif
 }
@@ -171,317 +202,283 @@ void haHhpBsp_Init(void)
 //-------------------------------
 // Function: haHhpBsp_ReadyToReceivePacket
 //
-// Description: Waits for the system to be in a valid state to receive a packet from the HHP.
+// Description: Lets the caller know if the link is free to receive a packet from the HHP.
+//		It isn't while a response is still going out.
 //
 //-------------------------------
 bool haHhpBsp_ReadyToReceivePacket(void)
 {
-//	bool ret_val;
-//
-//	// Clock and data must be high at this point
-//	if (WaitForDataPinToGoHigh(1) && WaitForClkPinToGoHigh(1))
-//	{
-//		ret_val = true;
-//	}
-//	else
-//	{
-//		ret_val = false;
-//	}
-//
-//	return ret_val;
-    return false; // TODO Replace with real code.
+	return (link_state != LINK_TX);
 }
 
 //-------------------------------
-// Function: haHhpBsp_TransmitPacket
+// Function: haHhpBsp_RxStart
 //
-// Description: Sends a packet from slave to master device.
+// Description: Starts collecting a packet into rx_pkt. Bytes are collected by the interrupt,
+//		check on it with haHhpBsp_RxStatusGet().
 //
 //-------------------------------
-void haHhpBsp_TransmitPacket(uint8_t *tx_pkt, uint8_t len)
+void haHhpBsp_RxStart(uint8_t *rx_pkt, uint8_t max_len)
 {
-//	if (WaitForMstRtsPinToGoInactive(HA_HHP_LINE_INPUT_TO_100_us))
-//	{
-//		StartPacketTransmit();
-//
-//		// Send all bytes, waiting a small amount of time in between each to allow master device
-//		// to process each byte.
-//		for (unsigned int i = 0; i < len; i++)
-//		{
-//			TxByte(tx_pkt[i]);
-//		}
-//
-//		// Set data and clock lines back to inputs.
-//		ConfigureIoForNewTransaction();
-//		
-//		// Let master know that the slave device is giving up control of the communications channel.
-//		COMMS_RTS_CTS_SET(false);
-//	}
+	HHP_SPI_IE = 0;
+	rx_buff = rx_pkt;
+	rx_buff_len = max_len;
+	rx_count = 0;
+	link_state = LINK_RX;
+
+	// Throw away anything the master clocked in before we were ready.
+	ConfigureForSlaveRx();
 }
 
 //-------------------------------
-// Function: haHhpBsp_RxByte
+// Function: haHhpBsp_RxStatusGet
 //
-// Description: Receives a single byte from master device
+// Description: Lets the caller know how receiving the packet started by haHhpBsp_RxStart() is going.
 //
-// return: true: read in byte, false: timed out trying to read in byte
 //-------------------------------
-bool haHhpBsp_RxByte(uint8_t *rxd_byte)
+HaHhpBspRxStatus_t haHhpBsp_RxStatusGet(void)
 {
-//	unsigned int num_bits_read_in = 0;
-	bool ret_val = true;
-
-//	*rxd_byte = 0;
-//
-//	while ((num_bits_read_in < 8) && ret_val)
-//	{
-//		// Wait for the clock input to go high.
-//		ret_val = WaitForClkPinToGoHigh(HA_HHP_LINE_INPUT_TO_100_us);
-//
-//		if (ret_val)
-//		{
-//			// Wait for the clock line to go low.
-//			ret_val = WaitForClkPinToGoLow(HA_HHP_LINE_INPUT_TO_100_us);
-//			
-//            if (ret_val)
-//            {
-//                // Didn't time out.
-//                // Shove bit value into the byte
-//                *rxd_byte <<= 1;
-//                if (COMMS_DATA_IN_IS_HIGH())
-//                {
-//                    *rxd_byte |= 0x01;
-//                }
-//                else
-//                {
-//                    *rxd_byte &= 0xFE;
-//                }
-//
-//                num_bits_read_in++;
-//            }
-//		}
-//	}
-//
-	return ret_val;
+	switch (link_state)
+	{
+		case LINK_RX_DONE:
+			return HA_HHP_BSP_RX_DONE;
+		case LINK_RX:
+			return HA_HHP_BSP_RX_BUSY;
+		default:
+			return HA_HHP_BSP_RX_ERROR;
+	}
 }
 
 //-------------------------------
-// Function: haHhpBsp_MasterRtsAsserted
-//
-// Description: Let's caller know whether or not the master device's RTS line is asserted.
-// 		Meaning, figuring out whether the master device is idle or if it wants to communicate.
+// Function: haHhpBsp_TransmitPacket
 //
-//-------------------------------
-bool haHhpBsp_MasterRtsAsserted(void)
-{
-//	return COMMS_MASTER_RTS_IS_ACTIVE();
-    return false; // TODO: Replace 
-}
-
-//-------------------------------
-// Function: haHhpBsp_SlaveReadyToReceivePacket
+// Description: Starts sending a packet from slave to master device and returns at once. The
+//		packet buffer must be left alone until haHhpBsp_TransmitBusy() returns false.
 //
-// Description: Let master device know that the slave is ready to process the packet.
+// return: false if nothing was sent because the master is still holding the channel (or len
+//		is 0). The caller keeps the packet and tries again once the master lets go of RTS.
 //
 //-------------------------------
-void haHhpBsp_SlaveReadyToReceivePacket(void)
+bool haHhpBsp_TransmitPacket(uint8_t *tx_pkt_to_send, uint8_t len)
 {
-//	// Acting as CTS.
-//	COMMS_RTS_CTS_SET(true);
-//	bspDelayUs(US_DELAY_100_us);
-//	COMMS_RTS_CTS_SET(false);
-}
+	if ((len == 0) || COMMS_MASTER_RTS_IS_ACTIVE())
+	{
+		return false;
+	}
 
-/* ********************   Private Function Definitions   ****************** */
+	HHP_SPI_IE = 0;
+	tx_pkt = tx_pkt_to_send;
+	tx_len = len;
+	tx_count = 0;
+	link_state = LINK_TX;
 
-//-------------------------------
-// Function: StartPacketTransmit
-//
-// Description: Starts a packet transmission from slave to master
-//
-//-------------------------------
-static void StartPacketTransmit(void)
-{
-//	ConfigureIoForResponse();
-//
-//	// Drive clock and data lines low.
-//	COMMS_DATA_SET(true);
-//	COMMS_CLK_SET(true);
-//
-//	// Let master know that the slave device is about to take control of the communications channel.
-//	// Acting as RTS.
-//	COMMS_RTS_CTS_SET(true);
-//
-//	// Wait for the master device to configure data and clock lines as inputs.
-//	bspDelayUs(US_DELAY_50_us);
-}
+	ConfigureForMasterTx();
 
-//-------------------------------
-// Function: ConfigureIoForResponse
-//
-// Description: Configures hardware to prepare for response to/from current transaction.
-//-------------------------------
-static void ConfigureIoForResponse(void)
-{
-//	COMMS_DATA_CONFIG_TX();
-//	COMMS_CLK_CONFIG_TX();
+	// Let master know that the slave device is about to take control of the communications channel.
+	// Acting as RTS.
+	COMMS_RTS_CTS_SET(true);
+
+	// Wait for the master device to configure data and clock lines as inputs.
+	bspDelayUs(US_DELAY_50_us);
+
+	// The interrupt sends the rest.
+	HHP_SPI_IF = 0;
+	HHP_SPI_BUF = tx_pkt[0];
+	HHP_SPI_IE = 1;
+
+	return true;
 }
 
 //-------------------------------
-// Function: ConfigureIoForNewTransaction
+// Function: haHhpBsp_TransmitBusy
+//
+// Description: Lets the caller know whether a response is still going out.
 //
-// Description: Configures hardware to prepare for a new transaction
 //-------------------------------
-static void ConfigureIoForNewTransaction(void)
+bool haHhpBsp_TransmitBusy(void)
 {
-//	COMMS_DATA_CONFIG_RX();
-//	COMMS_CLK_CONFIG_RX();
+	return (link_state == LINK_TX);
 }
 
 //-------------------------------
-// Function: TxByte
-//
-// Description: Transmit a single byte of data over the communications link.
+// Function: haHhpBsp_MasterRtsAsserted
 //
-// NOTE: The hardware on both slave and master devices must be set up before this function is called
-// NOTE: to allow the slave to transmit or this function fails to do the only thing it's meant to do.
+// Description: Let's caller know whether or not the master device's RTS line is asserted.
+// 		Meaning, figuring out whether the master device is idle or if it wants to communicate.
 //
 //-------------------------------
-static void TxByte(uint8_t tx_byte)
+bool haHhpBsp_MasterRtsAsserted(void)
 {
-//	for (unsigned int i = 0; i < 8; i++)
-//	{
-//		COMMS_DATA_SET((tx_byte & 0x80) > 0);
-//		COMMS_CLK_SET(true);
-//		bspDelayUs(US_DELAY_50_us);
-//		COMMS_CLK_SET(false);
-//		bspDelayUs(US_DELAY_50_us - 4);
-//		
-//		tx_byte <<= 1;
-//	}
+	return COMMS_MASTER_RTS_IS_ACTIVE();
 }
 
 //-------------------------------
-// Function: WaitForDataPinToGoHigh
-//
-// Description: Has program wait until the data pin is high. Inlined because function calls take forever
-//		to execute in comparison.
+// Function: haHhpBsp_SlaveReadyToReceivePacket
 //
-// NOTE: The hardware on both slave and master devices must be set up before this function is called
-// NOTE: to allow the slave to transmit or this function fails to do the only thing it's meant to do.
+// Description: Let master device know that the slave is ready to process the packet.
 //
 //-------------------------------
-static inline bool WaitForDataPinToGoHigh(uint8_t timeout_cycles)
+void haHhpBsp_SlaveReadyToReceivePacket(void)
 {
-//	for (unsigned int i = 0; (i < timeout_cycles) && !COMMS_DATA_IN_IS_HIGH(); i++)
-//	{
-//	}
-//
-//	return COMMS_DATA_IN_IS_HIGH();
-    return false; // TODO: Fix.
+	// Acting as CTS.
+	COMMS_RTS_CTS_SET(true);
+	bspDelayUs(US_DELAY_100_us);
+	COMMS_RTS_CTS_SET(false);
 }
 
 //-------------------------------
-// Function: WaitForDataPinToGoLow
-//
-// Description: Has program wait until the data pin is low. Inlined because function calls take forever
-//		to execute in comparison.
+// Function: haHhpBsp_EventCallbackSet
 //
-// NOTE: The hardware on both slave and master devices must be set up before this function is called
-// NOTE: to allow the slave to transmit or this function fails to do the only thing it's meant to do.
+// Description: Sets a function to be called from interrupt context when the master asserts RTS,
+//		when a packet has been received (or failed), and when a response has gone out. Pass NULL
+//		to remove it.
 //
 //-------------------------------
-static inline bool WaitForDataPinToGoLow(uint8_t timeout_cycles)
+void haHhpBsp_EventCallbackSet(HaHhpBspCallback_t callback)
 {
-//	for (unsigned int i = 0; (i < timeout_cycles) && COMMS_DATA_IN_IS_HIGH(); i++)
-//	{
-//	}
-//
-//	return !COMMS_DATA_IN_IS_HIGH();
-    return false;   // TODO: Fix
+	event_callback = callback;
 }
 
 //-------------------------------
-// Function: WaitForClkPinToGoHigh
+// Function: haHhpBsp_Isr
 //
-// Description: Has program wait until the clock pin is high. Inlined because function calls take forever
-//		to execute in comparison.
-//
-// NOTE: The hardware on both slave and master devices must be set up before this function is called
-// NOTE: to allow the slave to transmit or this function fails to do the only thing it's meant to do.
+// Description: Moves a byte in or out of the MSSP and watches the master's RTS line. Call from
+//		the low priority ISR.
 //
 //-------------------------------
-static inline bool WaitForClkPinToGoHigh(uint8_t timeout_cycles)
+void haHhpBsp_Isr(void)
 {
-//	for (unsigned int i = 0; (i < timeout_cycles) && !COMMS_CLK_IN_IS_HIGH(); i++)
-//	{
-//	}
-//
-//	return COMMS_CLK_IN_IS_HIGH();
-    return false;
+	uint8_t rxd_byte;
+
+	if (COMMS_MASTER_RTS_EDGE_SEEN())
+	{
+		COMMS_MASTER_RTS_EDGE_CLEAR();
+		NotifyEvent();
+	}
+
+	if (!(HHP_SPI_IE && HHP_SPI_IF))
+	{
+		return;
+	}
+	HHP_SPI_IF = 0;
+
+	// Reading the buffer clears BF. It has to be read even when sending.
+	rxd_byte = HHP_SPI_BUF;
+
+	if (link_state == LINK_TX)
+	{
+		tx_count++;
+		if (tx_count < tx_len)
+		{
+			HHP_SPI_BUF = tx_pkt[tx_count];
+		}
+		else
+		{
+			// Last byte is out. Give the channel back to the master.
+			ConfigureForSlaveRx();
+			COMMS_RTS_CTS_SET(false);
+			link_state = LINK_IDLE;
+			NotifyEvent();
+		}
+		return;
+	}
+
+	if (HHP_SPI_CON1bits.SSPOV)
+	{
+		// A byte came in before the last one was read.
+		HHP_SPI_CON1bits.SSPOV = 0;
+		if (link_state == LINK_RX)
+		{
+			link_state = LINK_RX_ERROR;
+			NotifyEvent();
+		}
+	}
+
+	if (link_state != LINK_RX)
+	{
+		return;
+	}
+
+	// The first byte is the length, which counts itself and the checksum.
+	if ((rx_count == 0) && ((rxd_byte < 2) || (rxd_byte > rx_buff_len)))
+	{
+		link_state = LINK_RX_ERROR;
+		NotifyEvent();
+		return;
+	}
+
+	rx_buff[rx_count++] = rxd_byte;
+	if (rx_count >= rx_buff[0])
+	{
+		// Only a whole packet of the length it claims wakes the task.
+		link_state = LINK_RX_DONE;
+		NotifyEvent();
+	}
 }
 
+/* ********************   Private Function Definitions   ****************** */
+
 //-------------------------------
-// Function: WaitForClkPinToGoLow
-//
-// Description: Has program wait until the clock pin is low. Inlined because function calls take forever
-//		to execute in comparison.
+// Function: ConfigureForSlaveRx
 //
-// NOTE: The hardware on both slave and master devices must be set up before this function is called
-// NOTE: to allow the slave to transmit or this function fails to do the only thing it's meant to do.
+// Description: Lines are inputs and the MSSP is an SPI slave, selected by master RTS. Clock idles
+//		high and data is sampled on the falling edge, MSB first.
 //
 //-------------------------------
-static inline bool WaitForClkPinToGoLow(uint8_t timeout_cycles)
+static void ConfigureForSlaveRx(void)
 {
-//	for (unsigned int i = 0; (i < timeout_cycles) && COMMS_CLK_IN_IS_HIGH(); i++)
-//	{
-//	}
-//
-//	return !COMMS_CLK_IN_IS_HIGH();
-    return false; // TODO: Fix
+	HHP_SPI_CON1bits.SSPEN = 0;
+
+	COMMS_DATA_CONFIG_RX();
+	COMMS_CLK_CONFIG_RX();
+
+	HHP_SPI_STATbits.SMP = 0;				// Must be clear in slave mode
+	HHP_SPI_STATbits.CKE = 1;				// Sample on idle to active (falling) edge
+	HHP_SPI_CON1 = HHP_SPI_SSPM_SLAVE_SS;	// Clears WCOL and SSPOV too
+	HHP_SPI_CON1bits.CKP = 1;				// Clock idles high
+	HHP_SPI_CON1bits.SSPEN = 1;
+
+	HHP_SPI_IF = 0;
+	HHP_SPI_IE = 1;
 }
 
 //-------------------------------
-// Function: WaitForMstRtsPinToGoHigh
+// Function: ConfigureForMasterTx
 //
-// Description: Has program wait until the master RTS pin is active. Inlined because function calls take forever
-//		to execute in comparison.
-//
-// NOTE: The hardware on both slave and master devices must be set up before this function is called
-// NOTE: to allow the slave to transmit or this function fails to do the only thing it's meant to do.
+// Description: Lines are outputs and the MSSP is an SPI master. Same clock polarity and edges as
+//		the slave side so the master sees what it sends.
 //
 //-------------------------------
-static inline bool WaitForMstRtsPinToGoActive(uint8_t timeout_cycles)
+static void ConfigureForMasterTx(void)
 {
-//	for (unsigned int i = 0; (i < timeout_cycles) && !COMMS_MASTER_RTS_IS_ACTIVE(); i++)
-//	{
-//	}
-//
-//	return COMMS_MASTER_RTS_IS_ACTIVE();
-    return false; // TODO: Fix.
+	HHP_SPI_CON1bits.SSPEN = 0;
+
+	HHP_SPI_STATbits.SMP = 0;
+	HHP_SPI_STATbits.CKE = 1;				// Data changes on the rising edge, master reads on the falling edge.
+	HHP_SPI_ADD = HHP_SPI_MASTER_ADD_VAL;
+	HHP_SPI_CON1 = HHP_SPI_SSPM_MASTER_ADD;
+	HHP_SPI_CON1bits.CKP = 1;
+	HHP_SPI_CON1bits.SSPEN = 1;
+
+	COMMS_DATA_CONFIG_TX();
+	COMMS_CLK_CONFIG_TX();
 }
 
 //-------------------------------
-// Function: WaitForMstRtsPinToGoLow
-//
-// Description: Has program wait until the master RTS pin is inactive. Inlined because function calls take forever
-//		to execute in comparison.
+// Function: NotifyEvent
 //
-// NOTE: The hardware on both slave and master devices must be set up before this function is called
-// NOTE: to allow the slave to transmit or this function fails to do the only thing it's meant to do.
+// Description: Lets the app know something happened on the link. Interrupt context only.
 //
 //-------------------------------
-static inline bool WaitForMstRtsPinToGoInactive(uint8_t timeout_cycles)
+static void NotifyEvent(void)
 {
-//	for (unsigned int i = 0; (i < timeout_cycles) && COMMS_MASTER_RTS_IS_ACTIVE(); i++)
-//	{
-//	}
-//
-//	return !COMMS_MASTER_RTS_IS_ACTIVE();
-    return false; // TODO: Fix
+	if (event_callback != NULL)
+	{
+		event_callback();
+	}
 }
 
-#if defined(HA_HHP_COMMS_BSP_TIMING_TEST) || defined(HA_HHP_COMMS_TEST_BASIC_HARDWARE) || defined(HA_HHP_BSP_DELAY_TEST)
+#if defined(HA_HHP_COMMS_TEST_BASIC_HARDWARE) || defined(HA_HHP_BSP_DELAY_TEST)
 //-------------------------------
 // Function: RunTests
 //
@@ -490,10 +487,7 @@ static inline bool WaitForMstRtsPinToGoInactive(uint8_t timeout_cycles)
 //-------------------------------
 static void RunTests(void)
 {
-#if defined(HA_HHP_COMMS_BSP_TIMING_TEST)
-	BspTimingTest();
-	while (1);
-#elif defined(HA_HHP_BSP_DELAY_TEST)
+#if defined(HA_HHP_BSP_DELAY_TEST)
 	DelayTimingTest();
 	while(1);
 #elif defined(HA_HHP_COMMS_TEST_BASIC_HARDWARE)
@@ -501,122 +495,7 @@ static void RunTests(void)
 #endif
 }
 
-//-------------------------------
-// Function: BspTimingTest
-//
-// Description: Check the timing of each input "check and wait with timeout" function
-//
-// NOTE: Must connect test GPIO1 to data and clk lines.
-//
-//-------------------------------
-#if defined(HA_HHP_COMMS_BSP_TIMING_TEST)
-static void BspTimingTest(void)
-{
-	// Figure out how long it takes to drive the IO low to be able to subtract that value from
-	// each reading.
-	{
-		for (int j = 0; j < 3; j++)
-		{
-			testGpioSet(TEST_GPIO_0, true);
-			testGpioSet(TEST_GPIO_0, false);
-		}
-	}
-
-	for (int i = 0; i < 100; i++);
-
-	// Check timing for data high check
-	{
-		// Check timing of success
-		testGpioSet(TEST_GPIO_1, true);
-
-		testGpioSet(TEST_GPIO_0, true);
-		(void)WaitForDataPinToGoHigh(1);
-		testGpioSet(TEST_GPIO_0, false);
-
-		testGpioSet(TEST_GPIO_1, false);
-		for (int i = 0; i < 5; i++);
-
-		// Check timing of timeouts
-		for (int j = 1; j < 6; j++)
-		{
-			testGpioSet(TEST_GPIO_0, true);
-			(void)WaitForDataPinToGoHigh(j);
-			testGpioSet(TEST_GPIO_0, false);
-			for (int i = 0; i < 5; i++);
-		}
-	}
-    
-	for (int i = 0; i < 100; i++);
-
-	// Check timing for data low check
-	{
-		// Check timing of success
-		testGpioSet(TEST_GPIO_1, false);
-
-		testGpioSet(TEST_GPIO_0, true);
-		(void)WaitForDataPinToGoLow(1);
-		testGpioSet(TEST_GPIO_0, false);
-
-		testGpioSet(TEST_GPIO_1, true);
-		for (int i = 0; i < 5; i++);
-
-		for (int j = 1; j < 6; j++)
-		{
-			testGpioSet(TEST_GPIO_0, true);
-			(void)WaitForDataPinToGoLow(j);
-			testGpioSet(TEST_GPIO_0, false);
-			for (int i = 0; i < 5; i++);
-		}
-	}
-    
-	for (int i = 0; i < 100; i++);
-
-	// Check timing for clock high check
-	{
-		// Check timing of success
-		testGpioSet(TEST_GPIO_1, true);
-
-		testGpioSet(TEST_GPIO_0, true);
-		(void)WaitForClkPinToGoHigh(1);
-		testGpioSet(TEST_GPIO_0, false);
-
-		testGpioSet(TEST_GPIO_1, false);
-		for (int i = 0; i < 5; i++);
-
-		for (int j = 1; j < 6; j++)
-		{
-			testGpioSet(TEST_GPIO_0, true);
-			(void)WaitForClkPinToGoHigh(j);
-			testGpioSet(TEST_GPIO_0, false);
-			for (int i = 0; i < 5; i++);
-		}
-	}
-    
-	for (int i = 0; i < 100; i++);
-
-	// Check timing for clock low check
-	{
-		// Check timing of success
-		testGpioSet(TEST_GPIO_1, false);
-
-		testGpioSet(TEST_GPIO_0, true);
-		(void)WaitForClkPinToGoLow(1);
-		testGpioSet(TEST_GPIO_0, false);
-
-		testGpioSet(TEST_GPIO_1, true);
-		for (int i = 0; i < 5; i++);
-
-		for (int j = 1; j < 6; j++)
-		{
-			testGpioSet(TEST_GPIO_0, true);
-			(void)WaitForClkPinToGoLow(j);
-			testGpioSet(TEST_GPIO_0, false);
-			for (int i = 0; i < 5; i++);
-		}
-	}
-}
-
-#elif defined(HA_HHP_BSP_DELAY_TEST)
+#if defined(HA_HHP_BSP_DELAY_TEST)
 
 //-------------------------------
 // Function: DelayTimingTest
@@ -673,25 +552,17 @@ static volatile bool clk_state = false;
 //-------------------------------
 static void BasicHardwareTest(void)
 {
-	ConfigureIoForResponse();
+	// Let the pins be read as plain inputs.
+	HHP_SPI_IE = 0;
+	HHP_SPI_CON1bits.SSPEN = 0;
+	COMMS_DATA_CONFIG_RX();
+	COMMS_CLK_CONFIG_RX();
 	
 	while (1)
 	{
-#if 1
-		// Input test
 		rts_state = COMMS_MASTER_RTS_IS_ACTIVE();
 		clk_state = COMMS_CLK_IN_IS_HIGH();
 		data_state = COMMS_DATA_IN_IS_HIGH();
-#else
-		// Output test
-		COMMS_RTS_CTS_SET(true);
-		COMMS_CLK_SET(true);
-		COMMS_DATA_SET(true);
-
-		COMMS_RTS_CTS_SET(false);
-		COMMS_CLK_SET(false);
-		COMMS_DATA_SET(false);
-#endif
 	}
 }
 #endif
@@ -86,6 +86,14 @@ void BT_LED_INPUT_INIT()
     TRISCbits.TRISC5 = GPIO_BIT_INPUT;
     ANSELCbits.ANSELC5 = 0;
     WPUCbits.WPUC5 = 1;         // Enable weak pull-up
+
+    // Interrupt-on-change on both edges so the module's blink pattern
+    // can be time stamped. The IOC interrupt is on the low priority
+    // vector so it is serialized with the sys tick.
+    IOCCPbits.IOCCP5 = 1;       // Rising edge
+    IOCCNbits.IOCCN5 = 1;       // Falling edge
+    IOCCFbits.IOCCF5 = 0;
+    IPR0bits.IOCIP = 0;         // Low priority
 }
 
 //-------------------------------
@@ -144,6 +152,34 @@ bool BT_LED_IsActive(void)
     return BT_LED_IS_ACTIVE();
 }
 
+//-------------------------------------------------------------------------
+// Function: BT_LED_EdgeInterruptEnable()
+// Description: Enables/disables the interrupt-on-change for the BT LED
+//  input. Edges that occur while disabled stay latched and are serviced
+//  as soon as the interrupt is enabled again.
+//  NOTE: IOCIE is shared with the HHP's RTS edge, so disabling it masks
+//  that too.
+//-------------------------------------------------------------------------
+void BT_LED_EdgeInterruptEnable(bool enable)
+{
+    PIE0bits.IOCIE = enable ? 1 : 0;
+}
+
+//-------------------------------------------------------------------------
+// Function: BT_LED_EdgeDetected()
+// Description: Called from the ISR. Returns true if the BT LED input
+//  changed state, clearing the flag in the process.
+//-------------------------------------------------------------------------
+bool BT_LED_EdgeDetected(void)
+{
+    if (PIE0bits.IOCIE && IOCCFbits.IOCCF5)
+    {
+        IOCCFbits.IOCCF5 = 0;
+        return true;
+    }
+    return false;
+}
+
 //-------------------------------------------------------------------------
 // DIP Switch #1 is on D2
 void SW1_Init (void)
@@ -0,0 +1,42 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: crc_bsp.h
+//
+// Description: CRC-16 calculation using the PIC18F46K40's CRC module.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRC_BSP_H
+#define CRC_BSP_H
+
+/* ***************************    Includes     **************************** */
+
+// from stdlib
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ******************************   Types   ******************************* */
+
+typedef enum
+{
+	CRC_BSP_SCAN_IDLE,
+	CRC_BSP_SCAN_BUSY,
+	CRC_BSP_SCAN_DONE
+} CrcBspScanStatus_t;
+
+/* ***********************   Function Prototypes   ************************ */
+
+uint16_t crcBspCalc16(const uint8_t *data, uint8_t len);
+bool crcBspFlashScanAvailable(void);
+void crcBspFlashScanStart(bool burst);
+CrcBspScanStatus_t crcBspFlashScanStatus(uint16_t *crc);
+uint16_t crcBspFlashCrcExpected(void);
+
+#endif // CRC_BSP_H
+
+// end of file.
+//-------------------------------------------------------------------------
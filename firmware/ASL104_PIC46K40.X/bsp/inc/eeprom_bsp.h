@@ -19,13 +19,22 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/* ******************************   Types   ******************************* */
+
+typedef void (*EepromBspCallback_t)(void);
+
 /* ***********************   Function Prototypes   ************************ */
 
 void eepromBspInit(void);
-bool eepromBspWriteByte(uint8_t address, uint8_t byte_to_write, uint16_t timeout_ms);
-bool eepromBspWriteBuffer(uint8_t start_address, uint8_t num_bytes_to_write, uint8_t *data, uint16_t timeout_ms);
-bool eepromBspReadSection(uint8_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer, uint16_t timeout_ms);
+bool eepromBspWriteByte(uint16_t address, uint8_t byte_to_write, uint16_t timeout_ms);
+bool eepromBspWriteBuffer(uint16_t start_address, uint8_t num_bytes_to_write, const uint8_t *data, uint16_t timeout_ms);
+bool eepromBspReadSection(uint16_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer, uint16_t timeout_ms);
 uint16_t eepromBspSizeOfEeprom(void);
+bool eepromBspWriteBusy(void);
+bool eepromBspWriteRoom(uint8_t num_writes, uint8_t num_bytes);
+void eepromBspWriteWait(void);
+void eepromBspWriteDoneCallbackSet(EepromBspCallback_t callback);
+void eepromBspIsr(void);
 
 #endif // EEPROM_BSP_H
 
@@ -48,9 +48,28 @@
  */
 /********************************************** System *************************************************/
 #include <stdbool.h>
+#include <stdint.h>
 /********************************************    User   ************************************************/
 #include "general_output_ctrl_cfg.h"
 
+/*
+ ********************************************************************************************************
+ *                                                 DEFINES
+ ********************************************************************************************************
+ */
+/******************************************* Macro Functions *******************************************/
+/// Bit for an output in a GenOutCtrlBspIdMask_t.
+#define GEN_OUT_CTRL_BSP_ID_BIT(item_id)    ((GenOutCtrlBspIdMask_t)1 << (item_id))
+
+/*
+ ********************************************************************************************************
+ *                                               DATA TYPES
+ ********************************************************************************************************
+ */
+
+/// Set of general outputs, one bit per GenOutCtrlId_t. Must be wide enough for GEN_OUT_CTRL_ID_MAX bits.
+typedef uint16_t GenOutCtrlBspIdMask_t;
+
 /*
  ********************************************************************************************************
  *                                             FUNCTION PROTOTYPES
@@ -63,6 +82,7 @@ bool GenOutCtrlBsp_Disable(GenOutCtrlId_t item_id);
 bool GenOutCtrlBsp_SetActive(GenOutCtrlId_t item_id);
 bool GenOutCtrlBsp_SetInactive(GenOutCtrlId_t item_id);
 bool GenOutCtrlBsp_Toggle(GenOutCtrlId_t item_id);
+void GenOutCtrlBsp_SetMany(GenOutCtrlBspIdMask_t item_ids, GenOutCtrlBspIdMask_t active_ids);
 
 // End of Doxygen grouping
 /** @} */
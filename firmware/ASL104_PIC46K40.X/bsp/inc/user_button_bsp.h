@@ -24,6 +24,8 @@ void ButtonBspInit(void);
 bool userButtonBspIsActive(void);
 bool ModeButtonBspIsActive(void);
 bool BT_LED_IsActive(void);
+void BT_LED_EdgeInterruptEnable(bool enable);
+bool BT_LED_EdgeDetected(void);
 
 bool Is_SW1_ON(void);
 bool Is_SW3_ON(void);
@@ -22,6 +22,22 @@
 // If it's jumpered out, comment the following line.
 #define USE_12VOLT_REGULATOR
 
+// How long settings have to be left alone before changes to them are written to EEPROM. A burst
+// of changes, e.g. from the HHP, goes in as one write. Reduces wear on the EEPROM.
+#define EEPROM_FLUSH_QUIET_PERIOD_ms				((uint32_t)10 * (uint32_t)1000)
+
+// How often logged events are written to EEPROM. Events that come in close together go in as
+// one write.
+#define EVENT_LOG_FLUSH_PERIOD_ms					(500)
+
+// How often program memory is checked again after the check at power up. A scan only takes a
+// fraction of this, in the background.
+#define FLASH_CHECK_PERIOD_ms						((uint32_t)60 * (uint32_t)1000)
+
+// Nothing drives until the check at power up is done. If the background scan hasn't finished
+// by now, it's run again with the CPU stalled so it can't take any longer.
+#define FLASH_FIRST_CHECK_TIMEOUT_ms				(1000)
+
 /* ******************************   Tests   ******************************* */
 
 // Tests. Generally, only one should be enabled. Unless it is known that >1 test can be run with
@@ -29,9 +45,6 @@
 // #define TEST_BASIC_DAC_CONTROL
 // #define HA_HHP_COMMS_TEST_TIMING
 
-// Checks timing of the critical pieces of the HA->HHP BSP
-// #define HA_HHP_COMMS_BSP_TIMING_TEST
-
 // Checks timing of us delay function
 //#define HA_HHP_BSP_DELAY_TEST
 
@@ -31,6 +31,7 @@
 /* ***************************    Includes     **************************** */
 
 // from stdlib
+#include <stdint.h>
 #include <stdbool.h>
 
 /* ******************************   Types   ******************************* */
@@ -51,6 +52,8 @@ void stopwatchZero(StopWatch_t *stop_watch);
 bool stopwatchIsActive(StopWatch_t *stop_watch);
 TimerTick_t stopwatchTimeElapsed(StopWatch_t *stop_watch, bool zero_after_check);
 TimerTick_t stopwatchTimeUntilLimit(StopWatch_t *stop_watch, TimerTick_t time_to_check_ms);
+TimerTick_t stopwatchCurrentTime(void);
+uint32_t stopwatchUptimeGet(void);
 void stopwatchTick(void);
 
 #endif // STOPWATCH_H
@@ -32,6 +32,7 @@
 #include "device.h"
 
 // from stdlib
+#include <stdint.h>
 #include <stdbool.h>
 #include "user_assert.h"
 
@@ -43,6 +44,9 @@
 // Current time value used to keep track of time for this module, in milliseconds
 static volatile TimerTick_t curr_time_ms = 0;
 
+// Milliseconds since power up. Wider than TimerTick_t so it doesn't wrap for ~49 days.
+static volatile uint32_t uptime_ms = 0;
+
 /* *******************   Public Function Definitions   ******************** */
 
 //-------------------------------
@@ -136,6 +140,40 @@ TimerTick_t stopwatchTimeUntilLimit(StopWatch_t *stop_watch, TimerTick_t time_to
     }
 }
 
+//-------------------------------
+// Function: stopwatchCurrentTime
+//
+// Description: Returns the free running millisecond count used by all stopwatches. Intended for time stamping
+//		events (e.g. from an ISR) where a full stopwatch object is overkill.
+//
+// NOTE: The value is 16 bits wide. When called outside of the low priority ISR, the caller must keep the
+//		 sys tick from firing mid-read if an exact value is needed.
+//
+//-------------------------------
+TimerTick_t stopwatchCurrentTime(void)
+{
+	return curr_time_ms;
+}
+
+//-------------------------------
+// Function: stopwatchUptimeGet
+//
+// Description: Returns the milliseconds since power up. Safe to call from anywhere, the count is
+//		read again if the sys tick changed it part way through.
+//
+//-------------------------------
+uint32_t stopwatchUptimeGet(void)
+{
+	uint32_t uptime;
+
+	do
+	{
+		uptime = uptime_ms;
+	} while (uptime != uptime_ms);
+
+	return uptime;
+}
+
 //-------------------------------
 // Function: stopwatchTick
 //
@@ -145,6 +183,7 @@ TimerTick_t stopwatchTimeUntilLimit(StopWatch_t *stop_watch, TimerTick_t time_to
 void stopwatchTick(void)
 {
 	curr_time_ms++;
+	uptime_ms++;
 }
 
 // end of file.
@@ -22,15 +22,67 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "user_assert.h"
 
 // from RTOS
 #include "cocoos.h"
 
+#include "RS232.h"
+
+//------------------------------------------------------------------------------
+// Local Macros
+//------------------------------------------------------------------------------
+
+// Transmit ring size. Must be a power of 2. Holds a 6 byte eFix keep-alive from the
+// timer interrupt and the steering and speed frames queued right behind it.
+#define RS232_TX_BUFF_LEN       (32)
+#define RS232_TX_BUFF_IDX_MASK  (RS232_TX_BUFF_LEN - 1)
+
+// Receive ring size. Must be a power of 2. Holds several eFix replies between task runs.
+#define RS232_RX_BUFF_LEN       (32)
+#define RS232_RX_BUFF_IDX_MASK  (RS232_RX_BUFF_LEN - 1)
+
+#ifdef _18F46K40
+    #define RS232_TX_IF         PIR3bits.TX1IF
+    #define RS232_TX_IE         PIE3bits.TX1IE
+    #define RS232_TX_IP         IPR3bits.TX1IP
+    #define RS232_RX_IF         PIR3bits.RC1IF
+    #define RS232_RX_IE         PIE3bits.RC1IE
+    #define RS232_RX_IP         IPR3bits.RC1IP
+#else
+    #define RS232_TX_IF         PIR1bits.TXIF
+    #define RS232_TX_IE         PIE1bits.TXIE
+    #define RS232_TX_IP         IPR1bits.TXIP
+    #define RS232_RX_IF         PIR1bits.RCIF
+    #define RS232_RX_IE         PIE1bits.RCIE
+    #define RS232_RX_IP         IPR1bits.RCIP
+#endif
+
+//------------------------------------------------------------------------------
+// Local Variables
+//------------------------------------------------------------------------------
+
+// Transmit ring. The task side only writes the tail, the ISR only writes the head.
+static unsigned char g_TxBuffer[RS232_TX_BUFF_LEN];
+static volatile uint8_t g_TxHead = 0;
+static volatile uint8_t g_TxTail = 0;
+
+static RS232_TxCompleteCallback_t g_TxCompleteCallback = NULL;
+
+// Receive ring. The ISR only writes the tail, the task side only writes the head.
+static unsigned char g_RxBuffer[RS232_RX_BUFF_LEN];
+static volatile uint8_t g_RxHead = 0;
+static volatile uint8_t g_RxTail = 0;
+
+// Receive error counts. Written by the ISR only.
+static volatile RS232_RxErrorCounts_t g_RxErrors;
+
 //------------------------------------------------------------------------------
 // Function: RS232_Initialize
 // Description: This function initializes the 18LF4550 UART communication hardware.
-//      Note that the interrupts for receive and transmit are disabled.
+//      The receive interrupt is enabled and fills the receive ring. The transmit
+//      interrupt is left off until RS232_TransmitBuffer() has something to send.
 // Returns: void
 //------------------------------------------------------------------------------
 
@@ -40,6 +92,11 @@ void RS232_Initialize (void)
     // Set I/O Pin Directions
     TRISCbits.RC6 = 0;      // Port C pin 6 is Transmit.
     TRISCbits.RC7 = 1;      // Port C pin 7 is Receive.
+#ifdef _18F46K40
+    ANSELCbits.ANSELC7 = 0; // Receive pin must be digital.
+    RC6PPS = 0x09;          // EUSART1 TX out on RC6
+    RX1PPS = 0x17;          // EUSART1 RX in from RC7
+#endif
     
     // Setup Transmitter
     TXSTAbits.CSRC = 0;
@@ -70,8 +127,21 @@ void RS232_Initialize (void)
     // Reference: Use TXREG to transmit data
     // Reference: Use RCREG to receive data
     
-    PIE1bits.RCIE = 0;      // "1" enables Receive interrupt
-    PIE1bits.TXIE = 0;      // "1" enables the Transmit complete interrupt.
+    // Everything received is put in the receive ring by the receive interrupt.
+    g_RxHead = 0;
+    g_RxTail = 0;
+    g_RxErrors.m_FramingErrors = 0;
+    g_RxErrors.m_OverrunErrors = 0;
+    g_RxErrors.m_BufferOverflows = 0;
+    RS232_RX_IP = 0;        // Low priority
+    RS232_RX_IE = 1;
+    
+
+    // The transmit interrupt is only enabled while there is something in the transmit ring.
+    g_TxHead = 0;
+    g_TxTail = 0;
+    RS232_TX_IE = 0;
+    RS232_TX_IP = 0;        // Low priority
 #endif // #ifdef READY_FOR_RS232
 
 }
@@ -110,21 +180,168 @@ void RS232_TransmitChar (unsigned char item)
 
 //------------------------------------------------------------------------------
 // Function: RS232_GetReceivedChar
-// Description: Gets a character from the UART hardware.
+// Description: Gets the oldest character from the receive ring.
 // Returns: true if a character is was received
 //          false if no character received.
 //------------------------------------------------------------------------------
 bool RS232_GetReceivedChar (unsigned char *item)
 {
 #ifdef READY_FOR_RS232
-    if (PIR1bits.RCIF != 0) // non0 = we got a character
+    uint8_t head = g_RxHead;
+
+    if (head != g_RxTail)
     {
-        *item = RCREG;
+        *item = g_RxBuffer[head & RS232_RX_BUFF_IDX_MASK];
+        g_RxHead = (uint8_t)(head + 1);     // Free the slot only after it's been read.
         return true;
     }
-    *item = 0x00;
 #endif // READY_FOR_RS232
+    *item = 0x00;
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// Function: RS232_RxErrorCountsGet
+// Description: Copies the receive error counts since initialization.
+// Returns: void
+//------------------------------------------------------------------------------
+void RS232_RxErrorCountsGet (RS232_RxErrorCounts_t *counts)
+{
+    // Counts are 16 bits and the ISR may update them, so read until two reads agree.
+    do
+    {
+        counts->m_FramingErrors = g_RxErrors.m_FramingErrors;
+        counts->m_OverrunErrors = g_RxErrors.m_OverrunErrors;
+        counts->m_BufferOverflows = g_RxErrors.m_BufferOverflows;
+    } while ((counts->m_FramingErrors != g_RxErrors.m_FramingErrors)
+          || (counts->m_OverrunErrors != g_RxErrors.m_OverrunErrors)
+          || (counts->m_BufferOverflows != g_RxErrors.m_BufferOverflows));
+}
+
+//------------------------------------------------------------------------------
+// Function: RS232_TransmitBuffer
+// Description: Queues a block of characters to be sent by the transmit interrupt
+//      and returns at once. The block is queued whole or not at all.
+// Returns: true if the block was queued
+//          false if there isn't room for all of it in the transmit ring.
+//------------------------------------------------------------------------------
+bool RS232_TransmitBuffer (const unsigned char *buffer, uint8_t length)
+{
+#ifdef READY_FOR_RS232
+    uint8_t tail = g_TxTail;
+
+    if ((uint8_t)(RS232_TX_BUFF_LEN - (uint8_t)(tail - g_TxHead)) < length)
+    {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < length; ++i)
+    {
+        g_TxBuffer[tail & RS232_TX_BUFF_IDX_MASK] = buffer[i];
+        ++tail;
+    }
+    g_TxTail = tail;        // Hand the characters to the ISR only once they're all in.
+
+    RS232_TX_IE = 1;        // TXIF is already set if the UART is idle, so this starts things going.
+    return true;
+#else
     return false;
+#endif // #ifdef READY_FOR_RS232
+}
+
+//------------------------------------------------------------------------------
+// Function: RS232_TransmitIdle
+// Description: Lets the caller know whether everything queued has left the UART.
+// Returns: true if the transmit ring is empty and the last stop bit is out
+//          false if something is still being sent.
+//------------------------------------------------------------------------------
+bool RS232_TransmitIdle (void)
+{
+#ifdef READY_FOR_RS232
+    return ((g_TxHead == g_TxTail) && (TXSTAbits.TRMT == 1));
+#else
+    return true;
+#endif // #ifdef READY_FOR_RS232
+}
+
+//------------------------------------------------------------------------------
+// Function: RS232_TxCompleteCallbackSet
+// Description: Sets a function to be called when the last queued character
+//      has been handed to the UART. Called from interrupt context so keep
+//      it short. The character is still shifting out at that point, see
+//      RS232_TransmitIdle(). Pass NULL to remove the callback.
+// Returns: void
+//------------------------------------------------------------------------------
+void RS232_TxCompleteCallbackSet (RS232_TxCompleteCallback_t callback)
+{
+    g_TxCompleteCallback = callback;
+}
+
+//------------------------------------------------------------------------------
+// Function: RS232_Isr
+// Description: Services the UART interrupts. Call from the low priority ISR.
+// Returns: void
+//------------------------------------------------------------------------------
+void RS232_Isr (void)
+{
+#ifdef READY_FOR_RS232
+    // Drain everything the UART has received. It holds two characters.
+    while (RS232_RX_IE && RS232_RX_IF)
+    {
+        unsigned char item;
+        bool framing_error = (RCSTAbits.FERR != 0);    // Must be read before RCREG.
+
+        if (RCSTAbits.OERR)
+        {
+            // Receiver stops until it's reset.
+            ++g_RxErrors.m_OverrunErrors;
+            RCSTAbits.CREN = 0;
+            RCSTAbits.CREN = 1;
+        }
+
+        item = RCREG;
+
+        if (framing_error)
+        {
+            ++g_RxErrors.m_FramingErrors;
+        }
+        else if ((uint8_t)(g_RxTail - g_RxHead) >= RS232_RX_BUFF_LEN)
+        {
+            ++g_RxErrors.m_BufferOverflows;
+        }
+        else
+        {
+            g_RxBuffer[g_RxTail & RS232_RX_BUFF_IDX_MASK] = item;
+            g_RxTail = (uint8_t)(g_RxTail + 1);
+        }
+    }
+
+    if (RS232_TX_IE && RS232_TX_IF)
+    {
+        uint8_t head = g_TxHead;
+
+        // The ring may already be empty if this ISR emptied it between the task
+        // queueing characters and enabling the interrupt.
+        if (head == g_TxTail)
+        {
+            RS232_TX_IE = 0;
+            return;
+        }
+
+        TXREG = g_TxBuffer[head & RS232_TX_BUFF_IDX_MASK];
+        ++head;
+        g_TxHead = head;
+
+        if (head == g_TxTail)
+        {
+            RS232_TX_IE = 0;    // Nothing left to send.
+            if (g_TxCompleteCallback != NULL)
+            {
+                g_TxCompleteCallback();
+            }
+        }
+    }
+#endif // #ifdef READY_FOR_RS232
 }
 
 // END OF FILE
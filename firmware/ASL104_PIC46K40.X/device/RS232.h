@@ -31,6 +31,19 @@
 #define	XC_HEADER_TEMPLATE_H
 
 #include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+
+// Called from interrupt context when the transmit ring has been emptied.
+typedef void (*RS232_TxCompleteCallback_t)(void);
+
+// Receive problems seen by the receive interrupt.
+typedef struct
+{
+    uint16_t m_FramingErrors;       // Characters thrown away due to a bad stop bit.
+    uint16_t m_OverrunErrors;       // Times the UART's own 2 character FIFO overflowed.
+    uint16_t m_BufferOverflows;     // Characters thrown away because the receive ring was full.
+} RS232_RxErrorCounts_t;
 
 //------------------------------------------------------------------------------
 // Function: RS232_Initialize
@@ -59,11 +72,50 @@ void RS232_TransmitChar (unsigned char item);
 
 //------------------------------------------------------------------------------
 // Function: RS232_GetReceivedChar
-// Description: Gets a character from the UART hardware.
+// Description: Gets the oldest character from the receive ring.
 // Returns: true if a character is was received
 //          false if no character received.
 //------------------------------------------------------------------------------
 bool RS232_GetReceivedChar (unsigned char *item);
 
+//------------------------------------------------------------------------------
+// Function: RS232_RxErrorCountsGet
+// Description: Copies the receive error counts since initialization.
+// Returns: void
+//------------------------------------------------------------------------------
+void RS232_RxErrorCountsGet (RS232_RxErrorCounts_t *counts);
+
+//------------------------------------------------------------------------------
+// Function: RS232_TransmitBuffer
+// Description: Queues a block of characters to be sent by the transmit interrupt
+//      and returns at once. The block is queued whole or not at all.
+// Returns: true if the block was queued
+//          false if there isn't room for all of it in the transmit ring.
+//------------------------------------------------------------------------------
+bool RS232_TransmitBuffer (const unsigned char *buffer, uint8_t length);
+
+//------------------------------------------------------------------------------
+// Function: RS232_TransmitIdle
+// Description: Lets the caller know whether everything queued has left the UART.
+// Returns: true if the transmit ring is empty and the last stop bit is out
+//          false if something is still being sent.
+//------------------------------------------------------------------------------
+bool RS232_TransmitIdle (void);
+
+//------------------------------------------------------------------------------
+// Function: RS232_TxCompleteCallbackSet
+// Description: Sets a function to be called when the last queued character
+//      has been handed to the UART. Pass NULL to remove the callback.
+// Returns: void
+//------------------------------------------------------------------------------
+void RS232_TxCompleteCallbackSet (RS232_TxCompleteCallback_t callback);
+
+//------------------------------------------------------------------------------
+// Function: RS232_Isr
+// Description: Services the UART interrupts. Call from the low priority ISR.
+// Returns: void
+//------------------------------------------------------------------------------
+void RS232_Isr (void);
+
 #endif	/* XC_HEADER_TEMPLATE_H */
 
@@ -66,7 +66,14 @@
 
 #if defined(GENERAL_OUTPUT_CTRL_MODULE_ENABLE)
 
-#ifdef OK_TO_USE_OUTPUT_CONTROL
+/*
+ ********************************************************************************************************
+ *                                               DEFINES
+ ********************************************************************************************************
+ */
+/****************************************** Symbolic Constants ******************************************/
+/// Marks an output controller as having no state (its state table is empty or a state is undefined).
+#define NO_STATE_IDX    ((uint8_t)0xFF)
 
 /*
  ********************************************************************************************************
@@ -74,76 +81,45 @@
  ********************************************************************************************************
  */
 
-/// Information for an output controller state definition
-typedef struct
-{
-    /// Unique ID of the state.
-    GenOutState_t state;
-
-    /// If true, the state will be run through once and then stop.  Otherwise, it will loop forever.
-    bool one_shot;
-
-    /// Priority of the state. 0 is lowest, 255 is highest. e.g. if a state of prioirity 2 is running,
-    /// then any requested state change where the state is <2 priority will be denied.
-    uint8_t priority;
-
-    /// The different on/off steps for the output controller for this state.
-    GenOutCtrlStateStepDef_t *steps;
-} OutCtrlrStateDef_t;
-
 /**
- * State information for an output controller's test mode. Test mode is used to do just that:
- * test output functionality and possibly sanity check to make sure a board works.
+ * Runtime cursor for a single general output line. All state and step definitions live in the
+ * application's const state tables (program memory), so this is all the RAM an output costs.
+ *
+ * RAM per output, XC8/PIC18 (2 byte enums and data pointers):
+ *      Before: id, test state, state pointer, cursor fields and states[GEN_OUT_CTRL_STATE_MAX] of
+ *              6 byte OutCtrlrStateDef_t = 16 + (18 * 6) = 124 bytes. 10 outputs = 1240 bytes, plus
+ *              every step table copied into RAM as initialized data (5 bytes per step).
+ *      After:  6 bytes of indexes/time + 1 byte of flags = 7 bytes. 10 outputs = 70 bytes, plus one
+ *              pointer to the state tables. Step and state tables are const and stay in flash.
  */
 typedef struct
 {
-    /// True if the test state is active.
-    bool is_active;
-
-    /**
-     * Contains the most recent operational state object of the system since entering test test mode.
-     * Means nothing when not in test mode.
-    */
-    OutCtrlrStateDef_t *curr_state_obj;
-} OutCtrlrTestState_t;
-
-/// Stores all state and control information related to an output controller for a single general output line.
-typedef struct
-{
-    /// Unique ID for the output controller
-    GenOutCtrlId_t id;
+    /// Index into this output's state table of the current operational state.
+    uint8_t curr_state_idx;
 
-    /// Holds test mode information.
-    OutCtrlrTestState_t test_state;
-
-    /// Current state's control object.
-    OutCtrlrStateDef_t *curr_state_obj;
+    /// Index of the operational state to go back to when leaving test mode.
+    uint8_t test_return_state_idx;
 
     /// Current step for the operational state of the output controller.
-    uint16_t curr_index;
+    uint8_t curr_index;
+
+    /// Number of times repeated at the current stage.
+    uint8_t num_times_run;
 
     /// Time elapsed, in ms, since entering the current step.
     GenOutCtrlTime_t time_elapsed_ms;
 
     /// Let's the controller know whether the output is currently active or inactive.
-    bool output_is_active;
+    unsigned output_is_active : 1;
 
     /// True if under automatic timing control by this module, false if timer control exists outside of this module.
-    bool is_active;
-
-    /// The total number of states that are defined for this output control state.
-    /// Cannot exceed the value of GEN_OUT_CTRL_STATE_MAX!
-    uint8_t num_states;
+    unsigned is_active : 1;
 
     /// Only used when a state is one shot.  When false, the state is still running, when true, it is not.
-    bool one_shot_complete;
-
-    /// Number of times repeated at the current stage.
-    uint8_t num_times_run;
+    unsigned one_shot_complete : 1;
 
-    /// Definitions for all states that an output controller can be in
-    /// @todo Turn this into a singly-linked list so as to reduce the RAM footprint of this module
-    OutCtrlrStateDef_t states[GEN_OUT_CTRL_STATE_MAX];
+    /// True if the output controller is in test mode.
+    unsigned test_mode_active : 1;
 } OutputCtrlrState_t;
 
 /*
@@ -178,8 +154,11 @@ static GenOutCtrl_AppCbFunc_t AppRtosCb_Deinit = NULL;
 /// True when all module components are initialized
 static bool module_is_initialized = false;
 
-/// Master control structure array for all output state controllers
-OutputCtrlrState_t state_ctrl[(int)GEN_OUT_CTRL_ID_MAX];
+/// State definitions for every output controller, indexed by GenOutCtrlId_t. Owned by the application.
+static const GenOutCtrlStateTable_t *state_tables = NULL;
+
+/// Runtime cursor for all output state controllers
+static OutputCtrlrState_t state_ctrl[(int)GEN_OUT_CTRL_ID_MAX];
 
 /*
  ********************************************************************************************************
@@ -187,10 +166,12 @@ OutputCtrlrState_t state_ctrl[(int)GEN_OUT_CTRL_ID_MAX];
  ********************************************************************************************************
  */
 
-static bool StateCtrlr_NextControlSubstep(OutputCtrlrState_t *ctrl);
-static bool StateCtrlr_EndOfList(OutputCtrlrState_t *ctrl);
-static bool IsStateDefined(GenOutCtrlId_t item_id, GenOutState_t state);
-static OutCtrlrStateDef_t *StateControlObject_Get(GenOutCtrlId_t item_id, GenOutState_t state);
+static bool StateCtrlr_NextControlSubstep(GenOutCtrlId_t item_id);
+static bool StateCtrlr_EndOfList(GenOutCtrlId_t item_id);
+static const GenOutCtrlStateDef_t *StateCtrlr_CurrState(GenOutCtrlId_t item_id);
+static const GenOutCtrlStateStepDef_t *StateCtrlr_CurrStep(GenOutCtrlId_t item_id);
+static uint8_t StateIndexGet(GenOutCtrlId_t item_id, GenOutState_t state);
+static GenOutCtrlTime_t StateCtrlr_TimeToTransition(GenOutCtrlId_t item_id);
 static void InitControlData(void);
 static void ResetControlData(GenOutCtrlId_t item_id);
 
@@ -221,14 +202,14 @@ static bool DefaultCbFunc(void);
 bool GenOutCtrl_Init(bool is_bare_metal)
 {
     bool ret_val = true;
-    
+
     if (AppBaremetalCb_Init == NULL)
     {
         AppBaremetalCb_Init = DefaultCbFunc;
         AppBaremetalCb_Deinit = DefaultCbFunc;
         AppRtosCb_Init = DefaultCbFunc;
         AppRtosCb_Deinit = DefaultCbFunc;
-        
+
 #if defined(GENERAL_OUTPUT_CTRL_USE_MUTEX)
         AppRtosCb_MutexLock = DefaultCbFunc;
         AppRtosCb_MutexUnlock = DefaultCbFunc;
@@ -298,7 +279,7 @@ bool GenOutCtrl_Init(bool is_bare_metal)
             }
         }
     }
-    
+
     return ret_val;
 }
 
@@ -332,7 +313,8 @@ bool GenOutCtrl_Deinit(void)
             ret_val = false;
         }
 
-        // Wipe out all assigned states and state data for all output controllers.
+        // Forget the state tables and wipe out all state data for all output controllers.
+        state_tables = NULL;
         InitControlData();
 
         module_is_initialized = false;
@@ -342,42 +324,49 @@ bool GenOutCtrl_Deinit(void)
 }
 
 /**
- * Add a new state to an output controller.
+ * Hands the output controllers their state definitions.
  *
- * @param item_id   ID of the output control item that is to be modified
- * @param state 	State to add to the controller.
- * @param one_shot 	If true, the state is run through one and then control is stopped, else
- * 					control lasts until told to stop.
- * @param priority  State priority. 0 is lowest and 255 is highest.
- * @param steps 	Contains the on and off time definitions for the state.
+ * @param tables    One state table per output controller, indexed by GenOutCtrlId_t. The tables, their
+ *                  state lists and step lists must remain valid for as long as this module is in use,
+ *                  which in practice means they are const and live in program memory.
+ *
+ * @return          True if the tables were taken, false if an output controller is under automatic control.
  *
- * @return  		True if the state was added successfully false if state has already been defined.
+ * @note            The first state in each output's table is the initial state of that output.
  */
-bool GenOutCtrl_AddState(GenOutCtrlId_t item_id, GenOutState_t state, bool one_shot, uint8_t priority, GenOutCtrlStateStepDef_t *steps)
+bool GenOutCtrl_StateTablesSet(const GenOutCtrlStateTable_t *tables)
 {
-	if (IsStateDefined(item_id, state) || (state_ctrl[item_id].num_states >= GEN_OUT_CTRL_STATE_MAX))
-	{
-		return false;
-	}
-	else
-	{
-		state_ctrl[item_id].states[state_ctrl[item_id].num_states].steps = steps;
-		state_ctrl[item_id].states[state_ctrl[item_id].num_states].one_shot = one_shot;
-        state_ctrl[item_id].states[state_ctrl[item_id].num_states].state = state;
-        state_ctrl[item_id].states[state_ctrl[item_id].num_states].priority = priority;
-
-        // Set initial state to prevent system crash if user forgets to set a valid state
-        // before enabling the module to start running.
-        if (state_ctrl[item_id].curr_state_obj == (OutCtrlrStateDef_t *)NULL)
+    bool ret_val = true;
+
+    LockMutex();
+
+    for (unsigned int i = 0; i < (unsigned int)GEN_OUT_CTRL_ID_MAX; i++)
+    {
+        if (state_ctrl[i].is_active)
+        {
+            ret_val = false;
+        }
+    }
+
+    if (ret_val)
+    {
+        state_tables = tables;
+
+        for (unsigned int i = 0; i < (unsigned int)GEN_OUT_CTRL_ID_MAX; i++)
         {
-            state_ctrl[item_id].curr_state_obj = &state_ctrl[item_id].states[state_ctrl[item_id].num_states];
-            state_ctrl[item_id].test_state.curr_state_obj = state_ctrl[item_id].curr_state_obj;
+            ASSERT(tables[i].num_states < NO_STATE_IDX);
+
+            // Set initial state to prevent system crash if user forgets to set a valid state
+            // before enabling the module to start running.
+            state_ctrl[i].curr_state_idx = (tables[i].num_states > 0) ? 0 : NO_STATE_IDX;
+            state_ctrl[i].test_return_state_idx = state_ctrl[i].curr_state_idx;
+            ResetControlData((GenOutCtrlId_t)i);
         }
+    }
 
-        state_ctrl[item_id].num_states++;
+    UnlockMutex();
 
-		return true;
-	}
+    return ret_val;
 }
 
 /**
@@ -388,20 +377,45 @@ bool GenOutCtrl_AddState(GenOutCtrlId_t item_id, GenOutState_t state, bool one_s
  * @param time_elapsed_ms 	Amount of time passed since the last time this function has been called.
  *        					Must be accurate and precise!
  *
- * @return true if the update succeeded, false if it failed
+ * @return Time, in ms, until the next on/off transition of any output controller, or
+ *         GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL if no output controller has a transition coming up.
+ *         The caller may sleep this long before calling again without missing a transition.
  */
-bool GenOutCtrl_TickUpdateAll_ms(GenOutCtrlTime_t time_elapsed_ms)
+GenOutCtrlTime_t GenOutCtrl_TickUpdateAll_ms(GenOutCtrlTime_t time_elapsed_ms)
 {
-    bool ret_val = true;
-
     for (unsigned int i = 0; i < (uint8_t)GEN_OUT_CTRL_ID_MAX; i++)
     {
-        if (!GenOutCtrl_TickUpdate_ms(time_elapsed_ms, (GenOutCtrlId_t)i))
+        (void)GenOutCtrl_TickUpdate_ms(time_elapsed_ms, (GenOutCtrlId_t)i);
+    }
+
+    return GenOutCtrl_NextTransitionGet_ms();
+}
+
+/**
+ * Finds the earliest upcoming on/off transition across all output controllers under automatic control.
+ *
+ * @return Time, in ms, until the next transition, or GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL if there is none.
+ *
+ * @note A return of 0 means a transition is already due.
+ */
+GenOutCtrlTime_t GenOutCtrl_NextTransitionGet_ms(void)
+{
+    GenOutCtrlTime_t ret_val = GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL;
+
+    LockMutex();
+
+    for (unsigned int i = 0; i < (unsigned int)GEN_OUT_CTRL_ID_MAX; i++)
+    {
+        GenOutCtrlTime_t time_left = StateCtrlr_TimeToTransition((GenOutCtrlId_t)i);
+
+        if (time_left < ret_val)
         {
-            ret_val = false;
+            ret_val = time_left;
         }
     }
 
+    UnlockMutex();
+
     return ret_val;
 }
 
@@ -426,10 +440,11 @@ bool GenOutCtrl_TickUpdate_ms(GenOutCtrlTime_t time_elapsed_ms, GenOutCtrlId_t i
     {
         bool go_to_next_substep = false;
         bool go_to_next_step = false;
+        const GenOutCtrlStateStepDef_t *step = StateCtrlr_CurrStep(item_id);
 
         // Do the below for code clarity in the decision logic below these two definitions.
-        GenOutCtrlTime_t on_time = state_ctrl[item_id].curr_state_obj->steps[state_ctrl[item_id].curr_index].on_time_ms;
-        GenOutCtrlTime_t off_time = state_ctrl[item_id].curr_state_obj->steps[state_ctrl[item_id].curr_index].off_time_ms;
+        GenOutCtrlTime_t on_time = step->on_time_ms;
+        GenOutCtrlTime_t off_time = step->off_time_ms;
 
         state_ctrl[item_id].time_elapsed_ms += time_elapsed_ms;
 
@@ -453,7 +468,7 @@ bool GenOutCtrl_TickUpdate_ms(GenOutCtrlTime_t time_elapsed_ms, GenOutCtrlId_t i
         if (go_to_next_step)
         {
             state_ctrl[item_id].num_times_run++;
-            if (state_ctrl[item_id].num_times_run >= state_ctrl[item_id].curr_state_obj->steps[state_ctrl[item_id].curr_index].num_times_to_run)
+            if (state_ctrl[item_id].num_times_run >= step->num_times_to_run)
             {
                 (state_ctrl[item_id].curr_index)++;
                 state_ctrl[item_id].num_times_run = 0;
@@ -463,7 +478,7 @@ bool GenOutCtrl_TickUpdate_ms(GenOutCtrlTime_t time_elapsed_ms, GenOutCtrlId_t i
         // Go to the next substep if required.
         if (go_to_next_substep || go_to_next_step)
         {
-            (void)StateCtrlr_NextControlSubstep(&state_ctrl[item_id]);
+            (void)StateCtrlr_NextControlSubstep(item_id);
         }
     }
 
@@ -522,13 +537,13 @@ bool GenOutCtrl_Start(GenOutCtrlId_t item_id)
 
     LockMutex();
 
-    if (!state_ctrl[item_id].is_active)
+    if (!state_ctrl[item_id].is_active && (StateCtrlr_CurrState(item_id) != NULL))
     {
-        if (!StateCtrlr_EndOfList(&state_ctrl[item_id]))
+        if (!StateCtrlr_EndOfList(item_id))
         {
             ResetControlData(item_id);
             state_ctrl[item_id].is_active = true;
-            (void)StateCtrlr_NextControlSubstep(&state_ctrl[item_id]);
+            (void)StateCtrlr_NextControlSubstep(item_id);
             ret_val = true;
         }
     }
@@ -595,18 +610,21 @@ bool GenOutCtrl_StateSet(GenOutCtrlId_t item_id, GenOutState_t new_state)
 
     LockMutex();
 
-    if (IsStateDefined(item_id, new_state))
+    uint8_t new_state_idx = StateIndexGet(item_id, new_state);
+
+    if (new_state_idx != NO_STATE_IDX)
     {
-        OutCtrlrStateDef_t *temp_state_obj_ptr = StateControlObject_Get(item_id, new_state);
+        const GenOutCtrlStateDef_t *curr_state_obj = StateCtrlr_CurrState(item_id);
+        const GenOutCtrlStateDef_t *new_state_obj = &state_tables[item_id].states[new_state_idx];
 
-        if ((state_ctrl[item_id].curr_state_obj->priority <= temp_state_obj_ptr->priority) &&
-            ((state_ctrl[item_id].curr_state_obj->state != new_state) || state_ctrl[item_id].one_shot_complete))
+        if ((curr_state_obj->priority <= new_state_obj->priority) &&
+            ((curr_state_obj->state != new_state) || state_ctrl[item_id].one_shot_complete))
         {
-            if (state_ctrl[item_id].test_state.is_active)
+            if (state_ctrl[item_id].test_mode_active)
             {
                 // In test mode, so we will set the state that the system will jump to after kicking out
                 // of test mode.
-                state_ctrl[item_id].test_state.curr_state_obj = StateControlObject_Get(item_id, new_state);
+                state_ctrl[item_id].test_return_state_idx = new_state_idx;
             }
             else
             {
@@ -616,14 +634,14 @@ bool GenOutCtrl_StateSet(GenOutCtrlId_t item_id, GenOutState_t new_state)
                 // Ordering below is important! Do not change!
                 state_ctrl[item_id].is_active = false; // Must be before the reset data call below
                 ResetControlData(item_id);
-                state_ctrl[item_id].curr_state_obj = temp_state_obj_ptr;
-                
+                state_ctrl[item_id].curr_state_idx = new_state_idx;
+
                 if (temp_is_active)
                 {
-                    if (StateCtrlr_EndOfList(&state_ctrl[item_id]))
+                    if (StateCtrlr_EndOfList(item_id))
                     {
                         // If in a "do nothing at all" state, simply ensure that the output is turned off.
-                        GenOutCtrlBsp_SetInactive(state_ctrl[item_id].id);
+                        GenOutCtrlBsp_SetInactive(item_id);
                     }
                     else
                     {
@@ -631,7 +649,7 @@ bool GenOutCtrl_StateSet(GenOutCtrlId_t item_id, GenOutState_t new_state)
                         state_ctrl[item_id].is_active = true;
 
                         // Sets the state machine off with the output in the right state (on or off)
-                        (void)StateCtrlr_NextControlSubstep(&state_ctrl[item_id]);
+                        (void)StateCtrlr_NextControlSubstep(item_id);
                     }
                 }
             }
@@ -671,7 +689,7 @@ bool GenOutCtrl_AtLeastOneOutputCtrlrIsActive(void)
 bool GenOutCtrl_OutputCtrlrIsActive(GenOutCtrlId_t item_id)
 {
     if (state_ctrl[item_id].is_active && !state_ctrl[item_id].one_shot_complete &&
-       (state_ctrl[item_id].curr_state_obj->steps[state_ctrl[item_id].curr_index].off_time_ms != GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL))
+       (StateCtrlr_CurrStep(item_id)->off_time_ms != GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL))
     {
         return true;
     }
@@ -686,15 +704,19 @@ bool GenOutCtrl_OutputCtrlrIsActive(GenOutCtrlId_t item_id)
  *
  * @param item_id Id of the output controller.
  *
- * @return ID of the current operating state of the output controller
+ * @return ID of the current operating state of the output controller, GEN_OUT_CTRL_STATE_IDLE if the
+ *         output controller has no states defined.
  */
 GenOutState_t GenOutCtrl_OutputCtrlrStateGet(GenOutCtrlId_t item_id)
 {
-    GenOutState_t ret_val;
+    GenOutState_t ret_val = GEN_OUT_CTRL_STATE_IDLE;
 
     LockMutex();
 
-    ret_val = state_ctrl[item_id].curr_state_obj->state;
+    if (StateCtrlr_CurrState(item_id) != NULL)
+    {
+        ret_val = StateCtrlr_CurrState(item_id)->state;
+    }
 
     UnlockMutex();
 
@@ -954,7 +976,7 @@ bool GenOutCtrl_TestModeSetAll(bool make_active)
  * @param item_id       ID of the output control item that is to be modified
  * @param make_active    If true then the output controller goes into test mode, otherwise kick out of test mode.
  *
- * @return true if the update succeeded, false if it failed.
+ * @return true if the update succeeded, false if the output controller has no test state defined.
  *
  * @note All state control variables are reset.  Also, if the output controller was running before this function
  *       was called, then it remains running after the call.
@@ -962,22 +984,29 @@ bool GenOutCtrl_TestModeSetAll(bool make_active)
 bool GenOutCtrl_TestModeSet(GenOutCtrlId_t item_id, bool make_active)
 {
     // Only put the output controller into test mode if it is not already in test mode.
-    if (state_ctrl[item_id].test_state.is_active != make_active)
+    if ((bool)state_ctrl[item_id].test_mode_active != make_active)
     {
-        state_ctrl[item_id].test_state.is_active = make_active;
+        uint8_t test_state_idx = StateIndexGet(item_id, GEN_OUT_STATE_CTRL_TEST);
+
+        if (make_active && (test_state_idx == NO_STATE_IDX))
+        {
+            return false;
+        }
+
+        state_ctrl[item_id].test_mode_active = make_active;
 
         bool temp_is_active = state_ctrl[item_id].is_active;
         state_ctrl[item_id].is_active = false; // Must be before the reset data call below
         ResetControlData(item_id); // Put controller into test idle state
 
-        if (state_ctrl[item_id].test_state.is_active)
+        if (make_active)
         {
-            state_ctrl[item_id].test_state.curr_state_obj = state_ctrl[item_id].curr_state_obj;
-            state_ctrl[item_id].curr_state_obj = StateControlObject_Get(item_id, GEN_OUT_STATE_CTRL_TEST);
+            state_ctrl[item_id].test_return_state_idx = state_ctrl[item_id].curr_state_idx;
+            state_ctrl[item_id].curr_state_idx = test_state_idx;
         }
         else
         {
-            state_ctrl[item_id].curr_state_obj = state_ctrl[item_id].test_state.curr_state_obj;
+            state_ctrl[item_id].curr_state_idx = state_ctrl[item_id].test_return_state_idx;
         }
 
         // Re-enable the output controller if it was active before the state change.
@@ -999,52 +1028,54 @@ bool GenOutCtrl_TestModeSet(GenOutCtrlId_t item_id, bool make_active)
 /**
  * Goes to the next valid sub-step in the state step-list.
  *
- * @param ctrl Pointer to the output controller state object
+ * @param item_id   ID of the output controller
  *
  * @return true if the update succeeded, false if it failed
  *
  * @note Mutex control must be handled outside of this function
  */
-static bool StateCtrlr_NextControlSubstep(OutputCtrlrState_t *ctrl)
+static bool StateCtrlr_NextControlSubstep(GenOutCtrlId_t item_id)
 {
+    OutputCtrlrState_t *ctrl = &state_ctrl[item_id];
+
     if (ctrl->output_is_active)
     {
-        if (ctrl->curr_state_obj->steps[ctrl->curr_index].off_time_ms > 0)
+        if (StateCtrlr_CurrStep(item_id)->off_time_ms > 0)
         {
             ctrl->output_is_active = false;
-            (void)GenOutCtrlBsp_SetInactive(ctrl->id);
+            (void)GenOutCtrlBsp_SetInactive(item_id);
         }
         else
         {
             (ctrl->curr_index)++;
-            if (StateCtrlr_EndOfList(ctrl))
+            if (StateCtrlr_EndOfList(item_id))
             {
                 // At end of the list
                 ctrl->curr_index = 0;
-                ASSERT(!StateCtrlr_EndOfList(ctrl)); // Critical error...this should never be allowed to happen.
+                ASSERT(!StateCtrlr_EndOfList(item_id)); // Critical error...this should never be allowed to happen.
             }
 
-            if (ctrl->curr_state_obj->one_shot)
+            if (StateCtrlr_CurrState(item_id)->one_shot)
             {
                 ctrl->one_shot_complete = true;
             }
-            else if (ctrl->curr_state_obj->steps[ctrl->curr_index].on_time_ms > 0)
+            else if (StateCtrlr_CurrStep(item_id)->on_time_ms > 0)
             {
-                (void)GenOutCtrlBsp_SetActive(ctrl->id);
+                (void)GenOutCtrlBsp_SetActive(item_id);
                 ctrl->output_is_active = true;
             }
             else
             {
-                (void)GenOutCtrlBsp_SetInactive(ctrl->id);
+                (void)GenOutCtrlBsp_SetInactive(item_id);
                 ctrl->output_is_active = false;
             }
         }
     }
     else
     {
-        if (StateCtrlr_EndOfList(ctrl))
+        if (StateCtrlr_EndOfList(item_id))
         {
-            if (ctrl->curr_state_obj->one_shot)
+            if (StateCtrlr_CurrState(item_id)->one_shot)
             {
                 ctrl->one_shot_complete = true;
             }
@@ -1055,16 +1086,16 @@ static bool StateCtrlr_NextControlSubstep(OutputCtrlrState_t *ctrl)
 
         if (ctrl->is_active && !ctrl->one_shot_complete)
         {
-            if (ctrl->curr_state_obj->steps[ctrl->curr_index].on_time_ms > 0)
+            if (StateCtrlr_CurrStep(item_id)->on_time_ms > 0)
             {
                 ctrl->output_is_active = true;
-                (void)GenOutCtrlBsp_SetActive(ctrl->id);
+                (void)GenOutCtrlBsp_SetActive(item_id);
             }
             else
             {
                 // The below should already be set. Set it again for good measure...
                 ctrl->output_is_active = false;
-                (void)GenOutCtrlBsp_SetInactive(ctrl->id);
+                (void)GenOutCtrlBsp_SetInactive(item_id);
             }
         }
     }
@@ -1075,17 +1106,19 @@ static bool StateCtrlr_NextControlSubstep(OutputCtrlrState_t *ctrl)
 /**
  * Checks to see if we are at the end of the output state controller step list.
  *
- * @param ctrl Pointer to the output state control & definition structure
+ * @param item_id   ID of the output controller
  *
  * @return true if at the end of the step list, false if not at the end of the list.
  *
  * @note Mutex control must be handled outside of this function
  */
-static bool StateCtrlr_EndOfList(OutputCtrlrState_t *ctrl)
+static bool StateCtrlr_EndOfList(GenOutCtrlId_t item_id)
 {
-    if ((ctrl->curr_state_obj != NULL) &&
-        (ctrl->curr_state_obj->steps[ctrl->curr_index].off_time_ms == GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL) &&
-        (ctrl->curr_state_obj->steps[ctrl->curr_index].on_time_ms == GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL))
+    const GenOutCtrlStateStepDef_t *step = StateCtrlr_CurrStep(item_id);
+
+    if ((step != NULL) &&
+        (step->off_time_ms == GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL) &&
+        (step->on_time_ms == GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL))
     {
         return true;
     }
@@ -1096,46 +1129,104 @@ static bool StateCtrlr_EndOfList(OutputCtrlrState_t *ctrl)
 }
 
 /**
- * Figures out where new state information should go.
+ * Gets the definition of the state an output controller is currently in.
  *
- * @param item_id   ID of the output control item that is to be modified
- * @param state 	State to check for definition in the controller.
+ * @param item_id   ID of the output controller
  *
- * @return			true if state is already defined, false if it is not defined.
+ * @return          Pointer to the const state definition, NULL if the output controller has no state.
  */
-static bool IsStateDefined(GenOutCtrlId_t item_id, GenOutState_t state)
+static const GenOutCtrlStateDef_t *StateCtrlr_CurrState(GenOutCtrlId_t item_id)
 {
-	for (uint8_t i = 0; i < state_ctrl[item_id].num_states; i++)
-	{
-		if (state_ctrl[item_id].states[i].state == state)
-		{
-			return true;
-		}
-	}
+    if ((state_tables == NULL) || (state_ctrl[item_id].curr_state_idx == NO_STATE_IDX))
+    {
+        return (const GenOutCtrlStateDef_t *)NULL;
+    }
 
-	return false;
+    return &state_tables[item_id].states[state_ctrl[item_id].curr_state_idx];
 }
 
 /**
- * Grabs the state control object for a particular state for a particular output controller.
+ * Gets the step an output controller is currently on.
+ *
+ * @param item_id   ID of the output controller
+ *
+ * @return          Pointer to the const step definition, NULL if the output controller has no state.
+ */
+static const GenOutCtrlStateStepDef_t *StateCtrlr_CurrStep(GenOutCtrlId_t item_id)
+{
+    const GenOutCtrlStateDef_t *state_obj = StateCtrlr_CurrState(item_id);
+
+    if (state_obj == NULL)
+    {
+        return (const GenOutCtrlStateStepDef_t *)NULL;
+    }
+
+    return &state_obj->steps[state_ctrl[item_id].curr_index];
+}
+
+/**
+ * Finds where a state lives in an output controller's state table.
  *
  * @param item_id   ID of the output control item that is to be modified
- * @param state     State definition to pull from the controller.
+ * @param state     State to look up.
  *
- * @note            The state is already checked for definition prior to this function call.
+ * @return          Index of the state in the output's state table, NO_STATE_IDX if it is not defined.
  */
-static OutCtrlrStateDef_t *StateControlObject_Get(GenOutCtrlId_t item_id, GenOutState_t state)
+static uint8_t StateIndexGet(GenOutCtrlId_t item_id, GenOutState_t state)
 {
-    for (uint8_t i = 0; i < state_ctrl[item_id].num_states; i++)
+    if (state_tables != NULL)
     {
-        if (state_ctrl[item_id].states[i].state == state)
+        for (uint8_t i = 0; i < state_tables[item_id].num_states; i++)
         {
-            return &state_ctrl[item_id].states[i];
+            if (state_tables[item_id].states[i].state == state)
+            {
+                return i;
+            }
         }
     }
 
-    ASSERT(false);
-    return (OutCtrlrStateDef_t *)NULL;
+    return NO_STATE_IDX;
+}
+
+/**
+ * Works out how long until an output controller's current step changes the output.
+ *
+ * @param item_id   ID of the output controller
+ *
+ * @return          Time, in ms, until the next transition, or GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL if the
+ *                  output controller is stopped, finished, or parked in an "always" step.
+ *
+ * @note Mutex control must be handled outside of this function
+ */
+static GenOutCtrlTime_t StateCtrlr_TimeToTransition(GenOutCtrlId_t item_id)
+{
+    GenOutCtrlTime_t step_time;
+
+    if (!state_ctrl[item_id].is_active || state_ctrl[item_id].one_shot_complete)
+    {
+        return GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL;
+    }
+
+    if (state_ctrl[item_id].output_is_active)
+    {
+        step_time = StateCtrlr_CurrStep(item_id)->on_time_ms;
+    }
+    else
+    {
+        step_time = StateCtrlr_CurrStep(item_id)->off_time_ms;
+    }
+
+    if (step_time == GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL)
+    {
+        return GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL;
+    }
+
+    if (state_ctrl[item_id].time_elapsed_ms >= step_time)
+    {
+        return 0;
+    }
+
+    return step_time - state_ctrl[item_id].time_elapsed_ms;
 }
 
 /**
@@ -1147,12 +1238,9 @@ static void InitControlData(void)
 {
 	for (unsigned int i = 0; i < (unsigned int)GEN_OUT_CTRL_ID_MAX; i++)
 	{
-		state_ctrl[(GenOutCtrlId_t)i].id = (GenOutCtrlId_t)i;
-		state_ctrl[(GenOutCtrlId_t)i].num_states = 0;// No states defined yet.
-        state_ctrl[(GenOutCtrlId_t)i].curr_state_obj = (OutCtrlrStateDef_t *)NULL;
-        state_ctrl[(GenOutCtrlId_t)i].num_times_run = 0;
-        state_ctrl[(GenOutCtrlId_t)i].test_state.curr_state_obj = (OutCtrlrStateDef_t *)NULL;
-		state_ctrl[(GenOutCtrlId_t)i].test_state.is_active = false; // Test mode is not active.
+        state_ctrl[(GenOutCtrlId_t)i].curr_state_idx = NO_STATE_IDX;
+        state_ctrl[(GenOutCtrlId_t)i].test_return_state_idx = NO_STATE_IDX;
+		state_ctrl[(GenOutCtrlId_t)i].test_mode_active = false; // Test mode is not active.
         state_ctrl[(GenOutCtrlId_t)i].is_active = false;
 
 		ResetControlData((GenOutCtrlId_t)i);
@@ -1179,7 +1267,7 @@ static void ResetControlData(GenOutCtrlId_t item_id)
     if (!state_ctrl[item_id].is_active)
     {
         state_ctrl[item_id].output_is_active = false;
-        
+
         // Make sure the output is inactive.
         (void)GenOutCtrlBsp_SetInactive(item_id);
     }
@@ -1228,8 +1316,6 @@ static bool DefaultCbFunc(void)
 // End of Doxygen grouping
 /** @} */
 
-#endif // #ifdef OK_TO_USE_OUTPUT_CONTROL
-
 #endif
 
 /**********************************************************************************************************************
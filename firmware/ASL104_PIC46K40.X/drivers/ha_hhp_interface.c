@@ -52,34 +52,27 @@ void haHhp_Init(void)
 }
 
 //-------------------------------
-// Function: haHhp_RxPacket
+// Function: haHhp_RxPacketStart
 //
-// Description: Reads in an ensure packet from over the HHP communications interface.
+// Description: Starts reading in a packet from over the HHP communications interface. The bytes
+//		are collected in the background, check on them with haHhp_RxPacketStatus().
 //
-// return: true: read in packet, false: timed out trying to read in packet.
 //-------------------------------
-bool haHhp_RxPacket(uint8_t *rx_buff)
+void haHhp_RxPacketStart(uint8_t *rx_buff)
 {
-	bool ret_val = true;
-
-	// Receive the length of the packet
-	if (haHhpBsp_RxByte(&rx_buff[0]) &&
-		(rx_buff[0] <= HHP_RX_TX_BUFF_LEN))
-	{
-		// Get the rest of the packet.
-		// Start at 1 because the message length byte itself is in the packet and required for the checksum calc
-		for (unsigned int i = 1; (i < rx_buff[0]) && ret_val; i++)
-		{
-			ret_val = haHhpBsp_RxByte(&rx_buff[i]);
-		}
-	}
-	else
-	{
-		// Message is too long or timed out.
-		ret_val = false;
-	}
+	haHhpBsp_RxStart(rx_buff, HHP_RX_TX_BUFF_LEN);
+}
 
-	return ret_val;
+//-------------------------------
+// Function: haHhp_RxPacketStatus
+//
+// Description: Lets the caller know whether the packet started by haHhp_RxPacketStart() is in.
+//		The length byte has been checked against the buffer size, the checksum has not.
+//
+//-------------------------------
+HaHhpBspRxStatus_t haHhp_RxPacketStatus(void)
+{
+	return haHhpBsp_RxStatusGet();
 }
 
 // end of file.
@@ -97,6 +97,37 @@ typedef struct
     uint8_t num_times_to_run;
 } GenOutCtrlStateStepDef_t;
 
+/// Information for an output controller state definition
+typedef struct
+{
+    /// Unique ID of the state.
+    GenOutState_t state;
+
+    /// If true, the state will be run through once and then stop.  Otherwise, it will loop forever.
+    bool one_shot;
+
+    /// Priority of the state. 0 is lowest, 255 is highest. e.g. if a state of prioirity 2 is running,
+    /// then any requested state change where the state is <2 priority will be denied.
+    uint8_t priority;
+
+    /// The different on/off steps for the output controller for this state. Must end with GEN_OUT_CTRL_END_OF_STATE.
+    const GenOutCtrlStateStepDef_t *steps;
+} GenOutCtrlStateDef_t;
+
+/**
+ * All states an output controller can be put in.
+ *
+ * @note The first state in the list is the state the output controller starts in.
+ */
+typedef struct
+{
+    /// List of state definitions.
+    const GenOutCtrlStateDef_t *states;
+
+    /// Number of entries in the state list.
+    uint8_t num_states;
+} GenOutCtrlStateTable_t;
+
 /*
  ********************************************************************************************************
  *                                             FUNCTION PROTOTYPES
@@ -106,8 +137,9 @@ typedef struct
 #if defined(GENERAL_OUTPUT_CTRL_MODULE_ENABLE)
 	bool GenOutCtrl_Init(bool is_bare_metal);
 	bool GenOutCtrl_Deinit(void);
-	bool GenOutCtrl_AddState(GenOutCtrlId_t item_id, GenOutState_t state, bool one_shot, uint8_t priority, GenOutCtrlStateStepDef_t *steps);
-	bool GenOutCtrl_TickUpdateAll_ms(GenOutCtrlTime_t time_elapsed_ms);
+	bool GenOutCtrl_StateTablesSet(const GenOutCtrlStateTable_t *tables);
+	GenOutCtrlTime_t GenOutCtrl_TickUpdateAll_ms(GenOutCtrlTime_t time_elapsed_ms);
+	GenOutCtrlTime_t GenOutCtrl_NextTransitionGet_ms(void);
 	bool GenOutCtrl_TickUpdate_ms(GenOutCtrlTime_t time_elapsed_ms, GenOutCtrlId_t item_id);
 	bool GenOutCtrl_StartAll(void);
 	bool GenOutCtrl_StopAll(void);
@@ -147,7 +179,9 @@ typedef struct
 	// this module is disabled.
 	#define GenOutCtrl_Init(x) true
 	#define GenOutCtrl_Deinit(void) true
-	#define GenOutCtrl_TickUpdateAll_ms(x) true
+	#define GenOutCtrl_StateTablesSet(x) true
+	#define GenOutCtrl_TickUpdateAll_ms(x) GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL
+	#define GenOutCtrl_NextTransitionGet_ms() GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL
 	#define GenOutCtrl_TickUpdate_ms(x, y) true
 	#define GenOutCtrl_StartAll() true
 	#define GenOutCtrl_StopAll() true
@@ -19,15 +19,20 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// from project
+#include "ha_hhp_interface_bsp.h"
+
 /* ******************************   Macros   ****************************** */
 
-// Length of the HHP communications rx/tx buffer
-#define HHP_RX_TX_BUFF_LEN (8)
+// Length of the HHP communications rx/tx buffer. Big enough for a PARAMETERS_GET/SET packet
+// to carry half of the stored items, so a whole configuration goes across in two exchanges.
+#define HHP_RX_TX_BUFF_LEN (64)
 
 /* ***********************   Function Prototypes   ************************ */
 
 void haHhp_Init(void);
-bool haHhp_RxPacket(uint8_t *rx_buff);
+void haHhp_RxPacketStart(uint8_t *rx_buff);
+HaHhpBspRxStatus_t haHhp_RxPacketStatus(void);
 
 #endif // End of HA_HHP_INTERFACE_H_
 
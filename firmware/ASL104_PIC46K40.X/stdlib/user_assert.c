@@ -15,9 +15,16 @@
 
 /* **************************   Header Files   *************************** */
 
+// NOTE: This must ALWAYS be the first include in a file.
+#include "device.h"
+
 // from stdlib
 #include <stdint.h>
 
+// from project
+#include "eeprom_bsp.h"
+#include "event_log.h"
+
 // from local
 #include "user_assert.h"
 
@@ -34,9 +41,23 @@ static volatile uint16_t _line;
 //-------------------------------
 void assertion_trap(char *file, uint16_t line)
 {
+	// Nothing else runs from here on. This may be called from an interrupt, where the EEPROM
+	// interrupt can't get in to finish the writes, so turn them all off. eepromBspWriteWait()
+	// then services the EEPROM itself.
+	INTCONbits.GIEH = 0;
+	INTCONbits.GIEL = 0;
+
 	_file = file;
 	_line = line;
 
+	// Leave a record. Nothing else will flush the log from here on, so wait for it to go in.
+	// A read back of the log that was under way won't finish now.
+	eventLogAdd(EVENT_LOG_ASSERT, line);
+	eventLogReadEnd();
+	eepromBspWriteWait();
+	eventLogFlush();
+	eepromBspWriteWait();
+
 	// TODO: Put the system into a safe state.
 	
 	// Can view the file and line here.
@@ -30,6 +30,9 @@
     #define ASSERT(test) (0)
 #endif
 
+// Checked by the compiler. Fails the build with a negative array size if test is false.
+#define STATIC_ASSERT(test, name) typedef char static_assert_##name[(test) ? 1 : -1]
+
 /* ***********************   Function Prototypes   ************************ */
 
 void assertion_trap(char *file, uint16_t line);
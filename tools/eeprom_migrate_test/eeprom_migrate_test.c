@@ -0,0 +1,739 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: eeprom_migrate_test.c
+//
+// Description: Linux host test of the ASL110 settings upgrade (see app/eeprom_app.c).
+//		Checks that settings left in EEPROM by every older firmware come through
+//		eepromAppInit() with the user's values intact.
+//
+//	eeprom_app.c is built as is, against a RAM EEPROM. The images older firmware
+//	would have left are built here from EEPROM_ITEM_LIST, the way XC8 lays the
+//	items out: in order, no padding, little endian.
+//
+//		fixed map v3-v6	EEPROM version 3 to 6, settings at fixed addresses
+//		log v6			the settings log from before there were profiles, with
+//						a committed group of records and one cut short
+//		bad log			a log page that fails its CRC, over a good fixed map
+//		blank			nothing stored
+//		profiles		a profile switched to and changed, then read back
+//
+//	After each upgrade every item is checked in every profile. Items the old
+//	version had must keep their values, PROFILE items in all profiles, and new
+//	items must get their defaults or what their migration step gives them.
+//	Then the unit is "rebooted", eepromAppInit() again, and everything checked
+//	again from what the upgrade saved.
+//
+// Build: cc -O2 -Wall -DASL110 -DDEBUG -Istub -I$F/stdlib -I$F/common/inc
+//			-I$F/app/inc -I$F/bsp/inc -I$F/drivers/inc -o eeprom_migrate_test
+//			eeprom_migrate_test.c $F/app/eeprom_app.c
+//
+//	where F is ../../firmware/ASL104_PIC46K40.X. stub/ must come first.
+//
+// Usage: eeprom_migrate_test [-v]
+//		-v	Print every item checked.
+//
+//	Exits with 0 if every case passes.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "eeprom_bsp.h"
+#include "crc_bsp.h"
+#include "eeprom_app.h"
+
+/* ******************************   Macros   ****************************** */
+
+// The PIC18F46K40's data EEPROM.
+#define EEPROM_SIZE					(1024)
+
+// Where eeprom_app.c keeps things. Copied from there, the test has to know where older
+// firmware put them.
+#define FIXED_MAP_ADDR				((uint16_t)0x000)
+#define FIXED_MAP_LEN				(64)
+#define LOG_PAGE_A_ADDR				((uint16_t)0x040)
+#define LOG_PAGE_SIZE				((uint16_t)320)
+#define LOG_PAGE_B_ADDR				(LOG_PAGE_A_ADDR + LOG_PAGE_SIZE)
+#define LOG_PAGE_VALID				((uint8_t)0x5A)
+#define LOG_HEADER_LEN				(5)		// valid, generation, snapshot_len, snapshot_crc
+#define LOG_RECORD_COMMIT			((uint8_t)0x80)
+#define INITIALIZED_VAL				((uint8_t)0xA5)
+
+#define TEST_SIZE_BOOL				(1)
+#define TEST_SIZE_ENUM				(1)
+#define TEST_SIZE_UINT8				(1)
+#define TEST_SIZE_UINT16			(2)
+#define TEST_IS_PROFILE_GLOBAL		(false)
+#define TEST_IS_PROFILE_PROFILE		(true)
+
+#define NUM_ITEMS					((int)EEPROM_STORED_ITEM_EOL)
+
+/* ******************************   Types   ******************************* */
+
+typedef struct
+{
+	const char *m_Name;
+	uint8_t m_Size;
+	bool m_Profile;
+} TestItemInfo_t;
+
+// The first item each older EEPROM version didn't have.
+typedef struct
+{
+	uint8_t m_Version;
+	EepromItemId_t m_FirstNewItem;
+} TestVersion_t;
+
+// A record for a log image.
+typedef struct
+{
+	EepromItemId_t m_Item;
+	uint16_t m_Val;
+	bool m_Commit;
+} TestRecord_t;
+
+/* ***********************   File Scope Variables   *********************** */
+
+static const TestItemInfo_t items[] =
+{
+#define TEST_ITEM_INFO(id, type, field, default_val, scope)	{#id, TEST_SIZE_##type, TEST_IS_PROFILE_##scope},
+	EEPROM_ITEM_LIST(TEST_ITEM_INFO)
+#undef TEST_ITEM_INFO
+};
+
+static const TestVersion_t versions[] =
+{
+	{3, EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET},
+	{4, EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET},
+	{5, EEPROM_STORED_ITEM_ENABLED_FEATURES_2},
+	{6, EEPROM_STORED_ITEM_ACTIVE_PROFILE}
+};
+
+static uint8_t eeprom[EEPROM_SIZE];
+static EepromBspCallback_t write_done_callback = NULL;
+
+// What eeprom_app.c gives every item on a blank EEPROM.
+static uint16_t defaults[NUM_ITEMS];
+
+static bool verbose = false;
+static unsigned num_run = 0;
+static unsigned num_failed = 0;
+
+/* ***********************   Function Prototypes   ************************ */
+
+static bool TestFixedMap(const TestVersion_t *version);
+static bool TestLogV6(void);
+static bool TestBadLog(void);
+static bool TestBlank(void);
+static bool TestProfiles(void);
+static void Run(const char *name, bool (*test)(void), const TestVersion_t *version);
+static bool UpgradeAndCheck(const char *name, const uint16_t *expected, uint8_t expected_profile);
+static bool CheckItems(const char *name, const uint16_t *expected, uint8_t expected_profile);
+static bool CheckProfileItems(const char *name, const uint16_t expected[][NUM_ITEMS], uint8_t expected_profile);
+static void ExpectedAfterUpgrade(const TestVersion_t *version, const uint16_t *old_vals, uint16_t *expected);
+static void OldValuesGet(uint8_t version, uint16_t salt, uint16_t *vals);
+static uint8_t FlatImageBuild(const TestVersion_t *version, const uint16_t *vals, uint8_t *image);
+static void LogPageWrite(uint16_t page_addr, uint8_t generation, const uint8_t *snapshot, uint8_t len,
+	bool good_crc, const TestRecord_t *records, uint8_t num_records);
+static uint16_t ItemOffset(EepromItemId_t item_id);
+static void EepromErase(void);
+
+/* *******************   Public Function Definitions   ******************** */
+
+int main(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-v") == 0)
+		{
+			verbose = true;
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [-v]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	// Everything else is checked against the defaults, so this goes first.
+	Run("blank", TestBlank, NULL);
+
+	for (unsigned i = 0; i < sizeof(versions) / sizeof(versions[0]); i++)
+	{
+		Run("fixed map", NULL, &versions[i]);
+	}
+
+	Run("log v6", TestLogV6, NULL);
+	Run("bad log", TestBadLog, NULL);
+	Run("profiles", TestProfiles, NULL);
+
+	printf("%u cases, %u failed\n", num_run, num_failed);
+	return (num_failed == 0) ? 0 : 1;
+}
+
+// Stand-ins for the EEPROM BSP. Writes go straight in and are done at once.
+
+void eepromBspInit(void)
+{
+}
+
+bool eepromBspWriteByte(uint16_t address, uint8_t byte_to_write, uint16_t timeout_ms)
+{
+	return eepromBspWriteBuffer(address, 1, &byte_to_write, timeout_ms);
+}
+
+bool eepromBspWriteBuffer(uint16_t start_address, uint8_t num_bytes_to_write, const uint8_t *data, uint16_t timeout_ms)
+{
+	(void)timeout_ms;
+
+	if ((start_address + num_bytes_to_write) > EEPROM_SIZE)
+	{
+		printf("  FAIL write of %u bytes at 0x%03x is past the end of EEPROM\n", num_bytes_to_write, start_address);
+		num_failed++;
+		return false;
+	}
+
+	memcpy(&eeprom[start_address], data, num_bytes_to_write);
+
+	if (write_done_callback != NULL)
+	{
+		write_done_callback();
+	}
+	return true;
+}
+
+bool eepromBspReadSection(uint16_t start_address, uint8_t num_bytes_to_read, uint8_t *buffer, uint16_t timeout_ms)
+{
+	(void)timeout_ms;
+
+	if ((start_address + num_bytes_to_read) > EEPROM_SIZE)
+	{
+		printf("  FAIL read of %u bytes at 0x%03x is past the end of EEPROM\n", num_bytes_to_read, start_address);
+		num_failed++;
+		return false;
+	}
+
+	memcpy(buffer, &eeprom[start_address], num_bytes_to_read);
+	return true;
+}
+
+uint16_t eepromBspSizeOfEeprom(void)
+{
+	return EEPROM_SIZE;
+}
+
+bool eepromBspWriteBusy(void)
+{
+	return false;
+}
+
+bool eepromBspWriteRoom(uint8_t num_writes, uint8_t num_bytes)
+{
+	(void)num_writes;
+	(void)num_bytes;
+	return true;
+}
+
+void eepromBspWriteWait(void)
+{
+}
+
+void eepromBspWriteDoneCallbackSet(EepromBspCallback_t callback)
+{
+	write_done_callback = callback;
+}
+
+void eepromBspIsr(void)
+{
+}
+
+// The same CRC-16/XMODEM as crc_bsp.c works out on parts without the CRC module.
+uint16_t crcBspCalc16(const uint8_t *data, uint8_t len)
+{
+	uint16_t crc = 0;
+
+	for (uint8_t i = 0; i < len; i++)
+	{
+		crc ^= (uint16_t)data[i] << 8;
+
+		for (uint8_t bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+		}
+	}
+
+	return crc;
+}
+
+Evt_t event_create(void)
+{
+	return 0;
+}
+
+void event_ISR_signal(Evt_t ev)
+{
+	(void)ev;
+}
+
+void assertion_trap(char *file, uint16_t line)
+{
+	printf("  FAIL assertion at %s:%u\n", file, line);
+	exit(1);
+}
+
+/* ********************   Private Function Definitions   ****************** */
+
+//-------------------------------
+// Function: Run
+//
+// Description: Runs one case and counts it.
+//
+//-------------------------------
+static void Run(const char *name, bool (*test)(void), const TestVersion_t *version)
+{
+	bool passed;
+
+	num_run++;
+	passed = (test != NULL) ? test() : TestFixedMap(version);
+
+	if (version != NULL)
+	{
+		printf("%s %s v%u\n", passed ? "pass" : "FAIL", name, version->m_Version);
+	}
+	else
+	{
+		printf("%s %s\n", passed ? "pass" : "FAIL", name);
+	}
+
+	if (!passed)
+	{
+		num_failed++;
+	}
+}
+
+//-------------------------------
+// Function: TestBlank
+//
+// Description: Nothing stored. Everything starts off at its default, which is kept for the
+//		other cases to check against.
+//
+//-------------------------------
+static bool TestBlank(void)
+{
+	EepromErase();
+
+	if (eepromAppInit())
+	{
+		printf("  FAIL blank EEPROM was taken as initialized\n");
+		return false;
+	}
+
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		defaults[i] = eepromItemGet((EepromItemId_t)i);
+	}
+
+	if (defaults[EEPROM_STORED_ITEM_MM_EEPROM_VERSION] != EEPROM_DATA_STRUCTURE_VERSION)
+	{
+		printf("  FAIL default version is %u\n", defaults[EEPROM_STORED_ITEM_MM_EEPROM_VERSION]);
+		return false;
+	}
+
+	return CheckItems("reboot", defaults, 0);
+}
+
+//-------------------------------
+// Function: TestFixedMap
+//
+// Description: Settings an older version left at fixed addresses.
+//
+//-------------------------------
+static bool TestFixedMap(const TestVersion_t *version)
+{
+	uint16_t old_vals[NUM_ITEMS];
+	uint16_t expected[NUM_ITEMS];
+	uint8_t image[FIXED_MAP_LEN];
+
+	OldValuesGet(version->m_Version, 0, old_vals);
+	ExpectedAfterUpgrade(version, old_vals, expected);
+
+	EepromErase();
+	(void)FlatImageBuild(version, old_vals, image);
+	memcpy(&eeprom[FIXED_MAP_ADDR], image, FIXED_MAP_LEN);
+
+	return UpgradeAndCheck("upgrade", expected, 0);
+}
+
+//-------------------------------
+// Function: TestLogV6
+//
+// Description: The settings log from before there were profiles. Page A is newer than page B,
+//		and ends with a record that was cut short of its commit.
+//
+//-------------------------------
+static bool TestLogV6(void)
+{
+	static const TestRecord_t records[] =
+	{
+		{EEPROM_STORED_ITEM_CTR_PAD_MAX_THRESH_PERC,	0x0321,	false},
+		{EEPROM_STORED_ITEM_ENABLED_FEATURES,			0x5A,	true},
+		{EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET,	0x33,	true},
+		{EEPROM_STORED_ITEM_LEFT_PAD_OUTPUT_MAP,		0x77,	false}	// Never committed.
+	};
+	const TestVersion_t *v6 = &versions[3];
+	uint16_t old_vals[NUM_ITEMS];
+	uint16_t stale_vals[NUM_ITEMS];
+	uint16_t expected[NUM_ITEMS];
+	uint8_t snapshot[FIXED_MAP_LEN];
+	uint8_t len;
+
+	OldValuesGet(6, 0, old_vals);
+	OldValuesGet(6, 0x0100, stale_vals);
+
+	EepromErase();
+
+	len = FlatImageBuild(v6, stale_vals, snapshot);
+	LogPageWrite(LOG_PAGE_B_ADDR, 0xFF, snapshot, len, true, NULL, 0);
+
+	// Generations wrap, 0 is newer than 0xFF.
+	len = FlatImageBuild(v6, old_vals, snapshot);
+	LogPageWrite(LOG_PAGE_A_ADDR, 0x00, snapshot, len, true, records, sizeof(records) / sizeof(records[0]));
+
+	for (unsigned i = 0; i < sizeof(records) / sizeof(records[0]); i++)
+	{
+		if (records[i].m_Item != EEPROM_STORED_ITEM_LEFT_PAD_OUTPUT_MAP)
+		{
+			old_vals[records[i].m_Item] = records[i].m_Val;
+		}
+	}
+	ExpectedAfterUpgrade(v6, old_vals, expected);
+
+	return UpgradeAndCheck("upgrade", expected, 0);
+}
+
+//-------------------------------
+// Function: TestBadLog
+//
+// Description: A log page that fails its CRC. The settings are taken as lost and the defaults
+//		used, not what older firmware left in the fixed map.
+//
+//-------------------------------
+static bool TestBadLog(void)
+{
+	const TestVersion_t *v6 = &versions[3];
+	uint16_t old_vals[NUM_ITEMS];
+	uint8_t image[FIXED_MAP_LEN];
+	uint8_t len;
+
+	OldValuesGet(6, 0, old_vals);
+
+	EepromErase();
+	len = FlatImageBuild(v6, old_vals, image);
+	memcpy(&eeprom[FIXED_MAP_ADDR], image, FIXED_MAP_LEN);
+	LogPageWrite(LOG_PAGE_A_ADDR, 0x10, image, len, false, NULL, 0);
+
+	if (eepromAppInit())
+	{
+		printf("  FAIL log that failed its CRC was loaded\n");
+		return false;
+	}
+
+	if (!CheckItems("defaults", defaults, 0))
+	{
+		return false;
+	}
+
+	if (!eepromAppInit())
+	{
+		printf("  FAIL reboot didn't find the defaults that were saved\n");
+		return false;
+	}
+
+	return CheckItems("reboot", defaults, 0);
+}
+
+//-------------------------------
+// Function: TestProfiles
+//
+// Description: Another profile is switched to and one of its settings changed, along with a
+//		GLOBAL one. They're flushed as records and have to come back after a reboot.
+//
+//-------------------------------
+static bool TestProfiles(void)
+{
+	uint16_t expected[EEPROM_NUM_PROFILES][NUM_ITEMS];
+
+	EepromErase();
+	(void)eepromAppInit();
+
+	for (uint8_t profile = 0; profile < EEPROM_NUM_PROFILES; profile++)
+	{
+		memcpy(expected[profile], defaults, sizeof(expected[profile]));
+		expected[profile][EEPROM_STORED_ITEM_USER_BTN_LONG_PRESS_ACT_TIME] = 1500;
+	}
+	expected[2][EEPROM_STORED_ITEM_CTR_PAD_MIN_THRESH_PERC] = 0x0123;
+
+	if (!eepromProfileSelect(2))
+	{
+		printf("  FAIL profile 2 couldn't be selected\n");
+		return false;
+	}
+	eepromItemSet(EEPROM_STORED_ITEM_CTR_PAD_MIN_THRESH_PERC, 0x0123);
+	eepromItemSet(EEPROM_STORED_ITEM_USER_BTN_LONG_PRESS_ACT_TIME, 1500);
+	eepromFlush(false);
+
+	if (!eepromAppInit())
+	{
+		printf("  FAIL reboot didn't find the saved settings\n");
+		return false;
+	}
+
+	// The change was to profile 2 only, and profile 2 is still the one in use.
+	return CheckProfileItems("reboot", (const uint16_t (*)[NUM_ITEMS])expected, 2);
+}
+
+//-------------------------------
+// Function: UpgradeAndCheck
+//
+// Description: Runs the upgrade on what's in EEPROM and checks the result, then reboots and
+//		checks what was saved.
+//
+//-------------------------------
+static bool UpgradeAndCheck(const char *name, const uint16_t *expected, uint8_t expected_profile)
+{
+	if (!eepromAppInit())
+	{
+		printf("  FAIL stored settings weren't found\n");
+		return false;
+	}
+
+	if (!CheckItems(name, expected, expected_profile))
+	{
+		return false;
+	}
+
+	// CheckItems() switched profiles. Save whatever that left to be saved, as the supervisor would.
+	eepromFlush(false);
+
+	if (!eepromAppInit())
+	{
+		printf("  FAIL reboot didn't find the upgraded settings\n");
+		return false;
+	}
+
+	return CheckItems("reboot", expected, expected_profile);
+}
+
+//-------------------------------
+// Function: CheckItems
+//
+// Description: Checks every item against what's expected, the PROFILE items the same in every
+//		profile. Leaves the expected profile active.
+//
+//-------------------------------
+static bool CheckItems(const char *name, const uint16_t *expected, uint8_t expected_profile)
+{
+	uint16_t expected_profiles[EEPROM_NUM_PROFILES][NUM_ITEMS];
+
+	for (uint8_t profile = 0; profile < EEPROM_NUM_PROFILES; profile++)
+	{
+		memcpy(expected_profiles[profile], expected, sizeof(expected_profiles[profile]));
+	}
+
+	return CheckProfileItems(name, (const uint16_t (*)[NUM_ITEMS])expected_profiles, expected_profile);
+}
+
+//-------------------------------
+// Function: CheckProfileItems
+//
+// Description: Checks every item against what's expected for each profile. GLOBAL items are
+//		checked against profile 0's. Leaves the expected profile active.
+//
+//-------------------------------
+static bool CheckProfileItems(const char *name, const uint16_t expected[][NUM_ITEMS], uint8_t expected_profile)
+{
+	bool passed = true;
+	uint16_t val;
+
+	if (eepromProfileActiveGet() != expected_profile)
+	{
+		printf("  FAIL %s: active profile is %u, should be %u\n", name, eepromProfileActiveGet(), expected_profile);
+		passed = false;
+	}
+
+	for (uint8_t profile = 0; profile < EEPROM_NUM_PROFILES; profile++)
+	{
+		(void)eepromProfileSelect(profile);
+
+		for (int i = 0; i < NUM_ITEMS; i++)
+		{
+			// GLOBAL items are the same whichever profile is active. ACTIVE_PROFILE is what
+			// was just selected.
+			if ((!items[i].m_Profile && (profile != 0)) || (i == EEPROM_STORED_ITEM_ACTIVE_PROFILE))
+			{
+				continue;
+			}
+
+			val = eepromItemGet((EepromItemId_t)i);
+			if (verbose)
+			{
+				printf("    %s: profile %u %s = 0x%04x\n", name, profile, items[i].m_Name, val);
+			}
+
+			if (val != expected[profile][i])
+			{
+				printf("  FAIL %s: profile %u %s is 0x%04x, should be 0x%04x\n", name, profile, items[i].m_Name, val, expected[profile][i]);
+				passed = false;
+			}
+		}
+	}
+
+	(void)eepromProfileSelect(expected_profile);
+	return passed;
+}
+
+//-------------------------------
+// Function: ExpectedAfterUpgrade
+//
+// Description: Works out what every item should be once an older version's values have been
+//		upgraded.
+//
+//-------------------------------
+static void ExpectedAfterUpgrade(const TestVersion_t *version, const uint16_t *old_vals, uint16_t *expected)
+{
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		expected[i] = (i < (int)version->m_FirstNewItem) ? old_vals[i] : defaults[i];
+	}
+
+	expected[EEPROM_STORED_ITEM_MM_EEPROM_VERSION] = EEPROM_DATA_STRUCTURE_VERSION;
+
+	// Version 5 gave the left and right pads a minimum drive speed, starting off the same as
+	// the center pad's.
+	if (version->m_Version < 5)
+	{
+		expected[EEPROM_STORED_ITEM_MM_LEFT_PAD_MINIMUM_DRIVE_OFFSET] = expected[EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET];
+		expected[EEPROM_STORED_ITEM_MM_RIGHT_PAD_MINIMUM_DRIVE_OFFSET] = expected[EEPROM_STORED_ITEM_MM_CENTER_PAD_MINIMUM_DRIVE_OFFSET];
+	}
+}
+
+//-------------------------------
+// Function: OldValuesGet
+//
+// Description: Makes up values for an older version's items, none of them the default. A
+//		different salt gives different values.
+//
+//-------------------------------
+static void OldValuesGet(uint8_t version, uint16_t salt, uint16_t *vals)
+{
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		vals[i] = (items[i].m_Size == 2) ? (uint16_t)(0x1200 + salt + i) : (uint8_t)(0x40 + salt / 0x40 + i);
+	}
+
+	vals[EEPROM_STORED_ITEM_EEPROM_INITIALIZED] = INITIALIZED_VAL;
+	vals[EEPROM_STORED_ITEM_MM_EEPROM_VERSION] = version;
+}
+
+//-------------------------------
+// Function: FlatImageBuild
+//
+// Description: Lays out the items an older version had, as it stored them in the fixed map
+//		and in log snapshots. What it didn't have is left erased.
+//
+// return: How long the version's items are.
+//
+//-------------------------------
+static uint8_t FlatImageBuild(const TestVersion_t *version, const uint16_t *vals, uint8_t *image)
+{
+	uint16_t offset;
+
+	memset(image, 0xFF, FIXED_MAP_LEN);
+
+	for (int i = 0; i < (int)version->m_FirstNewItem; i++)
+	{
+		offset = ItemOffset((EepromItemId_t)i);
+		image[offset] = (uint8_t)vals[i];
+		if (items[i].m_Size == 2)
+		{
+			image[offset + 1] = (uint8_t)(vals[i] >> 8);
+		}
+	}
+
+	return (uint8_t)ItemOffset(version->m_FirstNewItem);
+}
+
+//-------------------------------
+// Function: LogPageWrite
+//
+// Description: Writes a settings log page as the firmware before profiles did: header,
+//		snapshot, then records addressed by item id.
+//
+//-------------------------------
+static void LogPageWrite(uint16_t page_addr, uint8_t generation, const uint8_t *snapshot, uint8_t len,
+	bool good_crc, const TestRecord_t *records, uint8_t num_records)
+{
+	uint16_t crc = crcBspCalc16(snapshot, len);
+	uint8_t *record;
+
+	if (!good_crc)
+	{
+		crc ^= 0x0001;
+	}
+
+	eeprom[page_addr] = LOG_PAGE_VALID;
+	eeprom[page_addr + 1] = generation;
+	eeprom[page_addr + 2] = len;
+	eeprom[page_addr + 3] = (uint8_t)crc;
+	eeprom[page_addr + 4] = (uint8_t)(crc >> 8);
+	memcpy(&eeprom[page_addr + LOG_HEADER_LEN], snapshot, len);
+
+	for (uint8_t i = 0; i < num_records; i++)
+	{
+		record = &eeprom[page_addr + LOG_HEADER_LEN + len + i * 4];
+		record[0] = (uint8_t)records[i].m_Item | (records[i].m_Commit ? LOG_RECORD_COMMIT : 0);
+		record[1] = (uint8_t)records[i].m_Val;
+		record[2] = (uint8_t)(records[i].m_Val >> 8);
+		record[3] = (uint8_t)(generation + i);
+	}
+}
+
+//-------------------------------
+// Function: ItemOffset
+//
+// Description: Where an item is in the fixed map and flat snapshots.
+//
+//-------------------------------
+static uint16_t ItemOffset(EepromItemId_t item_id)
+{
+	uint16_t offset = 0;
+
+	for (int i = 0; i < (int)item_id; i++)
+	{
+		offset += items[i].m_Size;
+	}
+
+	return offset;
+}
+
+//-------------------------------
+// Function: EepromErase
+//
+// Description: Puts the EEPROM back the way it leaves the factory.
+//
+//-------------------------------
+static void EepromErase(void)
+{
+	memset(eeprom, 0xFF, sizeof(eeprom));
+}
+
+// end of file.
+//-------------------------------------------------------------------------
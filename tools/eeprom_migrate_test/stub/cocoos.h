@@ -0,0 +1,27 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: cocoos.h
+//
+// Description: Host stand-in for the parts of cocoOS eeprom_app.c uses. Implemented in
+//		eeprom_migrate_test.c.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef COCOOS_H
+#define COCOOS_H
+
+#include <stdint.h>
+
+typedef uint8_t Evt_t;
+
+Evt_t event_create(void);
+void event_ISR_signal(Evt_t ev);
+
+#endif // COCOOS_H
+
+// end of file.
+//-------------------------------------------------------------------------
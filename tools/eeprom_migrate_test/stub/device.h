@@ -0,0 +1,38 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: device.h
+//
+// Description: Host stand-in for the firmware's device.h, for building eeprom_app.c
+//		into eeprom_migrate_test.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+// eeprom_app.c includes this first, so everything it declares is laid out the way XC8 lays it
+// out for the 8-bit PIC, with no padding. That's what puts items at their EEPROM addresses.
+#pragma pack(push, 1)
+
+// Defaults in EEPROM_ITEM_LIST that come from ASL110 head array code this tree doesn't have.
+// Only the blank EEPROM case sees them, any value will do.
+#define HEAD_ARR_INPUT_PROPORTIONAL		(0)
+#define HEAD_ARRAY_OUT_FUNC_LEFT		(1)
+#define HEAD_ARRAY_OUT_FUNC_RIGHT		(2)
+#define HEAD_ARRAY_OUT_FUNC_FWD			(3)
+#define FUNC_FEATURE_POWER_ON_OFF		(0)
+#define ADC_LEFT_PAD_MIN_VAL			(0)
+#define ADC_LEFT_PAD_MAX_VAL			(1023)
+#define ADC_RIGHT_PAD_MIN_VAL			(0)
+#define ADC_RIGHT_PAD_MAX_VAL			(1023)
+#define ADC_CTR_PAD_MIN_VAL				(0)
+#define ADC_CTR_PAD_MAX_VAL				(1023)
+
+#endif // DEVICE_H
+
+// end of file.
+//-------------------------------------------------------------------------
@@ -0,0 +1,558 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: efix_emulator.c
+//
+// Description: Linux host emulator for the eFix Model 35 side of the ASL110
+//		RS-232 link (see app/eFix_Communication.c). Lets the protocol and its
+//		timing be checked without the wheelchair.
+//
+//	It opens a pseudo-terminal and prints the name of its slave side, or opens
+//	a real serial port at 115.2K with -d. Frames from the ASL are:
+//
+//		SOT (0xeb), Message ID, data high, data low, checksum high, checksum low
+//
+//	where the checksum is the 2's complement of the sum of the first 4 bytes.
+//	The emulator checks every frame, enforces the 100 ms message timeout, and
+//	follows the setup sequence the firmware sends:
+//
+//		0x08 Max Speed
+//		0x04 No Command
+//		0x04 1st Setup (special function 0x80, speed from the control panel)
+//		0x04 No Command
+//		0x04 2nd Setup (special function 0xb0, drive via 0x01 and 0x02)
+//		0x04 No Command
+//		0x01 Steering / 0x02 Speed, repeated
+//
+//	Steering and speed frames before the 2nd setup message are counted as out
+//	of order. A timeout latches a fault, as the real controller does, and the
+//	setup sequence must be sent again to clear it.
+//
+//	Every good frame gets a reply: SOT (0xbe), the same Message ID and 2 data
+//	bytes, checksummed the same way. The real reply contents are not documented in this
+//	tree, so the data is the value that was accepted, or for 0x04 a status of
+//	0 (ok) / 1 (faulted). Replies can be turned off with -n.
+//
+//	Statistics go to stdout once a second and on exit (Ctrl-C): throughput,
+//	gaps between frames (min/avg/max and a histogram) and timeout violations.
+//
+// Build: cc -O2 -Wall -o efix_emulator efix_emulator.c
+//
+// Usage: efix_emulator [-d device] [-t timeout_ms] [-n] [-v]
+//		-d	Use a serial port instead of a pseudo-terminal.
+//		-t	Message timeout, default 100 ms.
+//		-n	Don't send replies.
+//		-v	Print every frame.
+//
+// Author(s): G. Chopcinski (Kg Solutions, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ******************************   Macros   ****************************** */
+
+#define TO_EFIX_SOT (0xeb)
+#define FROM_EFIX_SOT (0xbe)
+#define EFIX_MSG_LEN (6)
+
+#define MSG_ID_STEERING (0x01)
+#define MSG_ID_SPEED (0x02)
+#define MSG_ID_COMMAND (0x04)
+#define MSG_ID_MAX_SPEED (0x08)
+
+#define SPECIAL_FUNC_PANEL (0x80)
+#define SPECIAL_FUNC_DRIVE_CMDS (0xb0)
+
+#define DEFAULT_TIMEOUT_ms (100)
+#define REPORT_PERIOD_ms (1000)
+
+// Gap histogram bucket edges in ms. The last bucket is everything past the timeout.
+#define NUM_GAP_BUCKETS (5)
+static const unsigned gap_bucket_edges_ms[NUM_GAP_BUCKETS - 1] = {20, 60, 80, 100};
+
+/* ******************************   Types   ******************************* */
+
+// Where the emulated controller is in the setup sequence.
+typedef enum
+{
+	SETUP_WAIT_MAX_SPEED,
+	SETUP_WAIT_1ST_NO_CMD,
+	SETUP_WAIT_1ST_SETUP,
+	SETUP_WAIT_2ND_NO_CMD,
+	SETUP_WAIT_2ND_SETUP,
+	SETUP_WAIT_3RD_NO_CMD,
+	SETUP_DRIVING,
+	SETUP_FAULTED
+} SetupState_t;
+
+typedef struct
+{
+	uint64_t m_Bytes;
+	uint64_t m_GoodFrames;
+	uint64_t m_ChecksumErrors;
+	uint64_t m_DiscardedBytes;
+	uint64_t m_OutOfOrder;
+	uint64_t m_Timeouts;
+	uint64_t m_GapCount;
+	uint64_t m_GapTotal_ms;
+	unsigned m_GapMin_ms;
+	unsigned m_GapMax_ms;
+	uint64_t m_GapBuckets[NUM_GAP_BUCKETS];
+} EmuStats_t;
+
+/* ***********************   File Scope Variables   *********************** */
+
+static volatile sig_atomic_t quit = 0;
+
+static int link_fd = -1;
+static unsigned timeout_ms = DEFAULT_TIMEOUT_ms;
+static bool send_replies = true;
+static bool verbose = false;
+
+static SetupState_t setup_state = SETUP_WAIT_MAX_SPEED;
+static int16_t steering = 0;
+static int16_t speed = 0;
+static uint16_t max_speed = 0;
+
+static uint8_t frame[EFIX_MSG_LEN];
+static unsigned frame_len = 0;
+
+static bool have_last_frame = false;
+static uint64_t last_frame_ms;
+
+static EmuStats_t total;		// Since start.
+static EmuStats_t period;		// Since the last report.
+
+/* ***********************   Function Definitions   *********************** */
+
+static uint64_t NowMs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000u) + ((uint64_t)ts.tv_nsec / 1000000u);
+}
+
+static void OnSignal(int sig)
+{
+	(void)sig;
+	quit = 1;
+}
+
+static const char *SetupStateName(SetupState_t state)
+{
+	static const char *const names[] =
+	{
+		"wait max speed", "wait 1st no cmd", "wait 1st setup", "wait 2nd no cmd",
+		"wait 2nd setup", "wait 3rd no cmd", "driving", "FAULTED"
+	};
+	return names[state];
+}
+
+static void StatsReset(EmuStats_t *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->m_GapMin_ms = ~0u;
+}
+
+static void StatsGap(EmuStats_t *stats, unsigned gap_ms)
+{
+	unsigned bucket = 0;
+
+	while ((bucket < (NUM_GAP_BUCKETS - 1)) && (gap_ms >= gap_bucket_edges_ms[bucket]))
+	{
+		bucket++;
+	}
+
+	stats->m_GapBuckets[bucket]++;
+	stats->m_GapCount++;
+	stats->m_GapTotal_ms += gap_ms;
+	if (gap_ms < stats->m_GapMin_ms)
+	{
+		stats->m_GapMin_ms = gap_ms;
+	}
+	if (gap_ms > stats->m_GapMax_ms)
+	{
+		stats->m_GapMax_ms = gap_ms;
+	}
+}
+
+static void StatsPrint(const char *label, const EmuStats_t *stats, uint64_t span_ms)
+{
+	printf("%s: %llu frames, %llu B (%.1f B/s), cksum err %llu, discarded %llu, out of order %llu, timeouts %llu\n",
+		label,
+		(unsigned long long)stats->m_GoodFrames,
+		(unsigned long long)stats->m_Bytes,
+		(span_ms > 0) ? ((double)stats->m_Bytes * 1000.0 / (double)span_ms) : 0.0,
+		(unsigned long long)stats->m_ChecksumErrors,
+		(unsigned long long)stats->m_DiscardedBytes,
+		(unsigned long long)stats->m_OutOfOrder,
+		(unsigned long long)stats->m_Timeouts);
+
+	if (stats->m_GapCount > 0)
+	{
+		printf("    gaps ms: min %u avg %.1f max %u | <20 %llu, 20-59 %llu, 60-79 %llu, 80-99 %llu, >=100 %llu\n",
+			stats->m_GapMin_ms,
+			(double)stats->m_GapTotal_ms / (double)stats->m_GapCount,
+			stats->m_GapMax_ms,
+			(unsigned long long)stats->m_GapBuckets[0],
+			(unsigned long long)stats->m_GapBuckets[1],
+			(unsigned long long)stats->m_GapBuckets[2],
+			(unsigned long long)stats->m_GapBuckets[3],
+			(unsigned long long)stats->m_GapBuckets[4]);
+	}
+	printf("    state: %s, steering %d, speed %d, max speed 0x%04x\n",
+		SetupStateName(setup_state), steering, speed, max_speed);
+	fflush(stdout);
+}
+
+static uint16_t Checksum(const uint8_t *bytes)
+{
+	return (uint16_t)(0u - (uint16_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]));
+}
+
+static void SendReply(uint8_t msg_id, uint16_t data)
+{
+	uint8_t reply[EFIX_MSG_LEN];
+	uint16_t checksum;
+
+	if (!send_replies)
+	{
+		return;
+	}
+
+	reply[0] = FROM_EFIX_SOT;
+	reply[1] = msg_id;
+	reply[2] = (uint8_t)(data >> 8);
+	reply[3] = (uint8_t)(data & 0xff);
+	checksum = Checksum(reply);
+	reply[4] = (uint8_t)(checksum >> 8);
+	reply[5] = (uint8_t)(checksum & 0xff);
+
+	if (write(link_fd, reply, sizeof(reply)) != (ssize_t)sizeof(reply))
+	{
+		perror("write");
+	}
+}
+
+static void OutOfOrder(const char *what)
+{
+	total.m_OutOfOrder++;
+	period.m_OutOfOrder++;
+	if (verbose)
+	{
+		printf("  out of order: %s while in '%s'\n", what, SetupStateName(setup_state));
+	}
+}
+
+// Moves the setup sequence along for a 0x04 frame.
+static void HandleCommand(uint8_t buttons, uint8_t special)
+{
+	bool no_cmd = (buttons == 0) && (special == 0);
+
+	switch (setup_state)
+	{
+		case SETUP_WAIT_1ST_NO_CMD:
+		case SETUP_WAIT_2ND_NO_CMD:
+		case SETUP_WAIT_3RD_NO_CMD:
+			if (no_cmd)
+			{
+				setup_state++;
+			}
+			else
+			{
+				OutOfOrder("setup message");
+			}
+			break;
+
+		case SETUP_WAIT_1ST_SETUP:
+			if (special == SPECIAL_FUNC_PANEL)
+			{
+				setup_state++;
+			}
+			else
+			{
+				OutOfOrder(no_cmd ? "no command" : "wrong setup message");
+			}
+			break;
+
+		case SETUP_WAIT_2ND_SETUP:
+			if (special == SPECIAL_FUNC_DRIVE_CMDS)
+			{
+				setup_state++;
+			}
+			else
+			{
+				OutOfOrder(no_cmd ? "no command" : "wrong setup message");
+			}
+			break;
+
+		case SETUP_DRIVING:
+			// No command is the keep-alive. Anything else changes the mode.
+			if (!no_cmd && (special != SPECIAL_FUNC_DRIVE_CMDS))
+			{
+				OutOfOrder("setup message while driving");
+			}
+			break;
+
+		case SETUP_WAIT_MAX_SPEED:
+		case SETUP_FAULTED:
+		default:
+			OutOfOrder("command before max speed");
+			break;
+	}
+}
+
+static void HandleFrame(uint64_t now_ms)
+{
+	uint8_t msg_id = frame[1];
+	uint16_t data = (uint16_t)((frame[2] << 8) | frame[3]);
+	uint16_t checksum = (uint16_t)((frame[4] << 8) | frame[5]);
+
+	if (checksum != Checksum(frame))
+	{
+		total.m_ChecksumErrors++;
+		period.m_ChecksumErrors++;
+		if (verbose)
+		{
+			printf("  checksum error: id 0x%02x got 0x%04x want 0x%04x\n", msg_id, checksum, Checksum(frame));
+		}
+		return;
+	}
+
+	total.m_GoodFrames++;
+	period.m_GoodFrames++;
+
+	if (have_last_frame)
+	{
+		unsigned gap_ms = (unsigned)(now_ms - last_frame_ms);
+		StatsGap(&total, gap_ms);
+		StatsGap(&period, gap_ms);
+	}
+	have_last_frame = true;
+	last_frame_ms = now_ms;
+
+	if (verbose)
+	{
+		printf("  rx id 0x%02x data 0x%04x\n", msg_id, data);
+	}
+
+	switch (msg_id)
+	{
+		case MSG_ID_MAX_SPEED:
+			// Always (re)starts the setup sequence. This is also how a fault is cleared.
+			max_speed = data;
+			steering = 0;
+			speed = 0;
+			setup_state = SETUP_WAIT_1ST_NO_CMD;
+			break;
+
+		case MSG_ID_COMMAND:
+			HandleCommand(frame[2], frame[3]);
+			data = (setup_state == SETUP_FAULTED) ? 1 : 0;
+			break;
+
+		case MSG_ID_STEERING:
+		case MSG_ID_SPEED:
+			if (setup_state != SETUP_DRIVING)
+			{
+				OutOfOrder((msg_id == MSG_ID_STEERING) ? "steering" : "speed");
+				data = 0;
+			}
+			else if (msg_id == MSG_ID_STEERING)
+			{
+				steering = (int16_t)data;
+			}
+			else
+			{
+				speed = (int16_t)data;
+			}
+			break;
+
+		default:
+			OutOfOrder("unknown message id");
+			break;
+	}
+
+	SendReply(msg_id, data);
+}
+
+static void HandleByte(uint8_t item, uint64_t now_ms)
+{
+	if ((frame_len == 0) && (item != TO_EFIX_SOT))
+	{
+		total.m_DiscardedBytes++;
+		period.m_DiscardedBytes++;
+		return;
+	}
+
+	frame[frame_len++] = item;
+	if (frame_len == EFIX_MSG_LEN)
+	{
+		HandleFrame(now_ms);
+		frame_len = 0;
+	}
+}
+
+// Latches a fault if the ASL has gone quiet for too long after starting.
+static void CheckTimeout(uint64_t now_ms)
+{
+	if (!have_last_frame || (setup_state == SETUP_FAULTED))
+	{
+		return;
+	}
+
+	if ((now_ms - last_frame_ms) > timeout_ms)
+	{
+		total.m_Timeouts++;
+		period.m_Timeouts++;
+		printf("TIMEOUT: no frame for %llu ms, controller faulted\n",
+			(unsigned long long)(now_ms - last_frame_ms));
+		setup_state = SETUP_FAULTED;
+		steering = 0;
+		speed = 0;
+		// Gaps across a fault aren't interesting, start timing from the next frame.
+		have_last_frame = false;
+	}
+}
+
+static int OpenLink(const char *device)
+{
+	struct termios tio;
+	int fd;
+
+	if (device != NULL)
+	{
+		fd = open(device, O_RDWR | O_NOCTTY);
+		if (fd < 0)
+		{
+			perror(device);
+			return -1;
+		}
+	}
+	else
+	{
+		fd = posix_openpt(O_RDWR | O_NOCTTY);
+		if ((fd < 0) || (grantpt(fd) != 0) || (unlockpt(fd) != 0))
+		{
+			perror("posix_openpt");
+			return -1;
+		}
+		printf("eFix emulator on %s\n", ptsname(fd));
+		fflush(stdout);
+	}
+
+	if (tcgetattr(fd, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, B115200);
+		cfsetospeed(&tio, B115200);
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+
+	return fd;
+}
+
+int main(int argc, char **argv)
+{
+	const char *device = NULL;
+	uint64_t start_ms;
+	uint64_t report_ms;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "d:t:nv")) != -1)
+	{
+		switch (opt)
+		{
+			case 'd': device = optarg; break;
+			case 't': timeout_ms = (unsigned)strtoul(optarg, NULL, 0); break;
+			case 'n': send_replies = false; break;
+			case 'v': verbose = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-d device] [-t timeout_ms] [-n] [-v]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	link_fd = OpenLink(device);
+	if (link_fd < 0)
+	{
+		return 1;
+	}
+
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+
+	StatsReset(&total);
+	StatsReset(&period);
+	start_ms = NowMs();
+	report_ms = start_ms;
+
+	while (!quit)
+	{
+		struct pollfd pfd = { .fd = link_fd, .events = POLLIN };
+		uint8_t buf[64];
+		uint64_t now_ms;
+		int ready;
+
+		// Wake often enough to catch a timeout within a millisecond or so.
+		ready = poll(&pfd, 1, 1);
+		now_ms = NowMs();
+
+		if ((ready > 0) && (pfd.revents & POLLIN))
+		{
+			ssize_t n = read(link_fd, buf, sizeof(buf));
+			if (n > 0)
+			{
+				total.m_Bytes += (uint64_t)n;
+				period.m_Bytes += (uint64_t)n;
+				for (ssize_t i = 0; i < n; i++)
+				{
+					HandleByte(buf[i], now_ms);
+				}
+			}
+			else if ((n < 0) && (errno != EAGAIN) && (errno != EINTR) && (errno != EIO))
+			{
+				perror("read");
+				break;
+			}
+		}
+		else if ((ready > 0) && (pfd.revents & POLLHUP))
+		{
+			// Nobody has the pty slave open. Don't spin.
+			usleep(1000);
+		}
+
+		CheckTimeout(now_ms);
+
+		if ((now_ms - report_ms) >= REPORT_PERIOD_ms)
+		{
+			StatsPrint("last 1s", &period, now_ms - report_ms);
+			StatsReset(&period);
+			report_ms = now_ms;
+		}
+	}
+
+	StatsPrint("total", &total, NowMs() - start_ms);
+	close(link_fd);
+	return 0;
+}
+
+// end of file.
+//-------------------------------------------------------------------------
@@ -0,0 +1,300 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: efix_ramp_test.c
+//
+// Description: Linux host test of the ramp the ASL110 puts between the speed
+//		and steering demands and what is sent to the eFix (see app/eFix_Ramp.c).
+//
+//	It builds the firmware's eFix_RampToward() as is, with the limits and
+//	EFIX_RAMP_STEP() from eFix_Ramp.h, and runs it through these profiles:
+//
+//		accel			neutral out to full scale, both directions
+//		decel			full scale back to neutral, both directions
+//		cross-neutral	full scale one way to full scale the other
+//		return-to-center	let go part way, e.g. mid turn
+//		part way		changes of demand that don't reach neutral
+//
+//	at the current eFix update period and the old 15 ms one. Each update is
+//	checked: the output never moves further than the step allowed for the way
+//	it is heading, never overshoots the demand, never passes through neutral
+//	in one update, and gets to the demand in the expected number of updates.
+//
+// Build: cc -O2 -Wall -I../../firmware/ASL104_PIC46K40.X/app/inc -o efix_ramp_test
+//			efix_ramp_test.c ../../firmware/ASL104_PIC46K40.X/app/eFix_Ramp.c
+//
+// Usage: efix_ramp_test [-v]
+//		-v	Print every update.
+//
+//	Exits with 0 if every profile passes.
+//
+// Author(s): G. Chopcinski (Kg Solutions, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "eFix_Ramp.h"
+
+/* ******************************   Macros   ****************************** */
+
+#define FULL_SCALE (1000)
+
+// EFIX_COMM_TASK_DELAY in app/eFix_Communication.c, and the period it used to be.
+#define UPDATE_PERIOD_ms (53)
+#define OLD_UPDATE_PERIOD_ms (15)
+
+// Give up on a profile after this many updates.
+#define MAX_UPDATES (1000)
+
+/* ******************************   Types   ******************************* */
+
+typedef struct
+{
+	const char *m_Name;
+	int m_AccelPerSec;
+	int m_DecelPerSec;
+} RampLimits_t;
+
+/* ***********************   File Scope Variables   *********************** */
+
+static const RampLimits_t speed_limits = {"speed", EFIX_SPEED_ACCEL_PER_SEC, EFIX_SPEED_DECEL_PER_SEC};
+static const RampLimits_t turn_limits = {"steering", EFIX_TURN_RATE_PER_SEC, EFIX_TURN_RETURN_PER_SEC};
+
+static bool verbose = false;
+static unsigned num_run = 0;
+static unsigned num_failed = 0;
+
+/* ***********************   Function Prototypes   ************************ */
+
+static int StepsToCover(int distance, int step);
+static int ExpectedUpdates(int from, int to, int accelStep, int decelStep);
+static bool RunProfile(const char *name, const RampLimits_t *limits, int period_ms, int from, int to);
+static bool CheckSteps(int period_ms);
+static void RunAll(int period_ms);
+
+/* *******************   Public Function Definitions   ******************** */
+
+int main(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-v") == 0)
+		{
+			verbose = true;
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [-v]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	RunAll(UPDATE_PERIOD_ms);
+	RunAll(OLD_UPDATE_PERIOD_ms);
+
+	printf("%u profiles, %u failed\n", num_run, num_failed);
+	return (num_failed == 0) ? 0 : 1;
+}
+
+/* ********************   Private Function Definitions   ****************** */
+
+//-------------------------------
+// Function: RunAll
+//
+// Description: Runs every profile for both the speed and steering limits at one update period.
+//
+//-------------------------------
+static void RunAll(int period_ms)
+{
+	static const RampLimits_t *const limits[] = {&speed_limits, &turn_limits};
+
+	printf("Update period %d ms\n", period_ms);
+
+	num_run++;
+	if (!CheckSteps(period_ms))
+	{
+		num_failed++;
+	}
+
+	for (unsigned i = 0; i < sizeof(limits) / sizeof(limits[0]); i++)
+	{
+		const RampLimits_t *l = limits[i];
+
+		RunProfile("accel forward/right", l, period_ms, 0, FULL_SCALE);
+		RunProfile("accel reverse/left", l, period_ms, 0, -FULL_SCALE);
+		RunProfile("decel forward/right", l, period_ms, FULL_SCALE, 0);
+		RunProfile("decel reverse/left", l, period_ms, -FULL_SCALE, 0);
+		RunProfile("cross neutral, forward to reverse", l, period_ms, FULL_SCALE, -FULL_SCALE);
+		RunProfile("cross neutral, reverse to forward", l, period_ms, -FULL_SCALE, FULL_SCALE);
+		RunProfile("return to center part way", l, period_ms, 370, 0);
+		RunProfile("return to center part way, other way", l, period_ms, -370, 0);
+		RunProfile("part way up", l, period_ms, 300, 700);
+		RunProfile("part way down", l, period_ms, 700, 300);
+		RunProfile("part way down, other way", l, period_ms, -700, -300);
+		RunProfile("cross neutral part way", l, period_ms, 250, -400);
+		RunProfile("already there", l, period_ms, 500, 500);
+	}
+}
+
+//-------------------------------
+// Function: CheckSteps
+//
+// Description: Checks EFIX_RAMP_STEP() against the per second limits. The steps must move
+//		at least as fast as the limit and less than one unit per update faster.
+//
+// return: true if they all pass.
+//
+//-------------------------------
+static bool CheckSteps(int period_ms)
+{
+	const int per_sec[] =
+	{
+		EFIX_SPEED_ACCEL_PER_SEC, EFIX_SPEED_DECEL_PER_SEC,
+		EFIX_TURN_RATE_PER_SEC, EFIX_TURN_RETURN_PER_SEC
+	};
+	bool passed = true;
+
+	for (unsigned i = 0; i < sizeof(per_sec) / sizeof(per_sec[0]); i++)
+	{
+		int step = EFIX_RAMP_STEP(per_sec[i], period_ms);
+		long exact_x1000 = (long)per_sec[i] * period_ms;
+
+		if ((step <= 0) || ((long)step * 1000 < exact_x1000) || ((long)(step - 1) * 1000 >= exact_x1000))
+		{
+			printf("  FAIL step for %d per second is %d\n", per_sec[i], step);
+			passed = false;
+		}
+	}
+
+	printf("  %s step sizes\n", passed ? "pass" : "FAIL");
+	return passed;
+}
+
+//-------------------------------
+// Function: RunProfile
+//
+// Description: Ramps from one value to another, checking every update on the way.
+//
+// return: true if it passes.
+//
+//-------------------------------
+static bool RunProfile(const char *name, const RampLimits_t *limits, int period_ms, int from, int to)
+{
+	int accel_step = EFIX_RAMP_STEP(limits->m_AccelPerSec, period_ms);
+	int decel_step = EFIX_RAMP_STEP(limits->m_DecelPerSec, period_ms);
+	int expected = ExpectedUpdates(from, to, accel_step, decel_step);
+	int output = from;
+	int updates = 0;
+	bool passed = true;
+
+	num_run++;
+
+	while ((output != to) && (updates < MAX_UPDATES))
+	{
+		int prev = output;
+		bool toward_neutral = ((prev > 0) && (to < prev)) || ((prev < 0) && (to > prev));
+		int allowed = toward_neutral ? decel_step : accel_step;
+		int moved;
+
+		output = eFix_RampToward(prev, to, accel_step, decel_step);
+		moved = abs(output - prev);
+		updates++;
+
+		if (verbose)
+		{
+			printf("    %4d: %5d -> %5d\n", updates, prev, output);
+		}
+
+		if (moved == 0)
+		{
+			printf("  FAIL %s %s: stuck at %d\n", limits->m_Name, name, output);
+			passed = false;
+			break;
+		}
+		if (moved > allowed)
+		{
+			printf("  FAIL %s %s: moved %d from %d, at most %d allowed\n", limits->m_Name, name, moved, prev, allowed);
+			passed = false;
+		}
+		if (((prev > 0) && (output < 0)) || ((prev < 0) && (output > 0)))
+		{
+			printf("  FAIL %s %s: went from %d to %d without stopping at neutral\n", limits->m_Name, name, prev, output);
+			passed = false;
+		}
+		if (((to >= prev) && (output > to)) || ((to <= prev) && (output < to)))
+		{
+			printf("  FAIL %s %s: overshot %d, at %d\n", limits->m_Name, name, to, output);
+			passed = false;
+		}
+	}
+
+	if (output != to)
+	{
+		printf("  FAIL %s %s: didn't get to %d in %d updates\n", limits->m_Name, name, to, MAX_UPDATES);
+		passed = false;
+	}
+	else if (updates != expected)
+	{
+		printf("  FAIL %s %s: took %d updates, expected %d\n", limits->m_Name, name, updates, expected);
+		passed = false;
+	}
+
+	// Once there it has to stay there.
+	if (eFix_RampToward(output, to, accel_step, decel_step) != output)
+	{
+		printf("  FAIL %s %s: didn't stay at %d\n", limits->m_Name, name, to);
+		passed = false;
+	}
+
+	if (passed)
+	{
+		printf("  pass %s %s: %d to %d in %d updates, %d ms\n", limits->m_Name, name, from, to, updates, updates * period_ms);
+	}
+	else
+	{
+		num_failed++;
+	}
+
+	return passed;
+}
+
+//-------------------------------
+// Function: ExpectedUpdates
+//
+// Description: Works out how many updates a ramp should take. Back toward neutral at the decel
+//		step, then away from it at the accel step.
+//
+//-------------------------------
+static int ExpectedUpdates(int from, int to, int accelStep, int decelStep)
+{
+	if (((from > 0) && (to < from)) || ((from < 0) && (to > from)))
+	{
+		if (((from > 0) && (to >= 0)) || ((from < 0) && (to <= 0)))
+		{
+			return StepsToCover(abs(from - to), decelStep);
+		}
+
+		return StepsToCover(abs(from), decelStep) + StepsToCover(abs(to), accelStep);
+	}
+
+	return StepsToCover(abs(to - from), accelStep);
+}
+
+//-------------------------------
+// Function: StepsToCover
+//
+// Description: Updates needed to move distance at up to step per update.
+//
+//-------------------------------
+static int StepsToCover(int distance, int step)
+{
+	return (distance + step - 1) / step;
+}
+
+// end of file.
+//-------------------------------------------------------------------------
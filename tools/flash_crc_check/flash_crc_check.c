@@ -0,0 +1,355 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: flash_crc_check.c
+//
+// Description: Linux host check of the program memory CRC in a built .hex file, for
+//		the flash check in bsp/XC8/crc_bsp.c.
+//
+//	The build has hexmate store a CRC of 0x0000-0xFFFD at 0xFFFE. At run time the
+//	PIC18F46K40's memory scanner feeds the same range through the CRC module and the
+//	result has to match, or the chair won't drive. This works the CRC out both ways
+//	from the .hex and compares them with what's stored:
+//
+//		scanner		The CRC module as crcBspFlashScanStart() sets it up. Polynomial
+//					0x1021, seed 0, augmented with zeros (ACCM), 16 bit data (DLEN)
+//					shifted in MSb first (SHIFTM). The scanner loads each program memory
+//					word into CRCDATH:CRCDATL, so the odd address byte goes in first.
+//		hexmate		CRC-16/XMODEM over the bytes in address order, with the bytes of
+//					each word swapped first (revword=2).
+//
+//	Flash the .hex doesn't program reads back 0xFF on the part, so that's what the
+//	scanner sees there. Any such gaps are counted, as hexmate only sees them as 0xFF
+//	if the project's fill options fill them.
+//
+// Build: cc -O2 -Wall -o flash_crc_check flash_crc_check.c
+//
+// Usage: flash_crc_check [-v] <file.hex>
+//		-v	Print how much of the range the .hex programs.
+//
+//	Exits with 0 if both CRCs match the stored one.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ******************************   Macros   ****************************** */
+
+// Must match crc_bsp.c and the checksum option in nbproject/configurations.xml.
+#define CRC_POLYNOMIAL			((uint16_t)0x1021)
+#define CRC_SEED				((uint16_t)0x0000)
+#define CRC_FLASH_START_ADDR	(0x000000UL)
+#define CRC_FLASH_CRC_ADDR		(0x00FFFEUL)
+
+// Program memory on the PIC18F46K40. The .hex also holds config bits, ID locations and
+// EEPROM data further up, which aren't part of the check.
+#define FLASH_SIZE				(0x010000UL)
+
+#define ERASED_BYTE				(0xFF)
+
+#define MAX_LINE_LEN			(600)
+
+/* ***********************   File Scope Variables   *********************** */
+
+static uint8_t image[FLASH_SIZE];
+static bool programmed[FLASH_SIZE];
+
+/* ***********************   Function Prototypes   ************************ */
+
+static bool LoadHex(const char *path);
+static int HexByte(const char *s);
+static uint16_t ScannerCrc(void);
+static uint16_t HexmateCrc(void);
+
+/* *******************   Public Function Definitions   ******************** */
+
+int main(int argc, char *argv[])
+{
+	bool verbose = false;
+	const char *path = NULL;
+	unsigned long gaps = 0;
+	uint16_t stored;
+	uint16_t scanner;
+	uint16_t hexmate;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-v") == 0)
+		{
+			verbose = true;
+		}
+		else if (path == NULL)
+		{
+			path = argv[i];
+		}
+		else
+		{
+			path = NULL;
+			break;
+		}
+	}
+
+	if (path == NULL)
+	{
+		fprintf(stderr, "Usage: %s [-v] <file.hex>\n", argv[0]);
+		return 2;
+	}
+
+	memset(image, ERASED_BYTE, sizeof(image));
+	if (!LoadHex(path))
+	{
+		return 2;
+	}
+
+	if (!programmed[CRC_FLASH_CRC_ADDR] || !programmed[CRC_FLASH_CRC_ADDR + 1])
+	{
+		printf("FAIL nothing stored at 0x%05lX, was the checksum option left out of the build?\n", CRC_FLASH_CRC_ADDR);
+		return 1;
+	}
+
+	for (unsigned long addr = CRC_FLASH_START_ADDR; addr < CRC_FLASH_CRC_ADDR; addr++)
+	{
+		if (!programmed[addr])
+		{
+			gaps++;
+		}
+	}
+
+	// Little endian, the way crcBspFlashCrcExpected() reads it back.
+	stored = (uint16_t)(image[CRC_FLASH_CRC_ADDR] | ((uint16_t)image[CRC_FLASH_CRC_ADDR + 1] << 8));
+	scanner = ScannerCrc();
+	hexmate = HexmateCrc();
+
+	if (verbose)
+	{
+		printf("0x%05lX-0x%05lX: %lu bytes programmed, %lu not\n", CRC_FLASH_START_ADDR,
+				CRC_FLASH_CRC_ADDR - 1, (CRC_FLASH_CRC_ADDR - CRC_FLASH_START_ADDR) - gaps, gaps);
+	}
+
+	printf("stored 0x%04X, scanner 0x%04X, hexmate 0x%04X\n", stored, scanner, hexmate);
+
+	if (scanner != hexmate)
+	{
+		printf("FAIL the scanner and hexmate orders don't agree\n");
+		return 1;
+	}
+	if (scanner != stored)
+	{
+		printf("FAIL the part will see a CRC mismatch and won't drive\n");
+		if (gaps > 0)
+		{
+			printf("     %lu bytes aren't in the .hex, check the fill options fill them with 0x%02X\n", gaps, ERASED_BYTE);
+		}
+		return 1;
+	}
+
+	printf("pass\n");
+	return 0;
+}
+
+/* ********************   Private Function Definitions   ****************** */
+
+//-------------------------------
+// Function: LoadHex
+//
+// Description: Reads an Intel HEX file into the program memory image. Only data, end of file
+//		and extended address records are expected from the XC8 tools.
+//
+// return: false if the file can't be read or is malformed.
+//
+//-------------------------------
+static bool LoadHex(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[MAX_LINE_LEN];
+	unsigned long base = 0;
+	unsigned line_num = 0;
+
+	if (f == NULL)
+	{
+		perror(path);
+		return false;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		int len, addr_hi, addr_lo, type;
+		uint8_t sum;
+
+		line_num++;
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0')
+		{
+			continue;
+		}
+
+		len = HexByte(&line[1]);
+		if ((line[0] != ':') || (len < 0) || (strlen(line) != (size_t)(11 + (len * 2))))
+		{
+			fprintf(stderr, "%s:%u: not a HEX record\n", path, line_num);
+			fclose(f);
+			return false;
+		}
+
+		sum = 0;
+		for (int i = 0; i < len + 5; i++)
+		{
+			int b = HexByte(&line[1 + (i * 2)]);
+
+			if (b < 0)
+			{
+				fprintf(stderr, "%s:%u: bad hex digit\n", path, line_num);
+				fclose(f);
+				return false;
+			}
+			sum += (uint8_t)b;
+		}
+		if (sum != 0)
+		{
+			fprintf(stderr, "%s:%u: bad checksum\n", path, line_num);
+			fclose(f);
+			return false;
+		}
+
+		addr_hi = HexByte(&line[3]);
+		addr_lo = HexByte(&line[5]);
+		type = HexByte(&line[7]);
+
+		switch (type)
+		{
+			case 0x00:
+				for (int i = 0; i < len; i++)
+				{
+					unsigned long addr = base + ((unsigned long)addr_hi << 8) + (unsigned long)addr_lo + (unsigned long)i;
+
+					if (addr < FLASH_SIZE)
+					{
+						image[addr] = (uint8_t)HexByte(&line[9 + (i * 2)]);
+						programmed[addr] = true;
+					}
+				}
+				break;
+
+			case 0x01:
+				fclose(f);
+				return true;
+
+			case 0x02:
+				base = (((unsigned long)HexByte(&line[9]) << 8) | (unsigned long)HexByte(&line[11])) << 4;
+				break;
+
+			case 0x04:
+				base = (((unsigned long)HexByte(&line[9]) << 8) | (unsigned long)HexByte(&line[11])) << 16;
+				break;
+
+			default:
+				// Start address records don't place anything in memory.
+				break;
+		}
+	}
+
+	fprintf(stderr, "%s: no end of file record\n", path);
+	fclose(f);
+	return false;
+}
+
+//-------------------------------
+// Function: HexByte
+//
+// Description: Converts two hex digits.
+//
+// return: The byte, or -1 if they aren't hex digits.
+//
+//-------------------------------
+static int HexByte(const char *s)
+{
+	char digits[3] = {s[0], s[1], '\0'};
+	char *end;
+	long val;
+
+	if ((digits[0] == '\0') || (digits[1] == '\0'))
+	{
+		return -1;
+	}
+
+	val = strtol(digits, &end, 16);
+	return (*end == '\0') ? (int)val : -1;
+}
+
+//-------------------------------
+// Function: ScannerCrc
+//
+// Description: Works the CRC out a bit at a time the way the CRC module does with ACCM set.
+//		Each data bit is shifted into the bottom of the accumulator, the polynomial is XORed
+//		in whenever a one falls out of the top, and 16 zeros are shifted in at the end.
+//
+//-------------------------------
+static uint16_t ScannerCrc(void)
+{
+	uint16_t acc = CRC_SEED;
+
+	for (unsigned long addr = CRC_FLASH_START_ADDR; addr < CRC_FLASH_CRC_ADDR; addr += 2)
+	{
+		// CRCDATH:CRCDATL as the scanner loads them.
+		uint16_t data = (uint16_t)(((uint16_t)image[addr + 1] << 8) | image[addr]);
+
+		for (int bit = 15; bit >= 0; bit--)
+		{
+			bool out = (acc & 0x8000) != 0;
+
+			acc = (uint16_t)((acc << 1) | ((data >> bit) & 1));
+			if (out)
+			{
+				acc ^= CRC_POLYNOMIAL;
+			}
+		}
+	}
+
+	for (int bit = 0; bit < 16; bit++)
+	{
+		bool out = (acc & 0x8000) != 0;
+
+		acc = (uint16_t)(acc << 1);
+		if (out)
+		{
+			acc ^= CRC_POLYNOMIAL;
+		}
+	}
+
+	return acc;
+}
+
+//-------------------------------
+// Function: HexmateCrc
+//
+// Description: Works the CRC out the way hexmate's algorithm 5 does, CRC-16/XMODEM a byte
+//		at a time, over the bytes in the order revword=2 puts them.
+//
+//-------------------------------
+static uint16_t HexmateCrc(void)
+{
+	uint16_t crc = CRC_SEED;
+
+	for (unsigned long addr = CRC_FLASH_START_ADDR; addr < CRC_FLASH_CRC_ADDR; addr++)
+	{
+		// Swap each pair of bytes.
+		crc ^= (uint16_t)image[addr ^ 1] << 8;
+
+		for (int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC_POLYNOMIAL) : (uint16_t)(crc << 1);
+		}
+	}
+
+	return crc;
+}
+
+// end of file.
+//-------------------------------------------------------------------------
@@ -0,0 +1,928 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: gen_out_ctrl_test.c
+//
+// Description: Linux host test of the output control scheme in app/general_output_ctrl_app.c
+//		and drivers/general_output_ctrl.c.
+//
+//	The firmware doesn't build the scheme (nothing defines OK_TO_USE_CONTROL_SCHEME and
+//	main.c doesn't call GenOutCtrlApp_Init()), so this is the only place it runs.
+//	general_output_ctrl_app.c is included here to get at its request ring. The driver is
+//	built as is. The outputs are a log of every level change.
+//
+//		ring		Requests for the same output merge, but never across a "set all"
+//					and never into the slot ControlTask may be reading. A full ring
+//					turns requests away and counts them.
+//		deadlines	The times NextTransitionGet_ms() and TickUpdateAll_ms() give for
+//					blinking, repeating, one shot and steady states.
+//		sleep		ControlTask sleeps until the next transition rather than ticking
+//					every GENERAL_OUTPUT_CTRL_UPDATE_RATE_ms. A run of state changes is
+//					played through a 1 ms tick and then through sleeping the way
+//					ControlTask does, and the outputs have to change at the same times.
+//
+// Build: cc -O2 -Wall -DDEBUG -DOK_TO_USE_CONTROL_SCHEME -Istub -I$F/stdlib -I$F/common/inc
+//			-I$F/app/inc -I$F/app -I$F/bsp/inc -I$F/drivers/inc -o gen_out_ctrl_test
+//			gen_out_ctrl_test.c $F/drivers/general_output_ctrl.c
+//
+//	where F is ../../firmware/ASL104_PIC46K40.X. stub/ must come first.
+//
+// Usage: gen_out_ctrl_test [-v]
+//		-v	Print every output change in the sleep case.
+//
+//	Exits with 0 if every case passes.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "general_output_ctrl_app.c"
+#include "general_output_ctrl_bsp.h"
+
+/* ******************************   Macros   ****************************** */
+
+#define MAX_LOG_ENTRIES		(4000)
+
+#define SLEEP_RUN_TIME_ms	(20000)
+
+// The states in test_tables.
+#define TEST_STATE_OFF		GEN_OUT_CTRL_STATE_IDLE
+#define TEST_STATE_BLINK	GEN_OUT_CTRL_STATE_BLUETOOTH_OUTPUT
+#define TEST_STATE_PATTERN	GEN_OUT_CTRL_STATE_MODE_ACTIVE
+#define TEST_STATE_ONE_SHOT	GEN_OUT_CTRL_STATE_MODE_INACTIVE
+#define TEST_STATE_ODD		GEN_OUT_CTRL_STATE_NO_OUTPUT
+#define TEST_STATE_ON		GEN_OUT_POWER_LED_ON
+
+/* ******************************   Types   ******************************* */
+
+// An output changing level.
+typedef struct
+{
+	uint32_t m_Time_ms;
+	GenOutCtrlId_t m_Id;
+	bool m_Active;
+} TestLogEntry_t;
+
+// A state change request made during the sleep case.
+typedef struct
+{
+	uint32_t m_Time_ms;
+	bool m_SetAll;
+	GenOutCtrlId_t m_Id;
+	GenOutState_t m_State;
+} TestRequest_t;
+
+/* ***********************   File Scope Variables   *********************** */
+
+static const GenOutCtrlStateStepDef_t test_off[] =
+{
+	GEN_OUT_CTRL_ALWAYS_OFF,
+	GEN_OUT_CTRL_END_OF_STATE
+};
+
+static const GenOutCtrlStateStepDef_t test_blink[] =
+{
+	{250, 750, GEN_OUT_CTRL_REPEAT_PATTERN_FOREVER_VAL},
+	GEN_OUT_CTRL_END_OF_STATE
+};
+
+static const GenOutCtrlStateStepDef_t test_pattern[] =
+{
+	{100, 100, 3},
+	{500, 1000, 1},
+	GEN_OUT_CTRL_END_OF_STATE
+};
+
+static const GenOutCtrlStateStepDef_t test_one_shot[] =
+{
+	{30, 70, 2},
+	GEN_OUT_CTRL_END_OF_STATE
+};
+
+// Times that don't line up with the old 10 ms tick.
+static const GenOutCtrlStateStepDef_t test_odd[] =
+{
+	{37, 113, GEN_OUT_CTRL_REPEAT_PATTERN_FOREVER_VAL},
+	{3, 0, 2},
+	GEN_OUT_CTRL_END_OF_STATE
+};
+
+static const GenOutCtrlStateStepDef_t test_on[] =
+{
+	GEN_OUT_CTRL_ALWAYS_ON,
+	GEN_OUT_CTRL_END_OF_STATE
+};
+
+static const GenOutCtrlStateDef_t test_states[] =
+{
+	{TEST_STATE_OFF, false, 0, test_off},
+	{TEST_STATE_BLINK, false, 0, test_blink},
+	{TEST_STATE_PATTERN, false, 0, test_pattern},
+	{TEST_STATE_ONE_SHOT, true, 0, test_one_shot},
+	{TEST_STATE_ODD, false, 0, test_odd},
+	{TEST_STATE_ON, false, 0, test_on}
+};
+
+#define TEST_NUM_STATES (sizeof(test_states) / sizeof(test_states[0]))
+
+static const GenOutCtrlStateTable_t test_tables[GEN_OUT_CTRL_ID_MAX] =
+{
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES},
+	{test_states, TEST_NUM_STATES}
+};
+
+// Made at odd times, including ones a transition is also due at.
+static const TestRequest_t sleep_requests[] =
+{
+	{0, false, GEN_OUT_CTRL_ID_FORWARD_PAD_LED, TEST_STATE_BLINK},
+	{0, false, GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON},
+	{0, false, GEN_OUT_CTRL_ID_RESET_OUT, TEST_STATE_ODD},
+	{123, false, GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_PATTERN},
+	{250, false, GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_ONE_SHOT},
+	{1001, false, GEN_OUT_CTRL_ID_FORWARD_DEMAND, TEST_STATE_ODD},
+	{1001, false, GEN_OUT_CTRL_ID_FORWARD_DEMAND, TEST_STATE_BLINK},
+	{2717, false, GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_ONE_SHOT},
+	{4000, true, GEN_OUT_CTRL_ID_MAX, TEST_STATE_PATTERN},
+	{4000, false, GEN_OUT_CTRL_ID_REVERSE_PAD_LED, TEST_STATE_ODD},
+	{6599, false, GEN_OUT_CTRL_ID_LEFT_DEMAND, TEST_STATE_OFF},
+	{9999, true, GEN_OUT_CTRL_ID_MAX, TEST_STATE_ONE_SHOT},
+	{12345, false, GEN_OUT_CTRL_ID_RIGHT_DEMAND, TEST_STATE_BLINK},
+	{15000, true, GEN_OUT_CTRL_ID_MAX, TEST_STATE_OFF},
+	{15001, false, GEN_OUT_CTRL_ID_REVERSE_DEMAND, TEST_STATE_ODD}
+};
+
+#define NUM_SLEEP_REQUESTS (sizeof(sleep_requests) / sizeof(sleep_requests[0]))
+
+// Output levels as the BSP stand-ins see them, and the log of changes.
+static bool output_active[GEN_OUT_CTRL_ID_MAX];
+static TestLogEntry_t *log_entries = NULL;
+static unsigned num_log_entries = 0;
+static uint32_t now_ms = 0;
+
+static bool verbose = false;
+static unsigned num_run = 0;
+static unsigned num_failed = 0;
+
+/* ***********************   Function Prototypes   ************************ */
+
+static bool TestRingMerge(void);
+static bool TestRingSetAll(void);
+static bool TestRingConsumerSlot(void);
+static bool TestRingFull(void);
+static bool TestDeadlines(void);
+static bool TestSleep(void);
+static void Run(const char *name, bool (*test)(void));
+static void Reset(void);
+static bool CheckRing(const char *what, const StateCtrl_t *expected, uint8_t num_expected);
+static bool CheckTime(const char *what, GenOutCtrlTime_t got, GenOutCtrlTime_t expected);
+static unsigned PlayTicked(TestLogEntry_t *out);
+static unsigned PlaySleeping(TestLogEntry_t *out);
+static void RequestsAt(uint32_t time_ms, unsigned *next_request);
+static void LogOutput(GenOutCtrlId_t item_id, bool active);
+
+/* *******************   Public Function Definitions   ******************** */
+
+int main(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-v") == 0)
+		{
+			verbose = true;
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [-v]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	// The app's own tables have to be taken too, even though the cases use test_tables.
+	if (!GenOutCtrlApp_Init())
+	{
+		printf("FAIL GenOutCtrlApp_Init()\n");
+		return 1;
+	}
+
+	Run("ring merge", TestRingMerge);
+	Run("ring set all", TestRingSetAll);
+	Run("ring consumer slot", TestRingConsumerSlot);
+	Run("ring full", TestRingFull);
+	Run("deadlines", TestDeadlines);
+	Run("sleep", TestSleep);
+
+	printf("%u cases, %u failed\n", num_run, num_failed);
+	return (num_failed == 0) ? 0 : 1;
+}
+
+// Stand-ins for the output BSP. Only level changes are logged.
+
+void GenOutCtrlBsp_INIT(void)
+{
+}
+
+bool GenOutCtrlBsp_Enable(GenOutCtrlId_t item_id)
+{
+	(void)item_id;
+	return true;
+}
+
+bool GenOutCtrlBsp_Disable(GenOutCtrlId_t item_id)
+{
+	(void)item_id;
+	return true;
+}
+
+bool GenOutCtrlBsp_SetActive(GenOutCtrlId_t item_id)
+{
+	LogOutput(item_id, true);
+	return true;
+}
+
+bool GenOutCtrlBsp_SetInactive(GenOutCtrlId_t item_id)
+{
+	LogOutput(item_id, false);
+	return true;
+}
+
+bool GenOutCtrlBsp_Toggle(GenOutCtrlId_t item_id)
+{
+	LogOutput(item_id, !output_active[item_id]);
+	return true;
+}
+
+void GenOutCtrlBsp_SetMany(GenOutCtrlBspIdMask_t item_ids, GenOutCtrlBspIdMask_t active_ids)
+{
+	for (unsigned i = 0; i < (unsigned)GEN_OUT_CTRL_ID_MAX; i++)
+	{
+		if ((item_ids & ((GenOutCtrlBspIdMask_t)1 << i)) != 0)
+		{
+			LogOutput((GenOutCtrlId_t)i, (active_ids & ((GenOutCtrlBspIdMask_t)1 << i)) != 0);
+		}
+	}
+}
+
+// ControlTask() uses these, but never runs.
+
+void stopwatchStart(StopWatch_t *stop_watch)
+{
+	(void)stop_watch;
+}
+
+void stopwatchZero(StopWatch_t *stop_watch)
+{
+	(void)stop_watch;
+}
+
+TimerTick_t stopwatchTimeElapsed(StopWatch_t *stop_watch, bool zero_after_check)
+{
+	(void)stop_watch;
+	(void)zero_after_check;
+	return 0;
+}
+
+Evt_t event_create(void)
+{
+	return 0;
+}
+
+uint8_t task_create(void (*task)(void), void *data, uint8_t prio, void *msg_pool, uint8_t pool_size, uint16_t msg_size)
+{
+	(void)task;
+	(void)data;
+	(void)prio;
+	(void)msg_pool;
+	(void)pool_size;
+	(void)msg_size;
+	return 0;
+}
+
+void assertion_trap(char *file, uint16_t line)
+{
+	printf("  FAIL assertion at %s:%u\n", file, line);
+	exit(1);
+}
+
+/* ********************   Private Function Definitions   ****************** */
+
+//-------------------------------
+// Function: TestRingMerge
+//
+// Description: A request for an output with one already waiting takes that one's slot,
+//		unless the waiting one is at head.
+//
+//-------------------------------
+static bool TestRingMerge(void)
+{
+	// The slot at head gets the new state written too, it's queued again anyway.
+	static const StateCtrl_t expected[] =
+	{
+		{false, GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_BLINK},
+		{false, GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_ODD},
+		{false, GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_PATTERN},
+		{false, GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_BLINK}
+	};
+	bool ok = true;
+
+	ok &= GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON);
+	ok &= GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_BLINK);
+	ok &= GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_PATTERN);
+	ok &= GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_ODD);
+	// Waiting at head, so queued again.
+	ok &= GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_BLINK);
+	if (!ok)
+	{
+		printf("  FAIL a request was turned away\n");
+		return false;
+	}
+
+	if (!CheckRing("after merging", expected, sizeof(expected) / sizeof(expected[0])))
+	{
+		return false;
+	}
+
+	(void)ServiceStateChangeRequests();
+	if ((GenOutCtrl_OutputCtrlrStateGet(GEN_OUT_CTRL_ID_POWER_LED) != TEST_STATE_BLINK) ||
+		(GenOutCtrl_OutputCtrlrStateGet(GEN_OUT_CTRL_ID_LEFT_PAD_LED) != TEST_STATE_ODD) ||
+		(GenOutCtrl_OutputCtrlrStateGet(GEN_OUT_CTRL_ID_RIGHT_PAD_LED) != TEST_STATE_PATTERN))
+	{
+		printf("  FAIL the outputs didn't end up in the last states asked for\n");
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------
+// Function: TestRingSetAll
+//
+// Description: Nothing merges across a "set all", but back to back "set all" requests do.
+//
+//-------------------------------
+static bool TestRingSetAll(void)
+{
+	static const StateCtrl_t expected[] =
+	{
+		{false, GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON},
+		{false, GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_BLINK},
+		{true, GEN_OUT_CTRL_ID_MAX, TEST_STATE_ODD},
+		{false, GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_PATTERN}
+	};
+	bool ok = true;
+
+	ok &= GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON);
+	ok &= GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_BLINK);
+	ok &= GenOutCtrlApp_SetStateAll(TEST_STATE_PATTERN);
+	ok &= GenOutCtrlApp_SetStateAll(TEST_STATE_ODD);
+	ok &= GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_PATTERN);
+	if (!ok)
+	{
+		printf("  FAIL a request was turned away\n");
+		return false;
+	}
+
+	if (!CheckRing("after merging", expected, sizeof(expected) / sizeof(expected[0])))
+	{
+		return false;
+	}
+
+	(void)ServiceStateChangeRequests();
+	for (unsigned i = 0; i < (unsigned)GEN_OUT_CTRL_ID_MAX; i++)
+	{
+		GenOutState_t want = (i == (unsigned)GEN_OUT_CTRL_ID_LEFT_PAD_LED) ? TEST_STATE_PATTERN : TEST_STATE_ODD;
+
+		if (GenOutCtrl_OutputCtrlrStateGet((GenOutCtrlId_t)i) != want)
+		{
+			printf("  FAIL output %u is in state %d, not %d\n", i, GenOutCtrl_OutputCtrlrStateGet((GenOutCtrlId_t)i), want);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//-------------------------------
+// Function: TestRingConsumerSlot
+//
+// Description: A merge into a slot ControlTask is reading, or has already used, isn't taken
+//		as done. The request is queued again instead.
+//
+//-------------------------------
+static bool TestRingConsumerSlot(void)
+{
+	static const StateCtrl_t expected_merged[] =
+	{
+		{false, GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON},
+		{false, GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_PATTERN},
+		{false, GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_ON}
+	};
+	static const StateCtrl_t expected_requeued[] =
+	{
+		{false, GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON},
+		{false, GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_PATTERN},
+		{false, GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_ON},
+		{false, GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_PATTERN}
+	};
+
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON);
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_BLINK);
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_ON);
+
+	// Still ahead of the consumer.
+	if (!MergeIntoWaitingRequest((uint8_t)(state_change_req_circ_buf_pos_head + 1), TEST_STATE_BLINK))
+	{
+		printf("  FAIL merge into a slot the consumer hasn't reached wasn't taken\n");
+		return false;
+	}
+
+	// At head, the consumer may be reading it.
+	if (MergeIntoWaitingRequest(state_change_req_circ_buf_pos_head, TEST_STATE_ON))
+	{
+		printf("  FAIL merge into the slot at head was taken\n");
+		return false;
+	}
+
+	// The consumer takes the first two while the producer is merging into the second.
+	state_change_req_circ_buf_pos_head = (uint8_t)(state_change_req_circ_buf_pos_head + 2);
+	if (MergeIntoWaitingRequest((uint8_t)(state_change_req_circ_buf_pos_head - 1), TEST_STATE_PATTERN))
+	{
+		printf("  FAIL merge into a slot the consumer has passed was taken\n");
+		return false;
+	}
+	state_change_req_circ_buf_pos_head = (uint8_t)(state_change_req_circ_buf_pos_head - 2);
+
+	// The whole thing through QueueStateChangeRequest().
+	Reset();
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON);
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_BLINK);
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_ON);
+	if (!GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_PATTERN))
+	{
+		printf("  FAIL a request was turned away\n");
+		return false;
+	}
+
+	// The slot for LEFT_PAD_LED isn't at head, so it merged.
+	if (!CheckRing("after merging", expected_merged, sizeof(expected_merged) / sizeof(expected_merged[0])))
+	{
+		return false;
+	}
+
+	// The consumer moves on to LEFT_PAD_LED's slot, so the next request for it is queued again.
+	Reset();
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON);
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_BLINK);
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_ON);
+	SetOutputControllersToNewState(&state_change_req_circ_buf[0]);
+	state_change_req_circ_buf_pos_head = 1;
+	(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_PATTERN);
+	state_change_req_circ_buf_pos_head = 0;
+	if (!CheckRing("after the consumer reached the slot", expected_requeued, sizeof(expected_requeued) / sizeof(expected_requeued[0])))
+	{
+		return false;
+	}
+
+	(void)ServiceStateChangeRequests();
+	if (GenOutCtrl_OutputCtrlrStateGet(GEN_OUT_CTRL_ID_LEFT_PAD_LED) != TEST_STATE_PATTERN)
+	{
+		printf("  FAIL the last state asked for was lost\n");
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------
+// Function: TestRingFull
+//
+// Description: A full ring turns requests away and counts them. Merges still work.
+//
+//-------------------------------
+static bool TestRingFull(void)
+{
+	unsigned num_queued = 0;
+
+	// Outputs one after another, then "set all" and more outputs, so nothing merges.
+	for (unsigned i = 0; i < (unsigned)GEN_OUT_CTRL_ID_MAX; i++)
+	{
+		num_queued += GenOutCtrlApp_SetState((GenOutCtrlId_t)i, TEST_STATE_BLINK) ? 1 : 0;
+	}
+	num_queued += GenOutCtrlApp_SetStateAll(TEST_STATE_ON) ? 1 : 0;
+	for (unsigned i = 0; num_queued < STATE_CHANGE_REQ_CIRC_BUF_NUM_SLOTS; i++)
+	{
+		if (!GenOutCtrlApp_SetState((GenOutCtrlId_t)i, TEST_STATE_ODD))
+		{
+			printf("  FAIL request %u was turned away\n", num_queued);
+			return false;
+		}
+		num_queued++;
+	}
+
+	if (GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_RESET_OUT, TEST_STATE_PATTERN) ||
+		GenOutCtrlApp_SetStateAll(TEST_STATE_OFF))
+	{
+		printf("  FAIL a request was taken with the ring full\n");
+		return false;
+	}
+	if (GenOutCtrlApp_NumDroppedRequestsGet() != 2)
+	{
+		printf("  FAIL %u requests counted as dropped, not 2\n", GenOutCtrlApp_NumDroppedRequestsGet());
+		return false;
+	}
+
+	// Merging into the newest doesn't need a slot.
+	if (!GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_FORWARD_PAD_LED, TEST_STATE_PATTERN))
+	{
+		printf("  FAIL a merge was turned away with the ring full\n");
+		return false;
+	}
+
+	// The count stops at 255.
+	for (unsigned i = 0; i < 300; i++)
+	{
+		(void)GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_RESET_OUT, TEST_STATE_PATTERN);
+	}
+	if (GenOutCtrlApp_NumDroppedRequestsGet() != UINT8_MAX)
+	{
+		printf("  FAIL the dropped count is %u, not %u\n", GenOutCtrlApp_NumDroppedRequestsGet(), UINT8_MAX);
+		return false;
+	}
+
+	if (!ServiceStateChangeRequests() || (state_change_req_circ_buf_pos_head != state_change_req_circ_buf_pos_tail))
+	{
+		printf("  FAIL the ring didn't empty\n");
+		return false;
+	}
+	if (!GenOutCtrlApp_SetState(GEN_OUT_CTRL_ID_RESET_OUT, TEST_STATE_PATTERN))
+	{
+		printf("  FAIL a request was turned away after the ring emptied\n");
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------
+// Function: TestDeadlines
+//
+// Description: Checks the times to the next transition that ControlTask sleeps for.
+//
+//-------------------------------
+static bool TestDeadlines(void)
+{
+	bool ok = true;
+
+	ok &= CheckTime("nothing running", GenOutCtrl_NextTransitionGet_ms(), GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL);
+
+	(void)GenOutCtrl_StateSet(GEN_OUT_CTRL_ID_POWER_LED, TEST_STATE_ON);
+	(void)GenOutCtrl_Start(GEN_OUT_CTRL_ID_POWER_LED);
+	(void)GenOutCtrl_StateSet(GEN_OUT_CTRL_ID_LEFT_PAD_LED, TEST_STATE_OFF);
+	(void)GenOutCtrl_Start(GEN_OUT_CTRL_ID_LEFT_PAD_LED);
+	ok &= CheckTime("steady on and off", GenOutCtrl_NextTransitionGet_ms(), GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL);
+
+	// 250 on, 750 off.
+	(void)GenOutCtrl_StateSet(GEN_OUT_CTRL_ID_FORWARD_PAD_LED, TEST_STATE_BLINK);
+	(void)GenOutCtrl_Start(GEN_OUT_CTRL_ID_FORWARD_PAD_LED);
+	ok &= CheckTime("blink started", GenOutCtrl_NextTransitionGet_ms(), 250);
+	ok &= CheckTime("blink 100 ms in", GenOutCtrl_TickUpdateAll_ms(100), 150);
+	ok &= CheckTime("blink turned off", GenOutCtrl_TickUpdateAll_ms(150), 750);
+	ok &= CheckTime("blink 1 ms before on", GenOutCtrl_TickUpdateAll_ms(749), 1);
+	ok &= CheckTime("blink turned on", GenOutCtrl_TickUpdateAll_ms(1), 250);
+
+	// 30 on, 70 off, twice, once. Earlier than the blink, so it sets the time.
+	(void)GenOutCtrl_StateSet(GEN_OUT_CTRL_ID_RIGHT_PAD_LED, TEST_STATE_ONE_SHOT);
+	(void)GenOutCtrl_Start(GEN_OUT_CTRL_ID_RIGHT_PAD_LED);
+	ok &= CheckTime("one shot started", GenOutCtrl_NextTransitionGet_ms(), 30);
+	ok &= CheckTime("one shot off", GenOutCtrl_TickUpdateAll_ms(30), 70);
+	ok &= CheckTime("one shot on again", GenOutCtrl_TickUpdateAll_ms(70), 30);
+	ok &= CheckTime("one shot off again", GenOutCtrl_TickUpdateAll_ms(30), 70);
+	// Done, only the blink is left: 250 - 200 ms.
+	ok &= CheckTime("one shot done", GenOutCtrl_TickUpdateAll_ms(70), 50);
+	if (GenOutCtrl_OutputCtrlrIsActive(GEN_OUT_CTRL_ID_RIGHT_PAD_LED) || output_active[GEN_OUT_CTRL_ID_RIGHT_PAD_LED])
+	{
+		printf("  FAIL the one shot didn't finish with its output off\n");
+		ok = false;
+	}
+
+	// Ticking one output on its own, past its transition.
+	(void)GenOutCtrl_TickUpdate_ms(60, GEN_OUT_CTRL_ID_FORWARD_PAD_LED);
+	ok &= CheckTime("blink ticked on its own", GenOutCtrl_NextTransitionGet_ms(), 750);
+
+	(void)GenOutCtrl_StateSet(GEN_OUT_CTRL_ID_REVERSE_PAD_LED, TEST_STATE_PATTERN);
+	(void)GenOutCtrl_Start(GEN_OUT_CTRL_ID_REVERSE_PAD_LED);
+	ok &= CheckTime("pattern started", GenOutCtrl_NextTransitionGet_ms(), 100);
+	(void)GenOutCtrl_TickUpdate_ms(99, GEN_OUT_CTRL_ID_REVERSE_PAD_LED);
+	ok &= CheckTime("pattern 1 ms left", GenOutCtrl_NextTransitionGet_ms(), 1);
+
+	(void)GenOutCtrl_StopAll();
+	ok &= CheckTime("all stopped", GenOutCtrl_NextTransitionGet_ms(), GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL);
+
+	return ok;
+}
+
+//-------------------------------
+// Function: TestSleep
+//
+// Description: Plays sleep_requests through a 1 ms tick, then again sleeping until each
+//		transition the way ControlTask does. The outputs must change at the same times.
+//
+//-------------------------------
+static bool TestSleep(void)
+{
+	TestLogEntry_t *ticked = calloc(MAX_LOG_ENTRIES, sizeof(TestLogEntry_t));
+	TestLogEntry_t *slept = calloc(MAX_LOG_ENTRIES, sizeof(TestLogEntry_t));
+	unsigned num_ticked;
+	unsigned num_slept;
+	bool ok = true;
+
+	if ((ticked == NULL) || (slept == NULL))
+	{
+		printf("  FAIL out of memory\n");
+		free(ticked);
+		free(slept);
+		return false;
+	}
+
+	num_ticked = PlayTicked(ticked);
+	Reset();
+	num_slept = PlaySleeping(slept);
+
+	if (verbose)
+	{
+		for (unsigned i = 0; i < num_ticked; i++)
+		{
+			printf("    %6u ms output %u %s\n", (unsigned)ticked[i].m_Time_ms, ticked[i].m_Id, ticked[i].m_Active ? "on" : "off");
+		}
+	}
+
+	if ((num_ticked < 100) || (num_ticked >= MAX_LOG_ENTRIES))
+	{
+		printf("  FAIL %u output changes in the 1 ms run, expected 100 or more\n", num_ticked);
+		ok = false;
+	}
+
+	for (unsigned i = 0; ok && (i < num_ticked) && (i < num_slept); i++)
+	{
+		if ((ticked[i].m_Time_ms != slept[i].m_Time_ms) || (ticked[i].m_Id != slept[i].m_Id) ||
+			(ticked[i].m_Active != slept[i].m_Active))
+		{
+			printf("  FAIL change %u: 1 ms tick has output %u %s at %u ms, sleeping has output %u %s at %u ms\n", i,
+				ticked[i].m_Id, ticked[i].m_Active ? "on" : "off", (unsigned)ticked[i].m_Time_ms,
+				slept[i].m_Id, slept[i].m_Active ? "on" : "off", (unsigned)slept[i].m_Time_ms);
+			ok = false;
+		}
+	}
+	if (ok && (num_ticked != num_slept))
+	{
+		printf("  FAIL %u output changes with a 1 ms tick, %u sleeping\n", num_ticked, num_slept);
+		ok = false;
+	}
+
+	free(ticked);
+	free(slept);
+	return ok;
+}
+
+//-------------------------------
+// Function: Run
+//
+// Description: Runs one case from a clean start and counts it.
+//
+//-------------------------------
+static void Run(const char *name, bool (*test)(void))
+{
+	num_run++;
+	printf("%s\n", name);
+
+	Reset();
+	if (!test())
+	{
+		num_failed++;
+	}
+}
+
+//-------------------------------
+// Function: Reset
+//
+// Description: Empties the ring, puts every output back in the first state of test_tables and
+//		stopped, and clears the output log.
+//
+//-------------------------------
+static void Reset(void)
+{
+	log_entries = NULL;
+	num_log_entries = 0;
+
+	(void)GenOutCtrl_StopAll();
+	if (!GenOutCtrl_StateTablesSet(test_tables))
+	{
+		printf("  FAIL the test tables weren't taken\n");
+		exit(1);
+	}
+
+	state_change_req_circ_buf_pos_head = 0;
+	state_change_req_circ_buf_pos_tail = 0;
+	state_change_req_num_dropped = 0;
+	memset(state_change_req_circ_buf, 0, sizeof(state_change_req_circ_buf));
+
+	memset(output_active, 0, sizeof(output_active));
+	now_ms = 0;
+}
+
+//-------------------------------
+// Function: CheckRing
+//
+// Description: Compares what's waiting in the ring with what's expected, oldest first.
+//
+//-------------------------------
+static bool CheckRing(const char *what, const StateCtrl_t *expected, uint8_t num_expected)
+{
+	uint8_t head = state_change_req_circ_buf_pos_head;
+	uint8_t num_waiting = (uint8_t)(state_change_req_circ_buf_pos_tail - head);
+
+	if (num_waiting != num_expected)
+	{
+		printf("  FAIL %s: %u requests waiting, expected %u\n", what, num_waiting, num_expected);
+		return false;
+	}
+
+	for (uint8_t i = 0; i < num_expected; i++)
+	{
+		const StateCtrl_t *req = &state_change_req_circ_buf[(uint8_t)(head + i) & STATE_CHANGE_REQ_CIRC_BUF_IDX_MASK];
+
+		if ((req->set_all != expected[i].set_all) || (req->id != expected[i].id) || (req->state != expected[i].state))
+		{
+			printf("  FAIL %s: request %u is set_all %d id %d state %d, expected %d %d %d\n", what, i,
+				req->set_all, req->id, req->state, expected[i].set_all, expected[i].id, expected[i].state);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//-------------------------------
+// Function: CheckTime
+//
+// Description: Compares a time to the next transition with what's expected.
+//
+//-------------------------------
+static bool CheckTime(const char *what, GenOutCtrlTime_t got, GenOutCtrlTime_t expected)
+{
+	if (got != expected)
+	{
+		printf("  FAIL %s: next transition in %u ms, expected %u ms\n", what, got, expected);
+		return false;
+	}
+
+	return true;
+}
+
+//-------------------------------
+// Function: PlayTicked
+//
+// Description: Plays sleep_requests through TickUpdateAll_ms() a millisecond at a time.
+//
+// return: Number of output changes logged in out.
+//
+//-------------------------------
+static unsigned PlayTicked(TestLogEntry_t *out)
+{
+	unsigned next_request = 0;
+
+	log_entries = out;
+
+	for (now_ms = 0; now_ms <= SLEEP_RUN_TIME_ms; now_ms++)
+	{
+		if (now_ms > 0)
+		{
+			(void)GenOutCtrl_TickUpdateAll_ms(1);
+		}
+		RequestsAt(now_ms, &next_request);
+	}
+
+	return num_log_entries;
+}
+
+//-------------------------------
+// Function: PlaySleeping
+//
+// Description: Plays sleep_requests the way ControlTask runs: sleep until the next transition
+//		or request, bring the outputs up to date with the time slept, then carry out any
+//		requests.
+//
+// return: Number of output changes logged in out.
+//
+//-------------------------------
+static unsigned PlaySleeping(TestLogEntry_t *out)
+{
+	unsigned next_request = 0;
+	GenOutCtrlTime_t next_transition;
+
+	log_entries = out;
+	now_ms = 0;
+
+	RequestsAt(now_ms, &next_request);
+	next_transition = GenOutCtrl_NextTransitionGet_ms();
+
+	while (now_ms < SLEEP_RUN_TIME_ms)
+	{
+		uint32_t wake_ms = SLEEP_RUN_TIME_ms;
+		GenOutCtrlTime_t slept_ms;
+
+		if (next_transition != GEN_OUT_CTRL_ALWAYS_IN_STATE_VAL)
+		{
+			// ControlTask always waits at least one tick.
+			uint32_t due_ms = now_ms + ((next_transition > 0) ? next_transition : 1);
+
+			if (due_ms < wake_ms)
+			{
+				wake_ms = due_ms;
+			}
+		}
+		if ((next_request < NUM_SLEEP_REQUESTS) && (sleep_requests[next_request].m_Time_ms < wake_ms))
+		{
+			// The request's event wakes the task early.
+			wake_ms = sleep_requests[next_request].m_Time_ms;
+		}
+
+		slept_ms = (GenOutCtrlTime_t)(wake_ms - now_ms);
+		now_ms = wake_ms;
+
+		next_transition = GenOutCtrl_TickUpdateAll_ms(slept_ms);
+		if ((next_request < NUM_SLEEP_REQUESTS) && (sleep_requests[next_request].m_Time_ms == now_ms))
+		{
+			RequestsAt(now_ms, &next_request);
+			next_transition = GenOutCtrl_NextTransitionGet_ms();
+		}
+	}
+
+	return num_log_entries;
+}
+
+//-------------------------------
+// Function: RequestsAt
+//
+// Description: Makes the requests in sleep_requests due at time_ms and carries them out.
+//
+//-------------------------------
+static void RequestsAt(uint32_t time_ms, unsigned *next_request)
+{
+	while ((*next_request < NUM_SLEEP_REQUESTS) && (sleep_requests[*next_request].m_Time_ms == time_ms))
+	{
+		const TestRequest_t *req = &sleep_requests[*next_request];
+
+		if (req->m_SetAll)
+		{
+			(void)GenOutCtrlApp_SetStateAll(req->m_State);
+		}
+		else
+		{
+			(void)GenOutCtrlApp_SetState(req->m_Id, req->m_State);
+		}
+		(*next_request)++;
+	}
+
+	(void)ServiceStateChangeRequests();
+}
+
+//-------------------------------
+// Function: LogOutput
+//
+// Description: Sets an output's level and logs it if it changed.
+//
+//-------------------------------
+static void LogOutput(GenOutCtrlId_t item_id, bool active)
+{
+	if (output_active[item_id] == active)
+	{
+		return;
+	}
+
+	output_active[item_id] = active;
+	if ((log_entries != NULL) && (num_log_entries < MAX_LOG_ENTRIES))
+	{
+		log_entries[num_log_entries].m_Time_ms = now_ms;
+		log_entries[num_log_entries].m_Id = item_id;
+		log_entries[num_log_entries].m_Active = active;
+		num_log_entries++;
+	}
+}
+
+// end of file.
+//-------------------------------------------------------------------------
@@ -0,0 +1,33 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: cocoos.h
+//
+// Description: Host stand-in for the parts of cocoOS general_output_ctrl_app.c uses.
+//		ControlTask() is built but never run, gen_out_ctrl_test plays its part.
+//		Implemented in gen_out_ctrl_test.c.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef COCOOS_H
+#define COCOOS_H
+
+#include <stdint.h>
+
+typedef uint8_t Evt_t;
+
+#define task_open()
+#define task_close()
+#define event_wait(event)					((void)(event))
+#define event_wait_timeout(event, timeout)	((void)(event), (void)(timeout))
+
+Evt_t event_create(void);
+uint8_t task_create(void (*task)(void), void *data, uint8_t prio, void *msg_pool, uint8_t pool_size, uint16_t msg_size);
+
+#endif // COCOOS_H
+
+// end of file.
+//-------------------------------------------------------------------------
@@ -0,0 +1,26 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Filename: device.h
+//
+// Description: Host stand-in for the firmware's device.h, for building
+//		general_output_ctrl_app.c into gen_out_ctrl_test.
+//
+// Author(s): Trevor Parsh (Embedded Wizardry, LLC)
+//
+// Modified for ASL on Date:
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include <stdint.h>
+
+// As device_xc8.h has them.
+typedef uint16_t TimerTick_t;
+#define MILLISECONDS_TO_TICKS(x) (x * 1)
+
+#endif // DEVICE_H
+
+// end of file.
+//-------------------------------------------------------------------------